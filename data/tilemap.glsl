@@ -0,0 +1,58 @@
+@vertex #version 330 core
+
+layout(location = 0) in vec3  position;
+layout(location = 1) in vec4  color;
+layout(location = 2) in vec2  tex_coord;
+layout(location = 3) in float tex_slot;
+layout(location = 4) in vec2  tiling_factor;
+
+uniform mat4 u_proj;
+uniform mat4 u_view;
+
+out vec2  v_tex_coord;
+out vec4  v_color;
+out float v_tex_slot;
+out vec2  v_tiling_factor;
+
+void main()
+{
+	gl_Position = u_proj * u_view * vec4(position, 1.0);
+    
+    v_tex_coord = tex_coord;
+	v_color = color;
+	v_tex_slot = tex_slot;
+    v_tiling_factor = tiling_factor;
+}
+
+@fragment #version 330 core
+
+in vec2  v_tex_coord;
+in vec4  v_color;
+in float v_tex_slot;
+in vec2  v_tiling_factor;
+
+out vec4 f_color;
+
+// NOTE: one slot less than p_basic.glsl, u_tile_map takes the 16th unit, see TILE_MAP_TEXTURE_UNIT
+uniform sampler2D u_textures[15];
+
+// NOTE: one texel per tile, the red channel is the tile type
+uniform sampler2D u_tile_map;
+uniform vec4 u_tile_rects[16];
+uniform vec4 u_tile_colors[16];
+
+void main()
+{
+    ivec2 map_size = textureSize(u_tile_map, 0);
+    vec2 cell = clamp(v_tex_coord * vec2(map_size), vec2(0.0), vec2(map_size) - 0.5);
+    int tile_type = int(texelFetch(u_tile_map, ivec2(cell), 0).r * 255.0 + 0.5);
+    vec4 tile_color = u_tile_colors[tile_type];
+    if(tile_color.a == 0.0) {
+        discard;
+    }
+    
+    vec4 rect = u_tile_rects[tile_type];
+    int tex_slot = int(v_tex_slot + 0.5);
+    vec4 tex_color = texture(u_textures[tex_slot], mix(rect.xy, rect.zw, fract(cell)));
+    f_color = tex_color * tile_color * v_color;
+}
@@ -0,0 +1,27 @@
+#!/bin/sh
+# NOTE: headless linux build, bin/p_linux runs bin/p_game.so and reloads it when it changes
+
+cd "$(dirname "$0")"
+
+cxx=${CXX:-g++}
+include_dirs="-I../include/"
+
+# NOTE: -O0 -g for debugging
+common_compile_flags="-std=c++17 -O2 -g -fno-exceptions -fno-rtti -Wall -Wno-unused-variable -Wno-unused-function -Wno-unused-but-set-variable -Wno-missing-braces -Wno-sign-compare -Wno-switch -Wno-char-subscripts -Wno-write-strings -Wno-maybe-uninitialized"
+
+so_name=p_game
+so_compile_flags="$common_compile_flags -shared -fPIC -fvisibility=hidden"
+
+exe_name=p_linux
+link_flags="-ldl -pthread"
+
+mkdir -p ../bin
+cd ../bin
+
+# NOTE: game so, the lock file keeps the platform from loading a half written one
+echo "COMPILING GAME SO" > ${so_name}_so.lock
+$cxx $include_dirs $so_compile_flags ../source/p_game_main.cpp -o $so_name.so
+rm -f ${so_name}_so.lock
+
+# NOTE: platform
+$cxx $include_dirs $common_compile_flags ../source/p_linux_main.cpp -o $exe_name $link_flags
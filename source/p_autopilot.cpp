@@ -0,0 +1,374 @@
+static void
+init_autopilot(Autopilot *autopilot, MemoryArena *arena, PlatformProcs *procs, PlatformWorkQueue *queue) {
+    *autopilot = {};
+    autopilot->arena = make_arena(push_memory(arena, AUTOPILOT_MEMORY_SIZE), AUTOPILOT_MEMORY_SIZE);
+    autopilot->mcts_random = 0x2545F4914F6CDD1Dull;
+    autopilot->procs = procs;
+    autopilot->work_queue = queue;
+}
+
+// NOTE: call when the level memory goes away
+static void
+reset_autopilot(Autopilot *autopilot) {
+    autopilot->level = nullptr;
+    autopilot->distance = nullptr;
+    autopilot->queue = nullptr;
+    autopilot->queued = nullptr;
+    autopilot->cycle = {};
+    autopilot->arena.used = 0;
+}
+
+inline bool
+is_field_passable(Level *level, vec2i tile_pos) {
+    tile_type type = get_tile(level, tile_pos.x, tile_pos.y).type;
+    return type != TILE_wall && type != TILE_snake;
+}
+
+static void
+push_field_tile(Autopilot *autopilot, u32 index) {
+    if(autopilot->queued[index]) {
+        return;
+    }
+    u32 tile_count = autopilot->level->width * autopilot->level->height;
+    autopilot->queued[index] = 1;
+    autopilot->queue[(autopilot->queue_read + autopilot->queue_count++) % tile_count] = index;
+}
+
+// NOTE: lowers the distances around the queued tiles until nothing changes, with the
+// apple alone in the queue it's a plain BFS
+static void
+relax_distance_field(Autopilot *autopilot, Level *level) {
+    u32 tile_count = level->width * level->height;
+    u32 *distance = autopilot->distance;
+    while(autopilot->queue_count) {
+        u32 index = autopilot->queue[autopilot->queue_read];
+        autopilot->queue_read = (autopilot->queue_read + 1) % tile_count;
+        --autopilot->queue_count;
+        autopilot->queued[index] = 0;
+        
+        vec2i tile_pos = { (i32)(index % level->width), (i32)(index / level->width) };
+        for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+            vec2i next_pos;
+            if(!step_tile_pos(level, tile_pos, dir, &next_pos)) {
+                continue;
+            }
+            
+            u32 next_index = next_pos.y * level->width + next_pos.x;
+            if(distance[next_index] <= distance[index] + 1 || !is_field_passable(level, next_pos)) {
+                continue;
+            }
+            distance[next_index] = distance[index] + 1;
+            push_field_tile(autopilot, next_index);
+        }
+    }
+}
+
+// NOTE: the tiles whose distance counted on 'tile_pos' lose it, they start again from
+// their neighbours that didn't
+static void
+block_field_tile(Autopilot *autopilot, Level *level, vec2i tile_pos) {
+    u32 *distance = autopilot->distance;
+    u32 *lost = autopilot->queue;
+    u32 lost_count = 0;
+    
+    u32 index = tile_pos.y * level->width + tile_pos.x;
+    if(distance[index] == AUTOPILOT_UNREACHABLE) {
+        return;
+    }
+    lost[lost_count++] = index;
+    for(u32 i = 0; i < lost_count; ++i) {
+        vec2i pos = { (i32)(lost[i] % level->width), (i32)(lost[i] / level->width) };
+        for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+            vec2i next_pos;
+            if(!step_tile_pos(level, pos, dir, &next_pos)) {
+                continue;
+            }
+            u32 next_index = next_pos.y * level->width + next_pos.x;
+            if(!autopilot->queued[next_index] && distance[next_index] != AUTOPILOT_UNREACHABLE && 
+               distance[next_index] == distance[lost[i]] + 1) {
+                lost[lost_count++] = next_index;
+                autopilot->queued[next_index] = 1;
+            }
+        }
+    }
+    // NOTE: 'queued' marks the lost tiles while they're collected, a tile is lost once
+    for(u32 i = 0; i < lost_count; ++i) {
+        distance[lost[i]] = AUTOPILOT_UNREACHABLE;
+    }
+    
+    // NOTE: the queue is empty here, it's refilled from the front with the lost tiles in order
+    autopilot->queue_read = 0;
+    autopilot->queue_count = 0;
+    for(u32 i = 1; i < lost_count; ++i) {
+        u32 lost_index = lost[i];
+        autopilot->queued[lost_index] = 0;
+        
+        vec2i pos = { (i32)(lost_index % level->width), (i32)(lost_index / level->width) };
+        for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+            vec2i next_pos;
+            if(!step_tile_pos(level, pos, dir, &next_pos)) {
+                continue;
+            }
+            u32 next_index = next_pos.y * level->width + next_pos.x;
+            if(distance[next_index] != AUTOPILOT_UNREACHABLE && is_field_passable(level, next_pos)) {
+                distance[lost_index] = min_value(distance[lost_index], distance[next_index] + 1);
+            }
+        }
+    }
+    for(u32 i = 1; i < lost_count; ++i) {
+        if(distance[lost[i]] != AUTOPILOT_UNREACHABLE) {
+            push_field_tile(autopilot, lost[i]);
+        }
+    }
+    relax_distance_field(autopilot, level);
+}
+
+static void
+free_field_tile(Autopilot *autopilot, Level *level, vec2i tile_pos) {
+    u32 *distance = autopilot->distance;
+    u32 index = tile_pos.y * level->width + tile_pos.x;
+    for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+        vec2i next_pos;
+        if(!step_tile_pos(level, tile_pos, dir, &next_pos)) {
+            continue;
+        }
+        u32 next_index = next_pos.y * level->width + next_pos.x;
+        if(distance[next_index] != AUTOPILOT_UNREACHABLE && is_field_passable(level, next_pos)) {
+            distance[index] = min_value(distance[index], distance[next_index] + 1);
+        }
+    }
+    if(distance[index] != AUTOPILOT_UNREACHABLE) {
+        push_field_tile(autopilot, index);
+        relax_distance_field(autopilot, level);
+    }
+}
+
+static void
+update_distance_field(Autopilot *autopilot, Level *level) {
+    bool same_level = (autopilot->level == level && autopilot->seed == level->params.seed);
+    if(same_level && autopilot->apple_pos == level->apple_pos && autopilot->tick_count == level->tick_count) {
+        return;
+    }
+    
+    u32 tile_count = level->width * level->height;
+    if(tile_count > AUTOPILOT_MAX_TILES) {
+        // NOTE: autopilot_next_dir heads straight for the apple without the field
+        reset_autopilot(autopilot);
+        return;
+    }
+    
+    if(!same_level) {
+        autopilot->arena.used = 0;
+        autopilot->distance = push_array(&autopilot->arena, u32, tile_count);
+        autopilot->queue    = push_array(&autopilot->arena, u32, tile_count);
+        autopilot->queued   = push_array(&autopilot->arena, u8, tile_count);
+        autopilot->level = level;
+        autopilot->seed  = level->params.seed;
+        
+        // NOTE: the cycle depends on the walls only
+        build_hamilton_cycle(&autopilot->cycle, level, level->params.seed, &autopilot->arena);
+    }
+    
+    // NOTE: one tick with the same apple, the head took a tile and the tail may have left one
+    bool one_tick = (same_level && autopilot->apple_pos == level->apple_pos && 
+                     autopilot->tick_count + 1 == level->tick_count);
+    vec2i old_tail = autopilot->snake_tail;
+    autopilot->apple_pos  = level->apple_pos;
+    autopilot->tick_count = level->tick_count;
+    autopilot->snake_head = level->snake_head;
+    autopilot->snake_tail = level->snake_tail;
+    
+    if(one_tick) {
+        ++autopilot->field_updates;
+        if(old_tail != level->snake_tail && is_field_passable(level, old_tail)) {
+            free_field_tile(autopilot, level, old_tail);
+        }
+        block_field_tile(autopilot, level, level->snake_head);
+        return;
+    }
+    ++autopilot->field_rebuilds;
+    
+    u32 *distance = autopilot->distance;
+    for(u32 i = 0; i < tile_count; ++i) {
+        distance[i] = AUTOPILOT_UNREACHABLE;
+        autopilot->queued[i] = 0;
+    }
+    autopilot->queue_read = 0;
+    autopilot->queue_count = 0;
+    if(level->apple_pos.x == -1 || level->apple_pos.y == -1) {
+        return;
+    }
+    
+    u32 apple_index = level->apple_pos.y * level->width + level->apple_pos.x;
+    distance[apple_index] = 0;
+    push_field_tile(autopilot, apple_index);
+    relax_distance_field(autopilot, level);
+}
+
+// NOTE: how much room the snake has if its head moves to 'head_pos' and whether it can
+// still follow its own tail from there, the tail tile counts as free
+static u32
+autopilot_flood(Level *level, vec2i head_pos, bool *tail_reached, MemoryArena *arena) {
+    // NOTE: big levels have no bitboards, every move counts as safe there
+    if(!level->wall_bits.words) {
+        *tail_reached = true;
+        return U32_MAX;
+    }
+    
+    TemporaryMemory memory = begin_temporary_memory(arena);
+    Bitboard passable = make_bitboard(level->width, level->height, arena);
+    Bitboard reach    = make_bitboard(level->width, level->height, arena);
+    Bitboard temp     = make_bitboard(level->width, level->height, arena);
+    
+    bitboard_fill(&passable);
+    bitboard_and_not(&passable, &passable, &level->wall_bits);
+    bitboard_and_not(&passable, &passable, &level->snake_bits);
+    bitboard_set(&passable, level->snake_tail.x, level->snake_tail.y);
+    bitboard_set(&passable, head_pos.x, head_pos.y);
+    
+    bitboard_zero(&reach);
+    bitboard_set(&reach, head_pos.x, head_pos.y);
+    u32 count = bitboard_flood_fill(&reach, &passable, &temp, level->looping);
+    *tail_reached = bitboard_get(&reach, level->snake_tail.x, level->snake_tail.y);
+    
+    end_temporary_memory(memory);
+    return count;
+}
+
+// NOTE: free tiles with at most one free neighbour, the snake can only leave them the way
+// it came in. The apple's tile counts as free
+static u32
+autopilot_dead_ends(Level *level, MemoryArena *arena) {
+    if(!level->wall_bits.words) {
+        return 0;
+    }
+    
+    TemporaryMemory memory = begin_temporary_memory(arena);
+    Bitboard free_bits = make_bitboard(level->width, level->height, arena);
+    Bitboard bit0      = make_bitboard(level->width, level->height, arena);
+    Bitboard bit1      = make_bitboard(level->width, level->height, arena);
+    Bitboard bit2      = make_bitboard(level->width, level->height, arena);
+    
+    bitboard_fill(&free_bits);
+    bitboard_and_not(&free_bits, &free_bits, &level->wall_bits);
+    bitboard_and_not(&free_bits, &free_bits, &level->snake_bits);
+    bitboard_neighbour_count(&bit0, &bit1, &bit2, &free_bits, level->looping);
+    
+    // NOTE: a count of 0 or 1 has neither of the high bits
+    bitboard_and_not(&free_bits, &free_bits, &bit1);
+    bitboard_and_not(&free_bits, &free_bits, &bit2);
+    u32 count = bitboard_popcount(&free_bits);
+    
+    end_temporary_memory(memory);
+    return count;
+}
+
+static vec2i
+autopilot_next_dir(Autopilot *autopilot, Level *level, MemoryArena *temp_arena) {
+    update_distance_field(autopilot, level);
+    
+    vec2i cycle_dir;
+    if(autopilot->use_cycle && hamilton_next_dir(&autopilot->cycle, level, &cycle_dir)) {
+        return cycle_dir;
+    }
+    
+    if(autopilot->use_mcts && autopilot->procs && autopilot->distance) {
+        TemporaryMemory memory = begin_temporary_memory(temp_arena);
+        MctsAgent agent = make_mcts_agent(level->width, level->height, MCTS_AUTOPILOT_NODES, temp_arena);
+        MctsResult result = run_mcts(&agent, level, MCTS_AUTOPILOT_PLAYOUTS, rand_u64(&autopilot->mcts_random), 
+                                     autopilot->procs, autopilot->work_queue);
+        end_temporary_memory(memory);
+        return dir_to_vec2i(result.dir);
+    }
+    
+    struct Candidate {
+        u32 dir;
+        u32 distance;
+    };
+    Candidate candidates[DIR_COUNT];
+    u32 candidate_count = 0;
+    
+    u32 head_dir = get_snake_dir(level, 0);
+    for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+        vec2i next_pos;
+        if(dir == opposite_dir(head_dir) || !step_tile_pos(level, level->snake_head, dir, &next_pos)) {
+            continue;
+        }
+        
+        // NOTE: the tail leaves its tile before the head moves in, unless the snake grows
+        tile_type type = get_tile(level, next_pos.x, next_pos.y).type;
+        bool into_tail = (next_pos == level->snake_tail && level->add_snake_parts == 0);
+        if(type == TILE_wall || (type == TILE_snake && !into_tail)) {
+            continue;
+        }
+        
+        Candidate candidate = { dir, 0 };
+        if(autopilot->distance) {
+            candidate.distance = autopilot->distance[next_pos.y * level->width + next_pos.x];
+        }
+        else if(level->apple_pos.x != -1 && level->apple_pos.y != -1) {
+            candidate.distance = absolute(level->apple_pos.x - next_pos.x) + absolute(level->apple_pos.y - next_pos.y);
+        }
+        u32 at = candidate_count++;
+        for(; at > 0 && candidates[at - 1].distance > candidate.distance; --at) {
+            candidates[at] = candidates[at - 1];
+        }
+        candidates[at] = candidate;
+    }
+    
+    if(!candidate_count) {
+        return dir_to_vec2i(head_dir);
+    }
+    
+    // NOTE: big levels have no bitboards to flood, forking them isn't worth it either
+    if(!level->wall_bits.words) {
+        return dir_to_vec2i(candidates[0].dir);
+    }
+    
+    // NOTE: closest safe move, if none is safe the one with the most room. Each move is
+    // made on a fork of the level, so the tail, the growth and the next apple are what
+    // the level will have after it. Safe moves as close to the apple break the tie by
+    // the dead ends they leave
+    bool found_safe = false;
+    u32 safe_dir = 0;
+    u32 safe_distance = 0;
+    u32 safe_dead_ends = 0;
+    u32 best_dir = candidates[0].dir;
+    u32 best_count = 0;
+    for(u32 i = 0; i < candidate_count; ++i) {
+        if(found_safe && candidates[i].distance > safe_distance) {
+            break;
+        }
+        
+        LevelFork fork = fork_level(level, temp_arena);
+        Level *next = &fork.level;
+        snake_event event = tick_snake(next, dir_to_vec2i(candidates[i].dir));
+        if(event == SNAKE_won) {
+            discard_level(&fork);
+            return dir_to_vec2i(candidates[i].dir);
+        }
+        
+        bool tail_reached = false;
+        u32 count = 0;
+        if(event != SNAKE_died) {
+            count = autopilot_flood(next, next->snake_head, &tail_reached, temp_arena);
+        }
+        u32 needed = next->snake_count + next->add_snake_parts;
+        
+        if(tail_reached || count >= needed) {
+            u32 dead_ends = autopilot_dead_ends(next, temp_arena);
+            if(!found_safe || dead_ends < safe_dead_ends) {
+                found_safe = true;
+                safe_dir = candidates[i].dir;
+                safe_distance = candidates[i].distance;
+                safe_dead_ends = dead_ends;
+            }
+        }
+        else if(count > best_count) {
+            best_count = count;
+            best_dir = candidates[i].dir;
+        }
+        discard_level(&fork);
+    }
+    return dir_to_vec2i(found_safe ? safe_dir : best_dir);
+}
@@ -0,0 +1,56 @@
+#ifndef P_AUTOPILOT_H
+#define P_AUTOPILOT_H
+
+// NOTE: steers the snake by a BFS distance field to the apple around the walls and the body.
+// It's rebuilt when the apple moves, between apples only the tiles around the head's new
+// tile and the tail's old one are searched again. Each move is made on a fork of the level, see
+// fork_level, and a flood fill there checks the tail can still be reached. Between safe moves
+// as close to the apple it takes the one leaving the fewest dead ends, by bitboard neighbour counts.
+// With 'use_cycle' it follows a Hamiltonian cycle when the level has one, see p_cycle.h,
+// with 'use_mcts' every move is a tree search on the work queue, see p_mcts.h
+
+#define AUTOPILOT_MEMORY_SIZE MB(1)
+#define AUTOPILOT_UNREACHABLE U32_MAX
+#define AUTOPILOT_MAX_TILES   (128 * 128) // NOTE: bigger levels get no field, no cycle and no tree search
+
+struct Autopilot {
+    MemoryArena arena;
+    
+    // NOTE: what the distance field was built for
+    Level *level;
+    random_seed seed;
+    vec2i apple_pos;
+    u32   tick_count;
+    vec2i snake_head;
+    vec2i snake_tail;
+    
+    u32 *distance; // NOTE: moves from the tile to the apple, walls and the snake block
+    u32 *queue;    // NOTE: ring of tile indices, 'queued' keeps a tile in it once
+    u8  *queued;
+    u32  queue_read;
+    u32  queue_count;
+    u32  field_rebuilds;
+    u32  field_updates;
+    
+    bool use_cycle;
+    HamiltonCycle cycle;
+    
+    bool use_mcts;
+    random_seed mcts_random;
+    PlatformProcs *procs;
+    PlatformWorkQueue *work_queue;
+};
+
+static void  init_autopilot(Autopilot *autopilot, MemoryArena *arena, PlatformProcs *procs, PlatformWorkQueue *queue);
+static void  reset_autopilot(Autopilot *autopilot);
+inline bool  is_field_passable(Level *level, vec2i tile_pos);
+static void  push_field_tile(Autopilot *autopilot, u32 index);
+static void  relax_distance_field(Autopilot *autopilot, Level *level);
+static void  block_field_tile(Autopilot *autopilot, Level *level, vec2i tile_pos);
+static void  free_field_tile(Autopilot *autopilot, Level *level, vec2i tile_pos);
+static void  update_distance_field(Autopilot *autopilot, Level *level);
+static u32   autopilot_flood(Level *level, vec2i head_pos, bool *tail_reached, MemoryArena *arena);
+static u32   autopilot_dead_ends(Level *level, MemoryArena *arena);
+static vec2i autopilot_next_dir(Autopilot *autopilot, Level *level, MemoryArena *temp_arena);
+
+#endif /* P_AUTOPILOT_H */
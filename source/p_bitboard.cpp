@@ -0,0 +1,289 @@
+static Bitboard
+make_bitboard(u32 width, u32 height, MemoryArena *arena) {
+    Bitboard board = {};
+    board.width  = width;
+    board.height = height;
+    board.words_per_row = (width + 64) / 64;
+    board.word_count = board.words_per_row * height;
+    
+    u32 last_word_bits = width - (board.words_per_row - 1) * 64;
+    board.last_word_mask = last_word_bits ? ((1ull << last_word_bits) - 1) : 0;
+    
+    u32 total_words = board.word_count + board.words_per_row * 2;
+    u64 *memory = push_array(arena, u64, total_words);
+    zero_memory(memory, total_words * sizeof(u64));
+    board.words = memory + board.words_per_row;
+    return board;
+}
+
+// NOTE: the padding rows come along, they stay zero
+static Bitboard
+make_bitboard_copy(Bitboard *source, MemoryArena *arena) {
+    Bitboard board = *source;
+    u32 total_words = board.word_count + board.words_per_row * 2;
+    u64 *memory = push_array(arena, u64, total_words);
+    copy_memory(source->words - source->words_per_row, memory, total_words * sizeof(u64));
+    board.words = memory + board.words_per_row;
+    return board;
+}
+
+inline bool
+bitboard_get(Bitboard *board, u32 x, u32 y) {
+    u64 word = board->words[y * board->words_per_row + (x >> 6)];
+    return (word >> (x & 63)) & 1;
+}
+
+inline void
+bitboard_set(Bitboard *board, u32 x, u32 y) {
+    board->words[y * board->words_per_row + (x >> 6)] |= (1ull << (x & 63));
+}
+
+inline void
+bitboard_clear(Bitboard *board, u32 x, u32 y) {
+    board->words[y * board->words_per_row + (x >> 6)] &= ~(1ull << (x & 63));
+}
+
+static void
+bitboard_zero(Bitboard *board) {
+    zero_memory(board->words, board->word_count * sizeof(u64));
+}
+
+static void
+bitboard_fill(Bitboard *board) {
+    for(u32 y = 0; y < board->height; ++y) {
+        u64 *row = board->words + y * board->words_per_row;
+        for(u32 i = 0; i < board->words_per_row - 1; ++i) {
+            row[i] = ~0ull;
+        }
+        row[board->words_per_row - 1] = board->last_word_mask;
+    }
+}
+
+static void
+bitboard_copy(Bitboard *dest, Bitboard *source) {
+    ASSERT(dest->word_count == source->word_count, "bitboard size mismatch");
+    copy_memory(source->words, dest->words, source->word_count * sizeof(u64));
+}
+
+static void
+bitboard_and(Bitboard *dest, Bitboard *a, Bitboard *b) {
+    ASSERT(dest->word_count == a->word_count && dest->word_count == b->word_count, "bitboard size mismatch");
+    u32 k = 0;
+#if BITBOARD_SSE2
+    for(; (k + 2) <= dest->word_count; k += 2) {
+        __m128i va = _mm_loadu_si128((__m128i *)(a->words + k));
+        __m128i vb = _mm_loadu_si128((__m128i *)(b->words + k));
+        _mm_storeu_si128((__m128i *)(dest->words + k), _mm_and_si128(va, vb));
+    }
+#endif
+    for(; k < dest->word_count; ++k) {
+        dest->words[k] = a->words[k] & b->words[k];
+    }
+}
+
+// NOTE: dest = a & ~b
+static void
+bitboard_and_not(Bitboard *dest, Bitboard *a, Bitboard *b) {
+    ASSERT(dest->word_count == a->word_count && dest->word_count == b->word_count, "bitboard size mismatch");
+    u32 k = 0;
+#if BITBOARD_SSE2
+    for(; (k + 2) <= dest->word_count; k += 2) {
+        __m128i va = _mm_loadu_si128((__m128i *)(a->words + k));
+        __m128i vb = _mm_loadu_si128((__m128i *)(b->words + k));
+        _mm_storeu_si128((__m128i *)(dest->words + k), _mm_andnot_si128(vb, va));
+    }
+#endif
+    for(; k < dest->word_count; ++k) {
+        dest->words[k] = a->words[k] & ~b->words[k];
+    }
+}
+
+static u32
+bitboard_popcount(Bitboard *board) {
+    // NOTE: padding bits are zero, so no masking
+    u32 count = 0;
+    for(u32 k = 0; k < board->word_count; ++k) {
+        count += popcount_u64(board->words[k]);
+    }
+    return count;
+}
+
+// NOTE: guard rows are zero for walled boards and hold the opposite edge row for looping ones
+static void
+set_bitboard_guards(Bitboard *board, bool looping) {
+    u64 *lead  = board->words - board->words_per_row;
+    u64 *trail = board->words + board->word_count;
+    if(looping) {
+        copy_memory(board->words + board->word_count - board->words_per_row, lead, board->words_per_row * sizeof(u64));
+        copy_memory(board->words, trail, board->words_per_row * sizeof(u64));
+    }
+    else {
+        zero_memory(lead,  board->words_per_row * sizeof(u64));
+        zero_memory(trail, board->words_per_row * sizeof(u64));
+    }
+}
+
+inline u64
+dilate_word(u64 *w, i32 words_per_row) {
+    u64 c = w[0];
+    u64 left  = (c << 1) | (w[-1] >> 63);
+    u64 right = (c >> 1) | (w[1] << 63);
+    return c | left | right | w[words_per_row] | w[-words_per_row];
+}
+
+// NOTE: 4-neighbour dilation, optionally masked, returns whether anything changed
+static bool
+dilate_bitboard(Bitboard *dest, Bitboard *source, Bitboard *mask, bool looping) {
+    ASSERT(dest != source && dest->word_count == source->word_count, "bad dilate");
+    set_bitboard_guards(source, looping);
+    
+    u64 *s = source->words;
+    u64 *d = dest->words;
+    u32 wpr = source->words_per_row;
+    u64 changed = 0;
+    
+    u32 k = 0;
+#if BITBOARD_SSE2
+    __m128i vchanged = _mm_setzero_si128();
+    for(; (k + 2) <= source->word_count; k += 2) {
+        __m128i c  = _mm_loadu_si128((__m128i *)(s + k));
+        __m128i l  = _mm_loadu_si128((__m128i *)(s + k - 1));
+        __m128i r  = _mm_loadu_si128((__m128i *)(s + k + 1));
+        __m128i up = _mm_loadu_si128((__m128i *)(s + k + wpr));
+        __m128i dn = _mm_loadu_si128((__m128i *)(s + k - wpr));
+        
+        __m128i left  = _mm_or_si128(_mm_slli_epi64(c, 1), _mm_srli_epi64(l, 63));
+        __m128i right = _mm_or_si128(_mm_srli_epi64(c, 1), _mm_slli_epi64(r, 63));
+        __m128i out = _mm_or_si128(_mm_or_si128(c, left), _mm_or_si128(right, _mm_or_si128(up, dn)));
+        if(mask) {
+            out = _mm_and_si128(out, _mm_loadu_si128((__m128i *)(mask->words + k)));
+        }
+        vchanged = _mm_or_si128(vchanged, _mm_xor_si128(out, c));
+        _mm_storeu_si128((__m128i *)(d + k), out);
+    }
+    changed |= (_mm_movemask_epi8(_mm_cmpeq_epi8(vchanged, _mm_setzero_si128())) != 0xFFFF);
+#endif
+    for(; k < source->word_count; ++k) {
+        u64 out = dilate_word(s + k, wpr);
+        if(mask) {
+            out &= mask->words[k];
+        }
+        changed |= out ^ s[k];
+        d[k] = out;
+    }
+    
+    for(u32 y = 0; y < source->height; ++y) {
+        u64 *row = d + y * wpr;
+        row[wpr - 1] &= source->last_word_mask;
+        
+        if(looping && source->width > 1) {
+            u32 last_x = source->width - 1;
+            if(bitboard_get(source, last_x, y) && (!mask || bitboard_get(mask, 0, y)) && !bitboard_get(dest, 0, y)) {
+                bitboard_set(dest, 0, y);
+                changed = 1;
+            }
+            if(bitboard_get(source, 0, y) && (!mask || bitboard_get(mask, last_x, y)) && !bitboard_get(dest, last_x, y)) {
+                bitboard_set(dest, last_x, y);
+                changed = 1;
+            }
+        }
+    }
+    return changed != 0;
+}
+
+// NOTE: 'reach' holds the seed cells and gets everything reachable through 'passable',
+// returns the reached cell count
+static u32
+bitboard_flood_fill(Bitboard *reach, Bitboard *passable, Bitboard *temp, bool looping) {
+    bitboard_and(reach, reach, passable);
+    
+    Bitboard *from = reach;
+    Bitboard *to   = temp;
+    while(dilate_bitboard(to, from, passable, looping)) {
+        Bitboard *swap = from;
+        from = to;
+        to = swap;
+    }
+    
+    if(from != reach) {
+        bitboard_copy(reach, from);
+    }
+    return bitboard_popcount(reach);
+}
+
+// NOTE: bit sliced 4-neighbour count (0..4) of 'source', bit0 | bit1 << 1 | bit2 << 2
+static void
+bitboard_neighbour_count(Bitboard *bit0, Bitboard *bit1, Bitboard *bit2, Bitboard *source, bool looping) {
+    set_bitboard_guards(source, looping);
+    
+    u64 *s = source->words;
+    u32 wpr = source->words_per_row;
+    
+    u32 k = 0;
+#if BITBOARD_SSE2
+    for(; (k + 2) <= source->word_count; k += 2) {
+        __m128i c = _mm_loadu_si128((__m128i *)(s + k));
+        __m128i l = _mm_or_si128(_mm_slli_epi64(c, 1), _mm_srli_epi64(_mm_loadu_si128((__m128i *)(s + k - 1)), 63));
+        __m128i r = _mm_or_si128(_mm_srli_epi64(c, 1), _mm_slli_epi64(_mm_loadu_si128((__m128i *)(s + k + 1)), 63));
+        __m128i u = _mm_loadu_si128((__m128i *)(s + k + wpr));
+        __m128i d = _mm_loadu_si128((__m128i *)(s + k - wpr));
+        
+        __m128i s0 = _mm_xor_si128(l, r);
+        __m128i c0 = _mm_and_si128(l, r);
+        __m128i s1 = _mm_xor_si128(u, d);
+        __m128i c1 = _mm_and_si128(u, d);
+        __m128i c2 = _mm_and_si128(s0, s1);
+        _mm_storeu_si128((__m128i *)(bit0->words + k), _mm_xor_si128(s0, s1));
+        _mm_storeu_si128((__m128i *)(bit1->words + k), _mm_xor_si128(_mm_xor_si128(c0, c1), c2));
+        _mm_storeu_si128((__m128i *)(bit2->words + k), _mm_and_si128(c0, c1));
+    }
+#endif
+    for(; k < source->word_count; ++k) {
+        u64 *w = s + k;
+        u64 l = (w[0] << 1) | (w[-1] >> 63);
+        u64 r = (w[0] >> 1) | (w[1] << 63);
+        u64 u = w[wpr];
+        u64 d = w[-(i32)wpr];
+        
+        u64 s0 = l ^ r;
+        u64 c0 = l & r;
+        u64 s1 = u ^ d;
+        u64 c1 = u & d;
+        u64 c2 = s0 & s1;
+        bit0->words[k] = s0 ^ s1;
+        bit1->words[k] = c0 ^ c1 ^ c2;
+        bit2->words[k] = c0 & c1;
+    }
+    
+    for(u32 y = 0; y < source->height; ++y) {
+        u32 last = y * wpr + wpr - 1;
+        bit0->words[last] &= source->last_word_mask;
+        bit1->words[last] &= source->last_word_mask;
+        bit2->words[last] &= source->last_word_mask;
+        
+        if(looping) {
+            // NOTE: horizontal wrap, add the neighbour from the other side by hand
+            u32 last_x = source->width - 1;
+            u32 xs[2]    = { 0, last_x };
+            u32 froms[2] = { last_x, 0 };
+            for(u32 i = 0; i < 2; ++i) {
+                if(!bitboard_get(source, froms[i], y)) {
+                    continue;
+                }
+                
+                u32 count = bitboard_get_count(bit0, bit1, bit2, xs[i], y) + 1;
+                if(count & 1) { bitboard_set(bit0, xs[i], y); } else { bitboard_clear(bit0, xs[i], y); }
+                if(count & 2) { bitboard_set(bit1, xs[i], y); } else { bitboard_clear(bit1, xs[i], y); }
+                if(count & 4) { bitboard_set(bit2, xs[i], y); } else { bitboard_clear(bit2, xs[i], y); }
+            }
+        }
+    }
+}
+
+inline u32
+bitboard_get_count(Bitboard *bit0, Bitboard *bit1, Bitboard *bit2, u32 x, u32 y) {
+    u32 count = ((u32)bitboard_get(bit0, x, y) |
+                 ((u32)bitboard_get(bit1, x, y) << 1) |
+                 ((u32)bitboard_get(bit2, x, y) << 2));
+    return count;
+}
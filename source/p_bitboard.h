@@ -0,0 +1,48 @@
+#ifndef P_BITBOARD_H
+#define P_BITBOARD_H
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BITBOARD_SSE2 1
+#else
+#define BITBOARD_SSE2 0
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define popcount_u64(v) ((u32)__popcnt64(v))
+#else
+#define popcount_u64(v) ((u32)__builtin_popcountll(v))
+#endif
+
+// NOTE: one bit per tile, rows of 'words_per_row' u64s. Every row has at least one
+// padding bit past 'width', and there is a guard row above and below the board,
+// so the kernels can shift the whole thing as one flat array without per row checks.
+// Padding bits are always zero.
+struct Bitboard {
+    u32  width;
+    u32  height;
+    u32  words_per_row;
+    u32  word_count;
+    u64  last_word_mask;
+    u64 *words;
+};
+
+static Bitboard make_bitboard(u32 width, u32 height, MemoryArena *arena);
+static Bitboard make_bitboard_copy(Bitboard *source, MemoryArena *arena);
+inline bool bitboard_get(Bitboard *board, u32 x, u32 y);
+inline void bitboard_set(Bitboard *board, u32 x, u32 y);
+inline void bitboard_clear(Bitboard *board, u32 x, u32 y);
+
+static void bitboard_zero(Bitboard *board);
+static void bitboard_fill(Bitboard *board);
+static void bitboard_copy(Bitboard *dest, Bitboard *source);
+static void bitboard_and(Bitboard *dest, Bitboard *a, Bitboard *b);
+static void bitboard_and_not(Bitboard *dest, Bitboard *a, Bitboard *b);
+static u32  bitboard_popcount(Bitboard *board);
+
+static u32  bitboard_flood_fill(Bitboard *reach, Bitboard *passable, Bitboard *temp, bool looping);
+static void bitboard_neighbour_count(Bitboard *bit0, Bitboard *bit1, Bitboard *bit2, Bitboard *source, bool looping);
+inline u32  bitboard_get_count(Bitboard *bit0, Bitboard *bit1, Bitboard *bit2, u32 x, u32 y);
+
+#endif /* P_BITBOARD_H */
@@ -0,0 +1,280 @@
+static bool
+build_hamilton_cycle(HamiltonCycle *cycle, Level *level, random_seed seed, MemoryArena *arena) {
+    *cycle = {};
+    if((level->width & 1) || (level->height & 1)) {
+        return false;
+    }
+    
+    u32 tile_count = level->width * level->height;
+    cycle->width    = level->width;
+    cycle->height   = level->height;
+    cycle->order    = push_array(arena, u32, tile_count);
+    cycle->next_dir = push_array(arena, u8, tile_count);
+    
+    TemporaryMemory memory = begin_temporary_memory(arena);
+    u32 block_w = level->width / 2;
+    u32 block_h = level->height / 2;
+    u32 block_count = block_w * block_h;
+    u8  *links   = push_array(arena, u8, block_count); // NOTE: 1 << snake_dir for every tree edge
+    u8  *visited = push_array(arena, u8, block_count);
+    u32 *stack   = push_array(arena, u32, block_count);
+    zero_memory(links, block_count);
+    zero_memory(visited, block_count);
+    
+    // NOTE: walls have to cover whole blocks, blocks with walls are marked as visited
+    u32 open_blocks = 0;
+    u32 first_block = CYCLE_NO_TILE;
+    for(u32 block = 0; block < block_count; ++block) {
+        u32 x = (block % block_w) * 2;
+        u32 y = (block / block_w) * 2;
+        u32 walls = ((get_tile(level, x,     y).type     == TILE_wall) +
+                     (get_tile(level, x + 1, y).type     == TILE_wall) +
+                     (get_tile(level, x,     y + 1).type == TILE_wall) +
+                     (get_tile(level, x + 1, y + 1).type == TILE_wall));
+        if(walls == 4) {
+            visited[block] = true;
+        }
+        else if(walls == 0) {
+            if(first_block == CYCLE_NO_TILE) {
+                first_block = block;
+            }
+            ++open_blocks;
+        }
+        else {
+            end_temporary_memory(memory);
+            return false;
+        }
+    }
+    if(!open_blocks) {
+        end_temporary_memory(memory);
+        return false;
+    }
+    
+    // NOTE: randomized depth first spanning tree over the open blocks
+    u32 stack_count = 0;
+    u32 visited_count = 1;
+    stack[stack_count++] = first_block;
+    visited[first_block] = true;
+    while(stack_count) {
+        u32 block = stack[stack_count - 1];
+        i32 bx = block % block_w;
+        i32 by = block / block_w;
+        
+        u32 options[DIR_COUNT];
+        u32 option_count = 0;
+        for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+            vec2i next = make_vec2i(bx, by) + dir_to_vec2i(dir);
+            if(is_in_bounds(next.x, 0, (i32)block_w - 1) && is_in_bounds(next.y, 0, (i32)block_h - 1) &&
+               !visited[next.y * block_w + next.x]) {
+                options[option_count++] = dir;
+            }
+        }
+        
+        if(!option_count) {
+            --stack_count;
+            continue;
+        }
+        
+        u32 dir = options[0];
+        if(option_count > 1) {
+            dir = options[rand_u32_in_range(&seed, 0, option_count - 1)];
+        }
+        vec2i next = make_vec2i(bx, by) + dir_to_vec2i(dir);
+        u32 next_block = next.y * block_w + next.x;
+        links[block] |= (u8)(1 << dir);
+        links[next_block] |= (u8)(1 << opposite_dir(dir));
+        visited[next_block] = true;
+        stack[stack_count++] = next_block;
+        ++visited_count;
+    }
+    
+    if(visited_count != open_blocks) {
+        end_temporary_memory(memory);
+        return false;
+    }
+    
+    // NOTE: every block is a counter clockwise loop of its 4 tiles,
+    // a tree edge swaps the two loop edges facing each other
+    for(u32 y = 0; y < level->height; ++y) {
+        for(u32 x = 0; x < level->width; ++x) {
+            u32 index = y * level->width + x;
+            cycle->order[index] = CYCLE_NO_TILE;
+            cycle->next_dir[index] = DIR_none;
+            if(get_tile(level, x, y).type == TILE_wall) {
+                continue;
+            }
+            
+            u8 block_links = links[(y / 2) * block_w + (x / 2)];
+            u32 corner = (x & 1) | ((y & 1) << 1);
+            switch(corner) {
+                case 0: { cycle->next_dir[index] = (block_links & (1 << DIR_down))  ? DIR_down  : DIR_right; } break;
+                case 1: { cycle->next_dir[index] = (block_links & (1 << DIR_right)) ? DIR_right : DIR_up;    } break;
+                case 3: { cycle->next_dir[index] = (block_links & (1 << DIR_up))    ? DIR_up    : DIR_left;  } break;
+                case 2: { cycle->next_dir[index] = (block_links & (1 << DIR_left))  ? DIR_left  : DIR_down;  } break;
+            }
+        }
+    }
+    end_temporary_memory(memory);
+    
+    cycle->length = open_blocks * 4;
+    vec2i tile_pos = { (i32)(first_block % block_w) * 2, (i32)(first_block / block_w) * 2 };
+    for(u32 i = 0; i < cycle->length; ++i) {
+        u32 index = tile_pos.y * level->width + tile_pos.x;
+        ASSERT(cycle->order[index] == CYCLE_NO_TILE, "cycle visits a tile twice");
+        cycle->order[index] = i;
+        tile_pos += dir_to_vec2i(cycle->next_dir[index]);
+    }
+    cycle->valid = true;
+    return true;
+}
+
+inline u32
+cycle_distance(HamiltonCycle *cycle, u32 from, u32 to) {
+    return (to + cycle->length - from) % cycle->length;
+}
+
+// NOTE: true when the parts from the tail to the head follow the cycle forward, skipping is fine
+static bool
+snake_in_cycle_order(HamiltonCycle *cycle, Level *level) {
+    vec2i tile_pos = level->snake_tail;
+    u32 last = cycle->order[tile_pos.y * cycle->width + tile_pos.x];
+    if(last == CYCLE_NO_TILE) {
+        return false;
+    }
+    
+    u32 span = 0;
+    for(u32 part = level->snake_count - 1; part > 0; --part) {
+        tile_pos += dir_to_vec2i(get_snake_dir(level, part - 1));
+        maybe_warp(level, &tile_pos);
+        
+        u32 order = cycle->order[tile_pos.y * cycle->width + tile_pos.x];
+        if(order == CYCLE_NO_TILE) {
+            return false;
+        }
+        span += cycle_distance(cycle, last, order);
+        if(span >= cycle->length) {
+            return false;
+        }
+        last = order;
+    }
+    return true;
+}
+
+static bool
+hamilton_next_dir(HamiltonCycle *cycle, Level *level, vec2i *head_dir) {
+    if(!cycle->valid || cycle->width != level->width || cycle->height != level->height || !level->snake_count) {
+        return false;
+    }
+    
+    u32 head_index = level->snake_head.y * cycle->width + level->snake_head.x;
+    u32 head = cycle->order[head_index];
+    if(head == CYCLE_NO_TILE) {
+        return false;
+    }
+    
+    // NOTE: the starting snake isn't laid along the cycle, keep to the cycle where it's
+    // free until the body catches up
+    u32 next_dir = cycle->next_dir[head_index];
+    if(!cycle->ordered || level->tick_count != (cycle->ordered_tick + 1)) {
+        cycle->ordered = snake_in_cycle_order(cycle, level);
+    }
+    cycle->ordered_tick = level->tick_count;
+    if(!cycle->ordered) {
+        u32 best_distance = CYCLE_NO_TILE;
+        for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+            vec2i next_pos;
+            if(!step_tile_pos(level, level->snake_head, dir, &next_pos)) {
+                continue;
+            }
+            
+            tile_type type = get_tile(level, next_pos.x, next_pos.y).type;
+            bool into_tail = (next_pos == level->snake_tail && level->add_snake_parts == 0);
+            if(type == TILE_wall || (type == TILE_snake && !into_tail)) {
+                continue;
+            }
+            
+            u32 distance = cycle_distance(cycle, head, cycle->order[next_pos.y * cycle->width + next_pos.x]);
+            if(distance < best_distance) {
+                best_distance = distance;
+                next_dir = dir;
+            }
+        }
+        
+        if(best_distance == CYCLE_NO_TILE) {
+            return false;
+        }
+        *head_dir = dir_to_vec2i(next_dir);
+        return true;
+    }
+    
+    // NOTE: take the tile furthest ahead on the cycle that doesn't skip the apple and leaves
+    // room in front of the tail for the parts still to grow. The body is in order behind
+    // the head, so tail_distance is already the free run ahead of it.
+    // Past half the level the tiles a shortcut skips stay free behind the head until the
+    // tail passes them, apples land there and cost a whole lap, so the snake keeps to the cycle
+    if(level->apple_pos.x != -1 && level->apple_pos.y != -1 && (level->snake_count * 2) < cycle->length) {
+        u32 tail_distance  = cycle_distance(cycle, head, cycle->order[level->snake_tail.y * cycle->width + level->snake_tail.x]);
+        u32 apple_distance = cycle_distance(cycle, head, cycle->order[level->apple_pos.y * cycle->width + level->apple_pos.x]);
+        u32 best_distance = 1;
+        for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+            vec2i next_pos;
+            if(!step_tile_pos(level, level->snake_head, dir, &next_pos)) {
+                continue;
+            }
+            
+            tile_type type = get_tile(level, next_pos.x, next_pos.y).type;
+            if(type == TILE_wall || type == TILE_snake) {
+                continue;
+            }
+            
+            u32 distance = cycle_distance(cycle, head, cycle->order[next_pos.y * cycle->width + next_pos.x]);
+            if(distance > best_distance && distance <= apple_distance &&
+               (distance + level->add_snake_parts + CYCLE_SHORTCUT_MARGIN) < tail_distance) {
+                best_distance = distance;
+                next_dir = dir;
+            }
+        }
+    }
+    *head_dir = dir_to_vec2i(next_dir);
+    return true;
+}
+
+// NOTE: plays a level headless with the cycle until it's won or lost
+static CycleBenchResult
+run_cycle_benchmark(LevelParams params, MemoryArena *arena, PlatformProcs *procs) {
+    CycleBenchResult result = {};
+    TemporaryMemory memory = begin_temporary_memory(arena);
+    
+    Level level = make_level(params, arena);
+    result.tile_count = level.width * level.height;
+    
+    HamiltonCycle cycle;
+    result.built = build_hamilton_cycle(&cycle, &level, level.params.seed, arena);
+    if(result.built) {
+        // NOTE: length squared overflows u32 from a 256x256 board
+        u64 max_moves = (u64)cycle.length * (u64)cycle.length * 2;
+        f64 start = procs->get_wall_clock();
+        while(result.moves < max_moves) {
+            vec2i head_dir;
+            if(!hamilton_next_dir(&cycle, &level, &head_dir)) {
+                break;
+            }
+            level.snake_next_dir[0] = head_dir;
+            snake_event event = tick_snake(&level, head_dir);
+            ++result.moves;
+            if(event == SNAKE_died) {
+                break;
+            }
+            else if(event == SNAKE_won) {
+                result.won = true;
+                break;
+            }
+        }
+        result.seconds = procs->get_wall_clock() - start;
+    }
+    result.score = level.score;
+    
+    release_level(&level);
+    end_temporary_memory(memory);
+    return result;
+}
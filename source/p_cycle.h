@@ -0,0 +1,40 @@
+#ifndef P_CYCLE_H
+#define P_CYCLE_H
+
+// NOTE: Hamiltonian cycle through every open tile of the level, built by walking around
+// a spanning tree of 2x2 blocks. Needs an even sized level and walls that fill whole blocks.
+// Following the cycle always wins, shortcuts skip ahead on it while the snake covers less
+// than half the level and only when the body stays in cycle order behind the head.
+
+#define CYCLE_NO_TILE U32_MAX
+#define CYCLE_SHORTCUT_MARGIN 2
+
+struct HamiltonCycle {
+    bool valid;
+    u32  width;
+    u32  height;
+    u32  length;     // NOTE: open tile count
+    u32 *order;      // NOTE: position of the tile on the cycle, CYCLE_NO_TILE for walls
+    u8  *next_dir;   // NOTE: snake_dir to the next tile on the cycle
+    
+    // NOTE: once in order the snake stays in order while it only takes our moves
+    bool ordered;
+    u32  ordered_tick;
+};
+
+struct CycleBenchResult {
+    bool built;
+    bool won;
+    u64  moves;
+    u32  score;
+    u32  tile_count;
+    f64  seconds;
+};
+
+static bool  build_hamilton_cycle(HamiltonCycle *cycle, Level *level, random_seed seed, MemoryArena *arena);
+inline u32   cycle_distance(HamiltonCycle *cycle, u32 from, u32 to);
+static bool  snake_in_cycle_order(HamiltonCycle *cycle, Level *level);
+static bool  hamilton_next_dir(HamiltonCycle *cycle, Level *level, vec2i *head_dir);
+static CycleBenchResult run_cycle_benchmark(LevelParams params, MemoryArena *arena, PlatformProcs *procs);
+
+#endif /* P_CYCLE_H */
@@ -1,6 +1,13 @@
 #ifndef P_GAME_DECLS_H
 #define P_GAME_DECLS_H
 
+// NOTE: the procs the platform looks up by name in the game's dll / so
+#if defined(_MSC_VER)
+#define GAME_EXPORT extern "C" __declspec(dllexport)
+#else
+#define GAME_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
 #define GAME_INIT_PROC(name) bool name(Core *_core)
 typedef GAME_INIT_PROC(game_init_proc);
 
@@ -17,10 +24,10 @@ typedef GAME_HOTLOAD_CALLBACK_PROC(game_hotload_callback_proc);
 typedef GAME_GET_STARTUP_PARAMS_PROC(game_get_startup_params_proc);
 
 /*
-extern "C" __declspec(dllexport) GAME_FRAME_PROC(game_frame);
-extern "C" __declspec(dllexport) GAME_SIZE_CALLBACK_PROC(size_callback);
-extern "C" __declspec(dllexport) GAME_HOTLOAD_CALLBACK_PROC(hotload_callback);
-extern "C" __declspec(dllexport) GAME_GET_STARTUP_PARAMS_PROC(get_startup_params);
+GAME_EXPORT GAME_FRAME_PROC(game_frame);
+GAME_EXPORT GAME_SIZE_CALLBACK_PROC(size_callback);
+GAME_EXPORT GAME_HOTLOAD_CALLBACK_PROC(hotload_callback);
+GAME_EXPORT GAME_GET_STARTUP_PARAMS_PROC(get_startup_params);
 */
 
 #endif /* P_GAME_DECLS_H */
@@ -1,11 +1,27 @@
 #include "p_platform_common.h"
+#include "p_bitboard.h"
+#include "p_bitboard.cpp"
 #include "p_game_main.h"
+#include "p_sim.h"
+#include "p_sim.cpp"
+#include "p_replay.h"
+#include "p_replay.cpp"
+#include "p_maze.h"
+#include "p_maze.cpp"
+#include "p_level_file.h"
+#include "p_level_file.cpp"
+#include "p_mcts.h"
+#include "p_mcts.cpp"
+#include "p_cycle.h"
+#include "p_cycle.cpp"
+#include "p_autopilot.h"
+#include "p_autopilot.cpp"
 
-extern "C" __declspec(dllexport) GAME_INIT_PROC(game_init);
-extern "C" __declspec(dllexport) GAME_FRAME_PROC(game_frame);
-extern "C" __declspec(dllexport) GAME_SIZE_CALLBACK_PROC(size_callback);
-extern "C" __declspec(dllexport) GAME_HOTLOAD_CALLBACK_PROC(hotload_callback);
-extern "C" __declspec(dllexport) GAME_GET_STARTUP_PARAMS_PROC(get_startup_params);
+GAME_EXPORT GAME_INIT_PROC(game_init);
+GAME_EXPORT GAME_FRAME_PROC(game_frame);
+GAME_EXPORT GAME_SIZE_CALLBACK_PROC(size_callback);
+GAME_EXPORT GAME_HOTLOAD_CALLBACK_PROC(hotload_callback);
+GAME_EXPORT GAME_GET_STARTUP_PARAMS_PROC(get_startup_params);
 
 static Core     *core;
 static Input    *input;
@@ -19,65 +35,288 @@ void setup_globals(Core *core_ptr, Input *input_ptr) {
     game_data = (GameData *)core->memory->permanent_memory.ptr;
 }
 
-static Tile *
+inline u32
+get_chunk_tile_index(u32 x, u32 y) {
+    u32 result = ((y & (LEVEL_CHUNK_SIZE - 1)) << LEVEL_CHUNK_SHIFT) | (x & (LEVEL_CHUNK_SIZE - 1));
+    return result;
+}
+
+static LevelChunk *
+acquire_level_chunk(Level *level, u32 chunk_index) {
+    assert(!level->chunks[chunk_index]);
+    LevelChunk *chunk = level->free_chunks;
+    if(chunk) {
+        level->free_chunks = chunk->next_free;
+    }
+    else {
+        chunk = push_struct(level->chunk_arena, LevelChunk);
+    }
+    
+    u32 x0 = (chunk_index % level->chunks_x) << LEVEL_CHUNK_SHIFT;
+    u32 y0 = (chunk_index / level->chunks_x) << LEVEL_CHUNK_SHIFT;
+    u32 chunk_w = min_value(level->width - x0, LEVEL_CHUNK_SIZE);
+    u32 chunk_h = min_value(level->height - y0, LEVEL_CHUNK_SIZE);
+    zero_memory(chunk->tiles, sizeof(chunk->tiles));
+    chunk->free_count = chunk_w * chunk_h;
+    chunk->tile_count = chunk->free_count;
+    chunk->next_free = nullptr;
+    
+    level->chunks[chunk_index] = chunk;
+    ++level->chunk_count;
+    return chunk;
+}
+
+static void
+release_level_chunk(Level *level, u32 chunk_index) {
+    LevelChunk *chunk = level->chunks[chunk_index];
+    assert(chunk);
+    chunk->next_free = level->free_chunks;
+    level->free_chunks = chunk;
+    level->chunks[chunk_index] = nullptr;
+    --level->chunk_count;
+}
+
+// NOTE: tiles of the word that are inside the level, 'word' covers half a row of the chunk
+inline u32
+get_word_tile_count(u32 word, u32 chunk_w, u32 chunk_h) {
+    u32 row = word >> 1;
+    u32 column = (word & 1) * 32;
+    if(row >= chunk_h || column >= chunk_w) {
+        return 0;
+    }
+    return min_value(chunk_w - column, 32);
+}
+
+static void
+init_level_free_index(Level *level) {
+    u32 chunk_total = level->chunks_x * level->chunks_y;
+    u32 *tree = level->chunk_free_tree;
+    zero_memory(tree, (chunk_total + 1) * sizeof(u32));
+    
+    for(u32 chunk_index = 0; chunk_index < chunk_total; ++chunk_index) {
+        u32 x0 = (chunk_index % level->chunks_x) << LEVEL_CHUNK_SHIFT;
+        u32 y0 = (chunk_index / level->chunks_x) << LEVEL_CHUNK_SHIFT;
+        u32 chunk_w = min_value(level->width - x0, LEVEL_CHUNK_SIZE);
+        u32 chunk_h = min_value(level->height - y0, LEVEL_CHUNK_SIZE);
+        LevelChunk *chunk = level->chunks[chunk_index];
+        
+        u8 *word_free = level->word_free_counts + chunk_index * LEVEL_CHUNK_WORDS;
+        for(u32 word = 0; word < LEVEL_CHUNK_WORDS; ++word) {
+            word_free[word] = (u8)(chunk ? popcount_u64(get_chunk_free_mask(chunk, word, chunk_w, chunk_h)) : 
+                                   get_word_tile_count(word, chunk_w, chunk_h));
+        }
+        
+        // NOTE: each node adds itself to its parent, the tree is built in one pass
+        u32 node = chunk_index + 1;
+        tree[node] += chunk ? chunk->free_count : chunk_w * chunk_h;
+        u32 parent = node + (node & (~node + 1));
+        if(parent <= chunk_total) {
+            tree[parent] += tree[node];
+        }
+    }
+}
+
+static void
+add_chunk_free_count(Level *level, u32 chunk_index, u32 word, i32 delta) {
+    u32 chunk_total = level->chunks_x * level->chunks_y;
+    level->word_free_counts[chunk_index * LEVEL_CHUNK_WORDS + word] += (u8)delta;
+    for(u32 node = chunk_index + 1; node <= chunk_total; node += node & (~node + 1)) {
+        level->chunk_free_tree[node] += (u32)delta;
+    }
+}
+
+// NOTE: the chunk holding the index-th free tile, 'index' is left relative to the chunk
+static u32
+find_free_chunk(Level *level, u32 *index) {
+    u32 chunk_total = level->chunks_x * level->chunks_y;
+    u32 step = 1;
+    while((step << 1) <= chunk_total) {
+        step <<= 1;
+    }
+    
+    u32 node = 0;
+    for(; step; step >>= 1) {
+        if((node + step) <= chunk_total && level->chunk_free_tree[node + step] <= *index) {
+            node += step;
+            *index -= level->chunk_free_tree[node];
+        }
+    }
+    return node;
+}
+
+inline tile_type
+get_chunk_tile(LevelChunk *chunk, u32 tile_index) {
+    u64 word = chunk->tiles[tile_index >> 5];
+    tile_type result = (tile_type)((word >> ((tile_index & 31) * LEVEL_TILE_BITS)) & LEVEL_TILE_MASK);
+    return result;
+}
+
+// NOTE: low bit of every 2 bit pair set for the TILE_none tiles of the word that are inside the level
+inline u64
+get_chunk_free_mask(LevelChunk *chunk, u32 word, u32 chunk_w, u32 chunk_h) {
+    u32 row = word >> 1;
+    u32 column = (word & 1) * 32;
+    if(row >= chunk_h || column >= chunk_w) {
+        return 0;
+    }
+    
+    u64 mask = 0x5555555555555555ull;
+    u32 columns = chunk_w - column;
+    if(columns < 32) {
+        mask &= (1ull << (columns * LEVEL_TILE_BITS)) - 1;
+    }
+    u64 tiles = chunk->tiles[word];
+    u64 result = ~(tiles | (tiles >> 1)) & mask;
+    return result;
+}
+
+// NOTE: tiles are packed, this returns a copy, change them with set_tile
+static Tile
 get_tile(Level *level, u32 x, u32 y) {
     assert(x >= 0 && x < level->width);
     assert(y >= 0 && y < level->height);
-    Tile *tile = &level->tiles[y * level->width + x];
+    Tile tile = { TILE_none };
+    LevelChunk *chunk = level->chunks[(y >> LEVEL_CHUNK_SHIFT) * level->chunks_x + (x >> LEVEL_CHUNK_SHIFT)];
+    if(chunk) {
+        tile.type = get_chunk_tile(chunk, get_chunk_tile_index(x, y));
+    }
     return tile;
 }
 
+inline Bitboard *
+get_tile_bits(Level *level, tile_type type) {
+    if(!level->wall_bits.words) {
+        return nullptr;
+    }
+    
+    switch(type) {
+        case TILE_wall:  return &level->wall_bits;
+        case TILE_apple: return &level->apple_bits;
+        case TILE_snake: return &level->snake_bits;
+    }
+    return nullptr;
+}
+
 static void
 set_tile(Level *level, u32 x, u32 y, tile_type type) {
     assert(x >= 0 && x < level->width);
     assert(y >= 0 && y < level->height);
-    Tile *tile = get_tile(level, x, y);
-    tile->type = type;
+    u32 chunk_index = (y >> LEVEL_CHUNK_SHIFT) * level->chunks_x + (x >> LEVEL_CHUNK_SHIFT);
+    LevelChunk *chunk = level->chunks[chunk_index];
+    if(!chunk) {
+        if(type == TILE_none) {
+            return;
+        }
+        chunk = acquire_level_chunk(level, chunk_index);
+    }
+    
+    u32 tile_index = get_chunk_tile_index(x, y);
+    tile_type old_type = get_chunk_tile(chunk, tile_index);
+    if(old_type == TILE_none && type != TILE_none) {
+        --chunk->free_count;
+        --level->free_count;
+        add_chunk_free_count(level, chunk_index, tile_index >> 5, -1);
+    }
+    else if(old_type != TILE_none && type == TILE_none) {
+        ++chunk->free_count;
+        ++level->free_count;
+        add_chunk_free_count(level, chunk_index, tile_index >> 5, 1);
+    }
+    
+    Bitboard *old_bits = get_tile_bits(level, old_type);
+    Bitboard *new_bits = get_tile_bits(level, type);
+    if(old_bits) { bitboard_clear(old_bits, x, y); }
+    if(new_bits) { bitboard_set(new_bits, x, y); }
+    
+    u32 shift = (tile_index & 31) * LEVEL_TILE_BITS;
+    u64 *word = &chunk->tiles[tile_index >> 5];
+    *word = (*word & ~(LEVEL_TILE_MASK << shift)) | ((u64)type << shift);
+    mark_level_dirty(level, x, y, 1, 1);
+    
+    if(chunk->free_count == chunk->tile_count) {
+        release_level_chunk(level, chunk_index);
+    }
+}
+
+inline TileRect
+empty_tile_rect(void) {
+    TileRect rect = { { 1, 1 }, { 0, 0 } };
+    return rect;
+}
+
+inline bool
+is_empty(TileRect rect) {
+    return rect.min.x > rect.max.x || rect.min.y > rect.max.y;
+}
+
+static void
+add_to_tile_rect(TileRect *rect, u32 x, u32 y, u32 width, u32 height) {
+    vec2i min = { (i32)x, (i32)y };
+    vec2i max = { (i32)(x + width - 1), (i32)(y + height - 1) };
+    if(is_empty(*rect)) {
+        rect->min = min;
+        rect->max = max;
+        return;
+    }
+    rect->min = { min_value(rect->min.x, min.x), min_value(rect->min.y, min.y) };
+    rect->max = { max_value(rect->max.x, max.x), max_value(rect->max.y, max.y) };
+}
+
+static void
+add_to_tile_rect(TileRect *rect, TileRect other) {
+    if(!is_empty(other)) {
+        add_to_tile_rect(rect, other.min.x, other.min.y, other.max.x - other.min.x + 1, other.max.y - other.min.y + 1);
+    }
+}
+
+static void
+mark_level_dirty(Level *level, u32 x, u32 y, u32 width, u32 height) {
+    add_to_tile_rect(&level->tile_map_dirty, x, y, width, height);
+    add_to_tile_rect(&level->fb_dirty, x, y, width, height);
 }
 
 static vec2i
 get_free_tile_pos(Level *level) {
-    i32 x_apple = 0;
-    i32 y_apple = 0;
-    
-    if((level->snake_count + level->add_snake_parts) >= (level->width * level->height + 1)) {
+    if(!level->free_count) {
         return { -1, -1 };
     }
     
-    while(true) {
-        if((level->width - 1) <= 0) {
-            x_apple = 0;
-        }
-        else {
-            x_apple = rand_i32_in_range(&game_data->random, 0, level->width  - 1);
-        }
-        
-        if((level->height - 1) <= 0) {
-            y_apple = 0;
-        }
-        else {
-            y_apple = rand_i32_in_range(&game_data->random, 0, level->height - 1);
-        }
-        
-        bool on_snake = false;
-        for(u32 i = 0; i < level->snake_count; ++i) {
-            SnakePart *part = level->snake_parts + i;
-            if(x_apple == part->tile_pos.x && y_apple == part->tile_pos.y) {
-                on_snake = true;
-                break;
-            }
-        }
-        
-        bool on_wall = false;
-        Tile *tile = get_tile(level, x_apple, y_apple);
-        if(tile->type == TILE_wall) {
-            on_wall = true;
+    u32 index = 0;
+    if(level->free_count > 1) {
+        index = rand_u32_in_range(&level->random, 0, level->free_count - 1);
+    }
+    
+    u32 chunk_index = find_free_chunk(level, &index);
+    ASSERT(chunk_index < level->chunks_x * level->chunks_y, "free_count out of sync with the chunks");
+    u32 x0 = (chunk_index % level->chunks_x) << LEVEL_CHUNK_SHIFT;
+    u32 y0 = (chunk_index / level->chunks_x) << LEVEL_CHUNK_SHIFT;
+    u32 chunk_w = min_value(level->width - x0, LEVEL_CHUNK_SIZE);
+    u32 chunk_h = min_value(level->height - y0, LEVEL_CHUNK_SIZE);
+    LevelChunk *chunk = level->chunks[chunk_index];
+    if(!chunk) {
+        // NOTE: empty chunks are all free
+        vec2i result = { (i32)(x0 + index % chunk_w), (i32)(y0 + index / chunk_w) };
+        return result;
+    }
+    
+    // NOTE: find the word holding the index-th free tile, then the bit in it
+    u8 *word_free = level->word_free_counts + chunk_index * LEVEL_CHUNK_WORDS;
+    for(u32 word = 0; word < LEVEL_CHUNK_WORDS; ++word) {
+        if(index >= word_free[word]) {
+            index -= word_free[word];
+            continue;
         }
         
-        if(!on_wall && !on_snake) {
-            return { x_apple, y_apple };
+        u64 mask = get_chunk_free_mask(chunk, word, chunk_w, chunk_h);
+        for(; index > 0; --index) {
+            mask &= mask - 1;
         }
+        u32 local = word * 32 + popcount_u64((mask & (~mask + 1)) - 1) / LEVEL_TILE_BITS;
+        vec2i result = { (i32)(x0 + (local & (LEVEL_CHUNK_SIZE - 1))), (i32)(y0 + (local >> LEVEL_CHUNK_SHIFT)) };
+        return result;
     }
+    
+    ASSERT(false, "free_count out of sync with the chunks");
     return { -1, -1 };
 }
 
@@ -105,12 +344,11 @@ get_level(game_level _level) {
 #define MAX_CAMERA_Y_POS 10.0f
 static vec2
 get_desired_camera_xy(Level *level) {
-    SnakePart *head = level->head;
     f32 x_perc = 0.5f;
     f32 y_perc = 0.5f;
-    if(head) {
-        x_perc = (f32)head->tile_pos.x / ((f32)level->width);
-        y_perc = (f32)head->tile_pos.y / ((f32)level->height);
+    if(level->snake_count) {
+        x_perc = (f32)level->snake_head.x / ((f32)level->width);
+        y_perc = (f32)level->snake_head.y / ((f32)level->height);
     }
     
     x_perc = (x_perc * 2.0f) - 1.0f;
@@ -131,30 +369,276 @@ get_desired_camera_xy(Level *level) {
     return { desired_x_pos, desired_y_pos };
 }
 
+// NOTE: what push_level_memory takes plus every chunk, a level that fits can't run out of chunks
+static u64
+get_level_memory_size(u32 width, u32 height) {
+    u64 tile_count  = (u64)width * (u64)height;
+    u64 chunk_total = (u64)((width  + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT) * 
+                      (u64)((height + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT);
+    u64 size = chunk_total * (sizeof(LevelChunk *) + sizeof(LevelChunk) + LEVEL_CHUNK_WORDS);
+    size += (chunk_total + 1) * sizeof(u32);
+    size += (min_value(tile_count + 1, LEVEL_MAX_SNAKE_PARTS) + 3) / 4;
+    if(tile_count <= LEVEL_MAX_BITBOARD_TILES) {
+        size += 3 * ((width + 64) / 64) * (height + 2) * sizeof(u64);
+    }
+    return size;
+}
+
+static void
+push_level_memory(Level *level, MemoryArena *arena) {
+    u32 tile_count = level->width * level->height;
+    level->chunks_x    = (level->width  + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+    level->chunks_y    = (level->height + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT;
+    level->chunks      = push_array(arena, LevelChunk *, level->chunks_x * level->chunks_y);
+    level->chunk_count = 0;
+    level->free_chunks = nullptr;
+    level->chunk_arena = arena;
+    level->free_count  = tile_count;
+    zero_memory(level->chunks, level->chunks_x * level->chunks_y * sizeof(LevelChunk *));
+    
+    level->chunk_free_tree  = push_array(arena, u32, level->chunks_x * level->chunks_y + 1);
+    level->word_free_counts = push_array(arena, u8, level->chunks_x * level->chunks_y * LEVEL_CHUNK_WORDS);
+    init_level_free_index(level);
+    
+    level->snake_max  = min_value(tile_count + 1, LEVEL_MAX_SNAKE_PARTS);
+    level->snake_dirs = push_array(arena, u8, (level->snake_max + 3) / 4);
+    
+    level->wall_bits  = {};
+    level->apple_bits = {};
+    level->snake_bits = {};
+    if(tile_count <= LEVEL_MAX_BITBOARD_TILES) {
+        level->wall_bits  = make_bitboard(level->width, level->height, arena);
+        level->apple_bits = make_bitboard(level->width, level->height, arena);
+        level->snake_bits = make_bitboard(level->width, level->height, arena);
+    }
+}
+
+// NOTE: bytes of the ring holding the live parts, the other entries in them don't matter
+static void
+copy_snake_ring(Level *dest, Level *source) {
+    ASSERT(dest->snake_max == source->snake_max, "snake ring size mismatch");
+    if(!source->snake_count) {
+        return;
+    }
+    
+    u32 first = source->snake_first;
+    u32 end = first + source->snake_count;
+    if(end <= source->snake_max) {
+        copy_memory(source->snake_dirs + (first >> 2), dest->snake_dirs + (first >> 2), ((end + 3) >> 2) - (first >> 2));
+    }
+    else {
+        u32 ring_bytes = (source->snake_max + 3) >> 2;
+        copy_memory(source->snake_dirs + (first >> 2), dest->snake_dirs + (first >> 2), ring_bytes - (first >> 2));
+        copy_memory(source->snake_dirs, dest->snake_dirs, (end - source->snake_max + 3) >> 2);
+    }
+}
+
+// NOTE: the fork gets the chunk table, the live chunks, the free index, the bitboards and
+// the live part of the snake ring, all in 'arena'. Chunks it gains come from 'arena' too and
+// its dirty rects start empty so commit_level knows what changed. Level file chunks are
+// copied as well, the fork never writes to the source
+static LevelFork
+fork_level(Level *source, MemoryArena *arena) {
+    LevelFork fork = {};
+    fork.memory = begin_temporary_memory(arena);
+    
+    Level *level = &fork.level;
+    *level = *source;
+    level->map_file = {};
+    level->chunk_arena = arena;
+    level->free_chunks = nullptr;
+    level->tile_map_dirty = empty_tile_rect();
+    level->fb_dirty = empty_tile_rect();
+    
+    u32 chunk_total = source->chunks_x * source->chunks_y;
+    level->chunks = push_array(arena, LevelChunk *, chunk_total);
+    LevelChunk *chunks = push_array(arena, LevelChunk, source->chunk_count);
+    u32 chunk_count = 0;
+    for(u32 chunk_index = 0; chunk_index < chunk_total; ++chunk_index) {
+        LevelChunk *source_chunk = source->chunks[chunk_index];
+        level->chunks[chunk_index] = nullptr;
+        if(source_chunk) {
+            LevelChunk *chunk = chunks + chunk_count++;
+            copy_memory(source_chunk, chunk, sizeof(LevelChunk));
+            chunk->next_free = nullptr;
+            level->chunks[chunk_index] = chunk;
+        }
+    }
+    ASSERT(chunk_count == source->chunk_count, "chunk_count out of sync with the chunks");
+    
+    level->chunk_free_tree  = push_array(arena, u32, chunk_total + 1);
+    level->word_free_counts = push_array(arena, u8, chunk_total * LEVEL_CHUNK_WORDS);
+    copy_memory(source->chunk_free_tree, level->chunk_free_tree, (chunk_total + 1) * sizeof(u32));
+    copy_memory(source->word_free_counts, level->word_free_counts, chunk_total * LEVEL_CHUNK_WORDS);
+    
+    level->snake_dirs = push_array(arena, u8, (source->snake_max + 3) / 4);
+    copy_snake_ring(level, source);
+    
+    if(source->wall_bits.words) {
+        level->wall_bits  = make_bitboard_copy(&source->wall_bits, arena);
+        level->apple_bits = make_bitboard_copy(&source->apple_bits, arena);
+        level->snake_bits = make_bitboard_copy(&source->snake_bits, arena);
+    }
+    return fork;
+}
+
+// NOTE: 'dest' is the level the fork was made from. Only the chunks and the bitboard
+// rows under the tiles the fork changed are copied back, then the fork is discarded
+static void
+commit_level(Level *dest, LevelFork *fork) {
+    Level *source = &fork->level;
+    ASSERT(dest->width == source->width && dest->height == source->height, "level size mismatch");
+    ASSERT(dest->chunk_arena != fork->memory.arena, "level chunks live in the fork arena");
+    
+    TileRect dirty = source->tile_map_dirty;
+    if(!is_empty(dirty)) {
+        u32 cx0 = (u32)dirty.min.x >> LEVEL_CHUNK_SHIFT;
+        u32 cy0 = (u32)dirty.min.y >> LEVEL_CHUNK_SHIFT;
+        u32 cx1 = (u32)dirty.max.x >> LEVEL_CHUNK_SHIFT;
+        u32 cy1 = (u32)dirty.max.y >> LEVEL_CHUNK_SHIFT;
+        for(u32 cy = cy0; cy <= cy1; ++cy) {
+            for(u32 cx = cx0; cx <= cx1; ++cx) {
+                u32 chunk_index = cy * dest->chunks_x + cx;
+                LevelChunk *source_chunk = source->chunks[chunk_index];
+                LevelChunk *dest_chunk = dest->chunks[chunk_index];
+                if(!source_chunk) {
+                    if(dest_chunk) {
+                        release_level_chunk(dest, chunk_index);
+                    }
+                    continue;
+                }
+                
+                if(!dest_chunk) {
+                    dest_chunk = acquire_level_chunk(dest, chunk_index);
+                }
+                copy_memory(source_chunk, dest_chunk, sizeof(LevelChunk));
+                dest_chunk->next_free = nullptr;
+            }
+            
+            u32 words = (cx1 - cx0 + 1) * LEVEL_CHUNK_WORDS;
+            u32 offset = (cy * dest->chunks_x + cx0) * LEVEL_CHUNK_WORDS;
+            copy_memory(source->word_free_counts + offset, dest->word_free_counts + offset, words);
+        }
+        
+        if(dest->wall_bits.words) {
+            u32 offset = dirty.min.y * dest->wall_bits.words_per_row;
+            u32 size = (dirty.max.y - dirty.min.y + 1) * dest->wall_bits.words_per_row * sizeof(u64);
+            copy_memory(source->wall_bits.words + offset, dest->wall_bits.words + offset, size);
+            copy_memory(source->apple_bits.words + offset, dest->apple_bits.words + offset, size);
+            copy_memory(source->snake_bits.words + offset, dest->snake_bits.words + offset, size);
+        }
+    }
+    
+    u32 chunk_total = dest->chunks_x * dest->chunks_y;
+    copy_memory(source->chunk_free_tree, dest->chunk_free_tree, (chunk_total + 1) * sizeof(u32));
+    copy_snake_ring(dest, source);
+    
+    // NOTE: the rest is plain values, the pointers and the dirty rects stay the dest's
+    Level level = *dest;
+    *dest = *source;
+    dest->chunks           = level.chunks;
+    dest->chunk_count      = level.chunk_count;
+    dest->free_chunks      = level.free_chunks;
+    dest->chunk_arena      = level.chunk_arena;
+    dest->map_file         = level.map_file;
+    dest->wall_bits        = level.wall_bits;
+    dest->apple_bits       = level.apple_bits;
+    dest->snake_bits       = level.snake_bits;
+    dest->chunk_free_tree  = level.chunk_free_tree;
+    dest->word_free_counts = level.word_free_counts;
+    dest->snake_dirs       = level.snake_dirs;
+    dest->tile_map_dirty   = level.tile_map_dirty;
+    dest->fb_dirty         = level.fb_dirty;
+    ASSERT(dest->chunk_count == source->chunk_count, "chunk_count out of sync with the fork");
+    add_to_tile_rect(&dest->tile_map_dirty, dirty);
+    add_to_tile_rect(&dest->fb_dirty, dirty);
+    
+    discard_level(fork);
+}
+
+static void
+discard_level(LevelFork *fork) {
+    end_temporary_memory(fork->memory);
+    fork->level = {};
+}
+
+// NOTE: the arena memory goes with the arena, this is for what lives outside of it
+static void
+release_level(Level *level) {
+    if(level->map_file.contents) {
+        core->procs->unmap_file(&level->map_file);
+    }
+    level->initialized = false;
+}
+
 static Level 
 make_level(LevelParams params, MemoryArena *arena) {
+    // NOTE: the file has the rest of the params, the seed and the name stay
+    MappedFile map_file = {};
+    LevelFileHeader *header = nullptr;
+    if(params.map_name[0]) {
+        header = map_level_file(params.map_name, &map_file, &game_data->temporary_memory, core->procs);
+        if(!header) {
+            game_log("level file '%s' failed to load...\n", params.map_name);
+            return {};
+        }
+        
+        LevelParams file_params = header->params;
+        file_params.seed = params.seed;
+        copy_memory(params.map_name, file_params.map_name, sizeof(params.map_name));
+        params = file_params;
+    }
+    
+    // NOTE: xorshift gets stuck on 0
+    while(!params.seed) {
+        params.seed = rand_u64(&game_data->random);
+    }
+    
+    // NOTE: random walls can land in every chunk of a big level
+    if(get_level_memory_size(params.width, params.height) > (u64)(arena->size - arena->used)) {
+        game_log("level %ux%u doesn't fit in the level arena...\n", params.width, params.height);
+        if(header) {
+            core->procs->unmap_file(&map_file);
+        }
+        return {};
+    }
+    
     Level level = {};
     level.initialized = true;
+    level.params = params;
+    level.random = params.seed;
+    level.tick_count = 0;
     level.looping = params.looping;
     level.width  = params.width;
     level.height = params.height;
-    level.tiles  = push_array(arena, Tile, params.width * params.height);
-    level.snake_max   = params.width * params.height;
+    push_level_memory(&level, arena);
+    if(header) {
+        attach_level_file(&level, header);
+        level.map_file = map_file;
+        level.map_hash = header->source_hash;
+    }
+    mark_level_dirty(&level, 0, 0, level.width, level.height);
+    
+    level.snake_first = 0;
     level.snake_count = 0;
-    level.snake_parts = push_array(arena, SnakePart, level.snake_max);
     level.score = 0;
     level.move_time = params.time_per_move;
     level.move_counter = 0.0f;
+    level.apple_pos = { -1, -1 };
     
-    for(u32 y = 0; y < level.height; ++y) {
-        for(u32 x = 0; x < level.width; ++x) {
-            Tile *tile = get_tile(&level, x, y);
-            tile->type = TILE_none;
+    if(params.snake_info.length > 0) {
+        init_snake(&level, params.snake_info.head_pos, params.snake_info.move_dir, params.snake_info.length);
+    }
+    
+    for(u32 i = 0; i < params.wall_count; ++i) {
+        vec2i free_pos = get_free_tile_pos(&level);
+        if(free_pos.x != -1 && free_pos.y != -1) {
+            set_tile(&level, free_pos.x, free_pos.y, TILE_wall);
         }
     }
     
-    if(params.snake_info.length > 0) {
-        init_snake(&level, params.snake_info.head_pos, params.snake_info.move_dir, params.snake_info.length);
+    if(params.wall_pattern != WALLS_none) {
+        generate_level_walls(&level);
     }
     
     if(params.init_apple) {
@@ -178,98 +662,77 @@ make_level(LevelParams params, MemoryArena *arena) {
 
 static void 
 init_snake(Level *level, vec2i start_pos, vec2i dir, u32 count) {
-    assert(!level->head);
     assert(!level->snake_count);
+    assert((count + 1) <= level->snake_max);
+    
+    level->snake_head = start_pos;
+    level->snake_tail = start_pos;
+    for(u32 i = 0; i <= count; ++i) {
+        if(i > 0) {
+            level->snake_tail -= dir;
+            if(level->looping) {
+                maybe_warp(level, &level->snake_tail);
+            }
+        }
+        
+        // NOTE: level files with a snake off the board are rejected by parse_level_text
+        ASSERT(is_in_bounds(level->snake_tail.x, 0, (i32)(level->width - 1)) &&
+               is_in_bounds(level->snake_tail.y, 0, (i32)(level->height - 1)), "snake starts off the board");
+        set_tile(level, level->snake_tail.x, level->snake_tail.y, TILE_snake);
+    }
     
-    SnakePart *head = &level->snake_parts[level->snake_count++];
-    head->tile_pos = start_pos;
-    head->move_dir = dir;
-    head->last_tile_pos = head->tile_pos - head->move_dir;
-    head->last_move_dir = head->move_dir;
-    
-    SnakePart *last = head;
-    for(u32 i = 0; i < count; ++i) {
-        SnakePart *next = &level->snake_parts[level->snake_count++];
-        next->tile_pos = last->tile_pos - last->move_dir;
-        next->move_dir = last->move_dir;
-        next->last_tile_pos = next->tile_pos - next->move_dir;
-        next->last_move_dir = next->move_dir;
-        last = next;
+    // NOTE: head and 'count' parts behind it, all moving the same way
+    level->snake_first = 0;
+    level->snake_count = count + 1;
+    for(u32 i = 0; i < level->snake_count; ++i) {
+        set_ring_snake_dir(level, i, vec2i_to_dir(dir));
     }
+    level->tail_stayed = false;
     
-    level->head = head;
-    level->snake_next_dir[0] = head->move_dir;
+    level->snake_next_dir[0] = dir;
     level->snake_next_dir_count = 1;
 }
 
 static void
 init_game(void) {
     game_data->gameover = false;
+    game_data->recording_level = nullptr;
+    game_data->playback_level  = nullptr;
+    reset_autopilot(game_data->autopilot);
     
+    // NOTE: levels are built when they're picked, see load_level
+    for(u32 i = 0; i < LEVEL_COUNT; ++i) {
+        release_level(&game_data->levels[i]);
+    }
+    release_level(&game_data->level_custom);
+    zero_memory(game_data->level_arena.base, game_data->level_arena.used);
     game_data->level_arena.used = 0;
-    zero_memory(game_data->level_arena.base, game_data->level_arena.size);
-    
-    /* NOTE: LEVEL_standard */ {
-        LevelParams params = {
-            true,
-            true,
-            16, 16,
-            25.0f,
-            0.15f,
-            { { 6, 6 }, { 1, 0 }, 4 }
-        };
-        
-        Level *level = &game_data->levels[LEVEL_standard];
-        *level = make_level(params, &game_data->level_arena);
-    }
-    
-    /* NOTE: LEVEL_big */ {
-        LevelParams params = {
-            true,
-            true,
-            64, 64,
-            100.0f,
-            0.05f,
-            { { 24, 22 }, { 1, 0 }, 16 }
-        };
-        
-        Level *level = &game_data->levels[LEVEL_big];
-        *level = make_level(params, &game_data->level_arena);
-    }
-    
-    /* NOTE: LEVEL_third */ {
-        LevelParams params = {
-            false,
-            true,
-            16, 16,
-            25.0f,
-            0.2f,
-            { { 6, 6 }, { 1, 0 }, 4 }
-        };
-        
-        Level *level = &game_data->levels[LEVEL_third];
-        *level = make_level(params, &game_data->level_arena);
-    }
-    
-    /* NOTE: LEVEL_with_walls */ {
-        LevelParams params = {
-            false,
-            true,
-            16, 16,
-            25.0f,
-            0.2f,
-            { { 6, 6 }, { 1, 0 }, 4 }
-        };
-        
-        Level *level = &game_data->levels[LEVEL_with_walls];
-        *level = make_level(params, &game_data->level_arena);
-        
-        i32 wall_count = 8;
-        for(i32 i = 0; i < wall_count; ++i) {
-            vec2i free_pos = get_free_tile_pos(level);
-            set_tile(level, free_pos.x, free_pos.y, TILE_wall);
-        }
+}
+
+// NOTE: the built-in levels are files in data/levels/, see p_level_file.h
+static LevelParams
+get_level_params(game_level level) {
+    LevelParams params = {};
+    const char *map_name = "";
+    switch(level) {
+        case LEVEL_standard:   { map_name = "standard";   } break;
+        case LEVEL_big:        { map_name = "big";        } break;
+        case LEVEL_third:      { map_name = "third";      } break;
+        case LEVEL_with_walls: { map_name = "with_walls"; } break;
+        default: ASSERT(false, "no params for the level...\n");
     }
+    copy_memory(map_name, params.map_name, strlen(map_name) + 1);
+    return params;
+}
+
+// NOTE: builds the level the first time it's asked for after init_game, custom levels are made by the caller
+static Level *
+load_level(game_level _level) {
+    Level *level = get_level(_level);
+    if(!level->initialized && _level != LEVEL_custom && _level != LEVEL_invalid) {
+        *level = make_level(get_level_params(_level), &game_data->level_arena);
+    }
+    return level;
 }
 
 static void
@@ -301,6 +764,7 @@ place_apple(Level *level) {
     if(free.x != -1 && free.y != -1) {
         set_tile(level, free.x, free.y, TILE_apple);
     }
+    level->apple_pos = free;
 }
 
 inline void
@@ -314,78 +778,263 @@ add_snake_part(Level *level) {
     ++level->add_snake_parts;
 }
 
+static void
+get_tile_sprite(tile_type type, i32 *x_id, i32 *y_id, vec4 *color) {
+    *color = WHITE(1.0f);
+    *x_id = 0;
+    *y_id = 0;
+    
+    switch(type) {
+        case TILE_wall: {
+            *color = WHITE(0.4f);
+            *x_id = 1;
+            *y_id = 0;
+        } break;
+        
+        case TILE_apple: {
+            *color = WHITE(1.0f);
+            *x_id = 0;
+            *y_id = 0;
+        } break;
+        
+        default: {
+            ASSERT(false, "no sprite for the tile type...\n");
+        };
+    }
+}
+
+// NOTE: puts the level's dirty tiles in game_data->tile_map, false when the level is too big for it
+static bool
+update_level_tile_map(Level *level) {
+    if(!game_data->tile_map_shader || level->width > TILE_MAP_MAX_SIZE || level->height > TILE_MAP_MAX_SIZE) {
+        return false;
+    }
+    
+    Texture2D *tile_map = &game_data->tile_map;
+    if(tile_map->width != (i32)level->width || tile_map->height != (i32)level->height) {
+        if(tile_map->id) {
+            delete_texture_2d(core->renderer, tile_map);
+        }
+        Texture2DParams params = {
+            FORMAT_r8,
+            FORMAT_red,
+            PIXEL_TYPE_unsigned_byte,
+            FILTER_nearest,
+            FILTER_nearest,
+            WRAP_clamp_to_edge,
+            WRAP_clamp_to_edge,
+        };
+        *tile_map = create_texture_2d(core->renderer, nullptr, level->width, level->height, 1, &params);
+        game_data->tile_map_level = nullptr;
+    }
+    if(game_data->tile_map_level != level) {
+        game_data->tile_map_level = level;
+        add_to_tile_rect(&level->tile_map_dirty, 0, 0, level->width, level->height);
+    }
+    if(is_empty(level->tile_map_dirty)) {
+        return true;
+    }
+    
+    // NOTE: a few rows at a time, the staging stays small on big boards
+    u32 x0 = (u32)level->tile_map_dirty.min.x;
+    u32 y0 = (u32)level->tile_map_dirty.min.y;
+    u32 x1 = min_value((u32)level->tile_map_dirty.max.x, level->width - 1);
+    u32 y1 = min_value((u32)level->tile_map_dirty.max.y, level->height - 1);
+    u32 width = x1 - x0 + 1;
+    u32 band_rows = max_value(1u, 65536u / width);
+    
+    TemporaryMemory memory = begin_temporary_memory(&game_data->temporary_memory);
+    u8 *types = push_array(&game_data->temporary_memory, u8, width * band_rows);
+    for(u32 y = y0; y <= y1; y += band_rows) {
+        u32 rows = min_value(band_rows, y1 + 1 - y);
+        for(u32 row = 0; row < rows; ++row) {
+            for(u32 x = x0; x <= x1; ++x) {
+                types[row * width + (x - x0)] = (u8)get_tile(level, x, y + row).type;
+            }
+        }
+        update_texture_2d(core->renderer, tile_map, x0, y, width, rows, types);
+    }
+    end_temporary_memory(memory);
+    
+    level->tile_map_dirty = empty_tile_rect();
+    return true;
+}
+
+static u32
+get_level_fb_tile_px(Level *level) {
+    Renderer *r = core->renderer;
+    f32 w = (f32)level->width;
+    f32 h = (f32)level->height;
+    vec2 corners[4] = { { 0.0f, 0.0f }, { w, 0.0f }, { 0.0f, h }, { w, h } };
+    
+    // NOTE: pixels per tile of the board's bounding box on the screen,
+    // a corner behind the camera takes the full resolution
+    f32 density = (f32)LEVEL_FB_MAX_TILE_PX;
+    vec2 min = make_vec2(F32_MAX);
+    vec2 max = make_vec2(-F32_MAX);
+    bool behind = false;
+    for(u32 i = 0; i < size_array(corners); ++i) {
+        vec4 p = r->scene_data.proj * (r->scene_data.view * make_vec4(corners[i].x, corners[i].y, 0.0f, 1.0f));
+        if(p.w <= 0.0001f) {
+            behind = true;
+            break;
+        }
+        min = { min_value(min.x, p.x / p.w), min_value(min.y, p.y / p.w) };
+        max = { max_value(max.x, p.x / p.w), max_value(max.y, p.y / p.w) };
+    }
+    if(!behind) {
+        density = max_value((max.x - min.x) * 0.5f * (f32)r->viewport.width / w,
+                            (max.y - min.y) * 0.5f * (f32)r->viewport.height / h);
+    }
+    
+    // NOTE: powers of two, the camera moving a bit doesn't resize level_fb every frame
+    u32 tile_px = 1;
+    while(tile_px < LEVEL_FB_MAX_TILE_PX && (f32)tile_px < density) {
+        tile_px <<= 1;
+    }
+    for(; tile_px; tile_px >>= 1) {
+        u64 fb_width  = (u64)level->width * tile_px;
+        u64 fb_height = (u64)level->height * tile_px;
+        if(fb_width <= LEVEL_FB_MAX_SIZE && fb_height <= LEVEL_FB_MAX_SIZE && 
+           fb_width * fb_height * LEVEL_FB_PIXEL_BYTES <= LEVEL_FB_MAX_BYTES) {
+            break;
+        }
+    }
+    return tile_px;
+}
+
 static void
 draw_level(Level *level) {
-    flush(core->renderer);
-    push(core->renderer);
-    {
-        Framebuffer *fb = &game_data->level_fb;
-        i32 mult = 128;
-        // NOTE: ...
-        if((fb->width / mult) != level->width || (fb->height / mult) != level->height) {
-            resize_framebuffer(core->renderer, fb, level->width * mult, level->height * mult);
-        }
-        bind_framebuffer(core->renderer, fb);
-        set_viewport(core->renderer, { 0, 0, (i32)(level->width * mult), (i32)(level->height * mult) });
-        clear(core->renderer, GRAY(0.103f, 1.0f));
+    u32 tile_px = get_level_fb_tile_px(level);
+    game_data->level_fb_tile_px = tile_px;
+    
+    Framebuffer *fb = &game_data->level_fb;
+    u32 fb_width  = level->width * tile_px;
+    u32 fb_height = level->height * tile_px;
+    if(tile_px && (fb->width != fb_width || fb->height != fb_height)) {
+        resize_framebuffer(core->renderer, fb, fb_width, fb_height);
+        game_data->level_fb_level = nullptr;
+    }
+    
+    // NOTE: level_fb keeps the last draw, only the tiles that changed are drawn again
+    TileRect redraw = { { 0, 0 }, { (i32)level->width - 1, (i32)level->height - 1 } };
+    if(tile_px && !game_data->debug_state && game_data->level_fb_level == level) {
+        redraw = level->fb_dirty;
+    }
+    level->fb_dirty = empty_tile_rect();
+    game_data->level_fb_level = (tile_px && !game_data->debug_state) ? level : nullptr;
+    
+    if(!is_empty(redraw)) {
+        flush(core->renderer);
+        push(core->renderer);
         bind_shader(core->renderer, &core->renderer->shader_basic->shader);
-        mat4x4 proj = mat4x4_orthographic(0.0f, 0.0f, (f32)level->width, (f32)level->height, -2.0f, 2.0f);
-        mat4x4 view = mat4x4_identity();
-        set_proj_and_view(core->renderer, proj, view);
+        if(tile_px) {
+            bind_framebuffer(core->renderer, fb);
+            set_viewport(core->renderer, { 0, 0, (i32)fb_width, (i32)fb_height });
+            set_clip_rect(core->renderer, { redraw.min.x * (i32)tile_px, redraw.min.y * (i32)tile_px,
+                              (redraw.max.x - redraw.min.x + 1) * (i32)tile_px, (redraw.max.y - redraw.min.y + 1) * (i32)tile_px });
+            clear(core->renderer, GRAY(0.103f, 1.0f));
+            mat4x4 proj = mat4x4_orthographic(0.0f, 0.0f, (f32)level->width, (f32)level->height, -2.0f, 2.0f);
+            mat4x4 view = mat4x4_identity();
+            set_proj_and_view(core->renderer, proj, view);
+        }
+        else {
+            // NOTE: no level_fb this big, the level goes straight into the scene. The z flip keeps
+            // level_fb's layering (its ortho puts -z in front), the background is flushed before the rest
+            SceneData *scene = &core->renderer->scene_data;
+            set_proj_and_view(core->renderer, scene->proj, mat4x4_scale(1.0f, 1.0f, -1.0f) * scene->view);
+            draw_quad(core->renderer, make_vec3(0.0f, 0.0f, 0.15f), make_vec2((f32)level->width, (f32)level->height), GRAY(0.103f, 1.0f));
+            flush(core->renderer);
+        }
         
-        for(u32 y = 0; y < level->height; ++y) {
-            for(u32 x = 0; x < level->width; ++x) {
-                Tile *tile = get_tile(level, x, y);
-                
-                vec2 pos  = { (f32)x, (f32)y };
-                vec2 size = { 1.0f, 1.0f };
-                
-                if(game_data->debug_state) {
-                    draw_quad_outline(core->renderer, make_vec3(pos, -0.05f), size, 0.03f, WHITE(0.1f));
-                }
-                
-                if(tile->type == TILE_none) {
-                    continue;
-                }
-                
-                if(game_data->debug_state) {
-                    draw_quad_outline(core->renderer, make_vec3((f32)x, (f32)y, -0.1f), size, 0.075f, CYAN(0.4f));
+        SpriteSheet *ss = &game_data->sprites;
+        if(game_data->use_tile_map && !game_data->debug_state && update_level_tile_map(level)) {
+            // NOTE: the whole board is one quad, tilemap.glsl finds the sprite of each tile
+            Renderer *r = core->renderer;
+            ShaderProgram *shader = &game_data->tile_map_shader->shader;
+            bind_shader(r, shader);
+            
+            bind_texture_2d(r, game_data->tile_map.id, TILE_MAP_TEXTURE_UNIT);
+            set_uniform_int(r, shader, "u_tile_map", TILE_MAP_TEXTURE_UNIT);
+            for(u32 type = 0; type < TILE_COUNT; ++type) {
+                vec4 rect = {};
+                vec4 color = {};
+                if(type != TILE_none && type != TILE_snake) {
+                    i32 x_id, y_id;
+                    get_tile_sprite((tile_type)type, &x_id, &y_id, &color);
+                    vec2_4x tex_coords = get_tex_coords(ss, x_id, y_id);
+                    rect = make_vec4(tex_coords.vecs[0].x, tex_coords.vecs[0].y, tex_coords.vecs[2].x, tex_coords.vecs[2].y);
                 }
                 
-                vec4 color = WHITE(1.0f);
-                SpriteSheet *ss = &game_data->sprites;
-                i32 x_id = 0;
-                i32 y_id = 0;
-                
-                switch(tile->type) {
-                    case TILE_wall: {
-                        color = WHITE(0.4f);
-                        x_id = 1;
-                        y_id = 0;
-                    } break;
+                char name[32];
+                snprintf(name, size_array(name), "u_tile_rects[%u]", type);
+                set_uniform_float4(r, shader, name, rect);
+                snprintf(name, size_array(name), "u_tile_colors[%u]", type);
+                set_uniform_float4(r, shader, name, color);
+            }
+            
+            draw_quad(r, make_vec2(0.0f), make_vec2((f32)level->width, (f32)level->height), WHITE(1.0f), &ss->tex);
+            flush(r);
+            bind_shader(r, &r->shader_basic->shader);
+        }
+        else {
+            for(u32 y = (u32)redraw.min.y; y <= (u32)redraw.max.y; ++y) {
+                for(u32 x = (u32)redraw.min.x; x <= (u32)redraw.max.x; ++x) {
+                    // NOTE: skip the rest of the chunk's row when it's empty
+                    if(!game_data->debug_state && !level->chunks[(y >> LEVEL_CHUNK_SHIFT) * level->chunks_x + (x >> LEVEL_CHUNK_SHIFT)]) {
+                        x |= LEVEL_CHUNK_SIZE - 1;
+                        continue;
+                    }
+                    
+                    Tile tile = get_tile(level, x, y);
                     
-                    case TILE_apple: {
-                        color = WHITE(1.0f);
-                        x_id = 0;
-                        y_id = 0;
-                    } break;
+                    vec2 pos  = { (f32)x, (f32)y };
+                    vec2 size = { 1.0f, 1.0f };
                     
-                    default: {
-                        color = WHITE(1.0f);
-                        ASSERT(false, "");
-                    };
+                    if(game_data->debug_state) {
+                        draw_quad_outline(core->renderer, make_vec3(pos, -0.05f), size, 0.03f, WHITE(0.1f));
+                    }
+                    
+                    if(tile.type == TILE_none || tile.type == TILE_snake) {
+                        continue;
+                    }
+                    
+                    if(game_data->debug_state) {
+                        draw_quad_outline(core->renderer, make_vec3((f32)x, (f32)y, -0.1f), size, 0.075f, CYAN(0.4f));
+                    }
+                    
+                    vec4 color;
+                    i32 x_id, y_id;
+                    get_tile_sprite(tile.type, &x_id, &y_id, &color);
+                    draw_quad(core->renderer, pos, size, { ss, x_id, y_id }, color);
                 }
-                
-                draw_quad(core->renderer, pos, size, { ss, x_id, y_id }, color);
             }
         }
-        draw_snake(level);
+        if(!tile_px) {
+            draw_snake(level);
+        }
         
         flush(core->renderer);
+        if(tile_px) {
+            disable_clip_rect(core->renderer);
+        }
+        pop(core->renderer);
     }
-    pop(core->renderer);
     
-    draw_quad(core->renderer, make_vec3(0.0f), make_vec2((f32)level->width, (f32)level->height), WHITE(1.0f), &game_data->level_fb.color);
+    if(tile_px) {
+        draw_quad(core->renderer, make_vec3(0.0f), make_vec2((f32)level->width, (f32)level->height), WHITE(1.0f), &game_data->level_fb.color);
+        
+        // NOTE: the snake moves every frame, it goes over level_fb with the same z flip as the direct path.
+        // Its z goes from -0.05 to 0.1, the shift puts all of it in front of the level_fb quad
+        flush(core->renderer);
+        push(core->renderer);
+        SceneData *scene = &core->renderer->scene_data;
+        mat4x4 view = mat4x4_scale(1.0f, 1.0f, -1.0f) * (mat4x4_translate(0.0f, 0.0f, 0.11f) * scene->view);
+        set_proj_and_view(core->renderer, scene->proj, view);
+        draw_snake(level);
+        flush(core->renderer);
+        pop(core->renderer);
+    }
     
     f32 line = 0.15f;
     f32 margin = 0.1f;
@@ -399,7 +1048,7 @@ draw_level(Level *level) {
 }
 
 static void
-draw_snake_body(Level *level, SnakePart *part, vec4 color, bool no_corner, bool no_regular) {
+draw_snake_body(Level *level, SnakePart *part, u32 part_index, vec4 color, bool no_corner) {
     SpriteSheet *ss = &game_data->sprites;
     vec2i snake_head   = { 3, 3 };
     vec2i snake_tail   = { 0, 3 };
@@ -459,26 +1108,22 @@ draw_snake_body(Level *level, SnakePart *part, vec4 color, bool no_corner, bool
             rotation = PI32 * 1.0f;
         }
         
-        if((part - 1) == level->head) {
+        if(part_index == 1) {
             sprite = snake_neck;
         }
         
-        if(part == (level->snake_parts + (level->snake_count - 1))) {
+        if(part_index == (level->snake_count - 1)) {
             sprite = snake_neck;
             rotation += PI32;
         }
         
-        if(no_regular) {
-            sprite = snake_neck;
-        }
-        
         draw_quad_rotated(core->renderer, tile_pos, size, rotation, { ss, sprite.x, sprite.y }, color);
     }
 }
 
 static void
 draw_snake(Level *level) {
-    if(!level->head) {
+    if(!level->snake_count) {
         return;
     }
     
@@ -490,8 +1135,24 @@ draw_snake(Level *level) {
     vec2i snake_corner = { 0, 1 };
     
     f32 perc = level->move_counter / level->move_time;
+    vec2i tile_pos_i = level->snake_head;
+    vec2i last_dir = {};
     for(u32 i = 0; i < level->snake_count; ++i) {
-        SnakePart *part = level->snake_parts + i;
+        // NOTE: walk from the head back to the tail
+        SnakePart _part = {};
+        SnakePart *part = &_part;
+        if(i > 0) {
+            tile_pos_i -= last_dir;
+            maybe_warp(level, &tile_pos_i);
+        }
+        part->tile_pos = tile_pos_i;
+        part->last_move_dir = dir_to_vec2i(get_snake_dir(level, i));
+        part->move_dir = (i > 0) ? last_dir : part->last_move_dir;
+        part->last_tile_pos = part->tile_pos - part->last_move_dir;
+        if(i == (level->snake_count - 1) && level->tail_stayed) {
+            part->last_tile_pos = part->tile_pos;
+        }
+        last_dir = part->last_move_dir;
         
         vec2 tile_pos = part->tile_pos.to_vec2();
         
@@ -507,7 +1168,7 @@ draw_snake(Level *level) {
             draw_quad_outline(core->renderer, make_vec3(part->tile_pos.to_vec2(), -0.1f), size, 0.075f, CYAN(0.4f));
         }
         
-        if(part == level->head) {
+        if(i == 0) {
             QuadExParams params = quad_ex_default();
             params.spritesheet = true;
             params.ss_tile = { ss, snake_head.x, snake_head.y };
@@ -578,18 +1239,10 @@ draw_snake(Level *level) {
                 draw_quad_rotated(core->renderer, _pos, size, rotation, { ss, snake_tail.x, snake_tail.y }, color);
             }
             
-            if(!part->just_spawned) {
-                draw_snake_body(level, part, color, true);
-            }
+            draw_snake_body(level, part, i, color, true);
         }
         else {
-            bool no_regular = false;
-            if((i + 1) == (level->snake_count - 1)) {
-                if((part + 1)->just_spawned) {
-                    no_regular = true;
-                }
-            }
-            draw_snake_body(level, part, color, false, no_regular);
+            draw_snake_body(level, part, i, color);
         }
     }
 }
@@ -600,9 +1253,9 @@ game_won(void) {
     PSystemParams bg_particles_params = game_data->bg_particles.params;
     delete_particles(&game_data->bg_particles, core->procs);
     bg_particles_params.no_textures();
-    bg_particles_params.add_texture(&game_data->font.glyphs['W'].tex);
-    bg_particles_params.add_texture(&game_data->font.glyphs['I'].tex);
-    bg_particles_params.add_texture(&game_data->font.glyphs['N'].tex);
+    bg_particles_params.add_texture(game_data->font.glyphs['W'].region);
+    bg_particles_params.add_texture(game_data->font.glyphs['I'].region);
+    bg_particles_params.add_texture(game_data->font.glyphs['N'].region);
     bg_particles_params.move_speed.set(2.0f);
     bg_particles_params.direction.set(-180.0f, 0.0f);
     bg_particles_params.size.set({ 0.2f, 0.2f }, { 0.8f, 0.8f });
@@ -646,6 +1299,7 @@ goto_menu(bool from_game, bool restart_game) {
 static void 
 switch_to_level(game_level level, f32 transition_speed) {
     ASSERT((level >= 0 && level < LEVEL_COUNT) || level == LEVEL_custom, "wrong level");
+    load_level(level);
     transition(transition_speed);
     game_data->current_level = level;
     game_data->start_counter = START_COUNTER_TIME;
@@ -655,36 +1309,99 @@ static void
 start_game(game_level level) {
     game_data->state = STATE_game;
     switch_to_level(level);
+    
+    // NOTE: record from the first move, resumed games keep their recording
+    Level *_level = get_level(level);
+    if(_level != game_data->playback_level && _level->tick_count == 0) {
+        begin_replay(game_data->replay, _level);
+        game_data->recording_level = _level;
+    }
 }
 
+// NOTE: false when the level can't be made the way it was recorded
 static bool
-maybe_warp(Level *level, SnakePart *part) {
-    vec2i tile_pos = part->tile_pos;
+start_replay(Replay *replay) {
+    init_game();
+    game_data->win = false;
     
+    LevelParams params = replay->header.params;
+    params.seed = replay->header.seed;
+    game_data->level_custom = make_level(params, &game_data->level_arena);
+    if(!game_data->level_custom.initialized) {
+        return false;
+    }
+    if(game_data->level_custom.map_hash != replay->header.map_hash) {
+        game_log("level file '%s' changed since the replay was recorded...\n", params.map_name);
+        init_game();
+        return false;
+    }
+    
+    rewind_replay(replay);
+    game_data->playback_level = &game_data->level_custom;
+    start_game(LEVEL_custom);
+    return true;
+}
+
+inline u32
+get_ring_snake_dir(Level *level, u32 ring_index) {
+    u32 result = (level->snake_dirs[ring_index >> 2] >> ((ring_index & 3) * 2)) & 3;
+    return result;
+}
+
+inline void
+set_ring_snake_dir(Level *level, u32 ring_index, u32 dir) {
+    assert(dir < DIR_COUNT);
+    u32 shift = (ring_index & 3) * 2;
+    u8 *byte = &level->snake_dirs[ring_index >> 2];
+    *byte = (u8)((*byte & ~(3 << shift)) | (dir << shift));
+}
+
+// NOTE: part_index 0 is the head
+inline u32
+get_snake_dir(Level *level, u32 part_index) {
+    assert(part_index < level->snake_count);
+    u32 index = (level->snake_first + level->snake_count - 1 - part_index) % level->snake_max;
+    return get_ring_snake_dir(level, index);
+}
+
+static bool
+maybe_warp(Level *level, vec2i *tile_pos) {
     bool warped = true;
-    if(part->tile_pos.x < 0) {
-        part->tile_pos.x = level->width - 1;
+    if(tile_pos->x < 0) {
+        tile_pos->x = level->width - 1;
     }
-    else if(part->tile_pos.x > (i32)(level->width - 1)) {
-        part->tile_pos.x = 0;
+    else if(tile_pos->x > (i32)(level->width - 1)) {
+        tile_pos->x = 0;
     }
-    else if(part->tile_pos.y < 0) {
-        part->tile_pos.y = level->height - 1;
+    else if(tile_pos->y < 0) {
+        tile_pos->y = level->height - 1;
     }
-    else if(part->tile_pos.y > (i32)(level->height - 1)) {
-        part->tile_pos.y = 0;
+    else if(tile_pos->y > (i32)(level->height - 1)) {
+        tile_pos->y = 0;
     }
     else {
         warped = false;
     }
-    
-    if(warped) {
-        vec2i diff = tile_pos - part->last_tile_pos;
-        part->last_tile_pos = part->tile_pos - diff;
-    }
     return warped;
 }
 
+// NOTE: neighbour of a tile in 'dir', false if it's outside of a not looping level
+inline bool
+step_tile_pos(Level *level, vec2i tile_pos, u32 dir, vec2i *result) {
+    tile_pos += dir_to_vec2i(dir);
+    if(!level->looping) {
+        if(!is_in_bounds(tile_pos.x, 0, (i32)(level->width - 1)) ||
+           !is_in_bounds(tile_pos.y, 0, (i32)(level->height - 1))) {
+            return false;
+        }
+    }
+    else {
+        maybe_warp(level, &tile_pos);
+    }
+    *result = tile_pos;
+    return true;
+}
+
 static void
 update_free_camera(void) {
     PerspCamera *camera = &game_data->free_camera.persp;
@@ -753,11 +1470,10 @@ update_camera(Level *level) {
 
 static void
 update_snake(Level *level, vec2i move_dir) {
-    if(!level->head) {
+    if(!level->snake_count) {
         return;
     }
     
-    SnakePart *head = level->head;
     vec2i new_move_dir = move_dir;
     
     if(new_move_dir.x != 0 || new_move_dir.y != 0) {
@@ -776,106 +1492,129 @@ update_snake(Level *level, vec2i move_dir) {
         }
     }
     
-    if((level->move_counter += game_data->update_dt) >= level->move_time) {
-        level->move_counter -= level->move_time;
-        SnakePart *last_part = nullptr;
-        for(u32 i = 0; i < level->snake_count; ++i) {
-            SnakePart *part = level->snake_parts + i;
-            
-            if(part == head) {
-                // NOTE: get next move dir
-                if(level->snake_next_dir_count > 1) {
-                    for(u32 move = 0; move < (level->snake_next_dir_count - 1); ++move) {
-                        level->snake_next_dir[move] = level->snake_next_dir[move + 1];
-                    }
-                    --level->snake_next_dir_count;
-                }
-                
-                part->move_dir = level->snake_next_dir[0];
-                part->last_tile_pos = part->tile_pos;
-                part->tile_pos += part->move_dir;
-                part->last_move_dir = part->move_dir;
-                
-                level->head_warped = false;
-                if(!level->looping) {
-                    if(!is_in_bounds(part->tile_pos.x, 0, (i32)(level->width - 1)) ||
-                       !is_in_bounds(part->tile_pos.y, 0, (i32)(level->height - 1))) {
-                        game_over();
-                        return;
-                    }
-                }
-                else {
-                    if(maybe_warp(level, part)) {
-                        level->head_warped = true;
-                    }
-                }
-            }
-            else {
-                if(part->just_spawned) {
-                    part->just_spawned = false;
-                }
-                
-                part->last_tile_pos = part->tile_pos;
-                part->tile_pos += part->move_dir;
-                part->last_move_dir = part->move_dir;
-                part->move_dir = last_part->last_move_dir;
-                
-                bool warped = maybe_warp(level, part);
-                if(i == (level->snake_count - 1)) {
-                    level->tail_warped = warped;
-                }
-            }
-            last_part = part;
+    // NOTE: fixed timestep, run every move that is due but not more than MAX_MOVES_PER_UPDATE
+    level->move_counter += game_data->update_dt;
+    for(u32 move = 0; level->move_counter >= level->move_time; ++move) {
+        if(move == MAX_MOVES_PER_UPDATE) {
+            level->move_counter = fmodf(level->move_counter, level->move_time);
+            break;
         }
+        level->move_counter -= level->move_time;
         
-        // NOTE: check for suicide
-        for(u32 i = 1; i < level->snake_count; ++i) {
-            SnakePart *part = level->snake_parts + i;
-            if(head->tile_pos == part->tile_pos) {
+        vec2i head_dir;
+        if(level == game_data->playback_level) {
+            if(!read_replay_tick(game_data->playback, &head_dir)) {
+                game_data->playback_level = nullptr;
                 game_over();
                 return;
             }
+            level->snake_next_dir[0] = head_dir;
+            level->snake_next_dir_count = 1;
+        }
+        else if(game_data->use_autopilot && level != &game_data->menu.level) {
+            head_dir = autopilot_next_dir(game_data->autopilot, level, &game_data->temporary_memory);
+            level->snake_next_dir[0] = head_dir;
+            level->snake_next_dir_count = 1;
+        }
+        else {
+            head_dir = next_snake_dir(level);
         }
         
-        // NOTE: check for collisions with tiles
-        Tile *tile = get_tile(level, head->tile_pos.x, head->tile_pos.y);
-        switch(tile->type) {
-            case TILE_wall: {
-                game_over();
-                return;
-            } break;
-            
-            case TILE_apple: {
-                tile->type = TILE_none;
-                add_snake_part(level);
-                
-                core->procs->play_sound(game_data->sound);
-                
-                if((level->snake_count + level->add_snake_parts) >= (level->width * level->height + 1)) {
-                    game_won();
-                }
-                
-                place_apple(level);
-                ++level->score;
-            } break;
-            
-            default: {
-                // NOTE: do nothing
-            };
+        snake_event event = tick_snake(level, head_dir);
+        if(level == game_data->recording_level) {
+            record_replay_tick(game_data->replay, level, head_dir);
         }
         
-        if(level->add_snake_parts > 0) {
-            --level->add_snake_parts;
-            SnakePart *last_p = &level->snake_parts[level->snake_count - 1];
-            SnakePart *new_p  = &level->snake_parts[level->snake_count++];
-            new_p->tile_pos = last_p->tile_pos;
-            new_p->last_tile_pos = last_p->last_tile_pos;
-            new_p->just_spawned = true;
-            // new_p->move_dir = last_p->last_move_dir;
+        if(event == SNAKE_ate || event == SNAKE_won) {
+            core->procs->play_sound(game_data->sound);
+        }
+        
+        if(event == SNAKE_died) {
+            game_over();
+            return;
+        }
+        else if(event == SNAKE_won) {
+            game_won();
+            return;
         }
     }
 }
 
+static vec2i
+next_snake_dir(Level *level) {
+    if(level->snake_next_dir_count > 1) {
+        for(u32 move = 0; move < (level->snake_next_dir_count - 1); ++move) {
+            level->snake_next_dir[move] = level->snake_next_dir[move + 1];
+        }
+        --level->snake_next_dir_count;
+    }
+    return level->snake_next_dir[0];
+}
+
+// NOTE: a single move, no timing and no game state changes, 
+// level->random is the only source of randomness so replays stay deterministic
+static snake_event
+tick_snake(Level *level, vec2i head_dir) {
+    ++level->tick_count;
+    vec2i head_pos = level->snake_head + head_dir;
+    
+    level->head_warped = false;
+    if(!level->looping) {
+        if(!is_in_bounds(head_pos.x, 0, (i32)(level->width - 1)) ||
+           !is_in_bounds(head_pos.y, 0, (i32)(level->height - 1))) {
+            return SNAKE_died;
+        }
+    }
+    else {
+        if(maybe_warp(level, &head_pos)) {
+            level->head_warped = true;
+        }
+    }
+    
+    // NOTE: the tail stays in place for a move when the snake grows, the ring is full at snake_max
+    if(level->snake_count == level->snake_max) {
+        level->add_snake_parts = 0;
+    }
+    if(level->add_snake_parts > 0) {
+        --level->add_snake_parts;
+        ++level->snake_count;
+        level->tail_stayed = true;
+        level->tail_warped = false;
+    }
+    else {
+        set_tile(level, level->snake_tail.x, level->snake_tail.y, TILE_none);
+        level->snake_tail += dir_to_vec2i(get_snake_dir(level, level->snake_count - 2));
+        level->tail_warped = maybe_warp(level, &level->snake_tail);
+        level->tail_stayed = false;
+        level->snake_first = (level->snake_first + 1) % level->snake_max;
+    }
+    assert(level->snake_count <= level->snake_max);
+    
+    level->snake_head = head_pos;
+    set_ring_snake_dir(level, (level->snake_first + level->snake_count - 1) % level->snake_max, vec2i_to_dir(head_dir));
+    
+    // NOTE: check for collisions with tiles, the tail already left its tile
+    tile_type hit = get_tile(level, level->snake_head.x, level->snake_head.y).type;
+    if(hit == TILE_wall || hit == TILE_snake) {
+        return SNAKE_died;
+    }
+    set_tile(level, level->snake_head.x, level->snake_head.y, TILE_snake);
+    
+    snake_event event = SNAKE_none;
+    if(hit == TILE_apple) {
+        add_snake_part(level);
+        place_apple(level);
+        ++level->score;
+        
+        // NOTE: no free tile left for the apple, walls don't have to be filled
+        event = SNAKE_ate;
+        if(level->apple_pos.x == -1 && level->apple_pos.y == -1) {
+            event = SNAKE_won;
+        }
+    }
+    return event;
+}
+
 static void 
 update_level(Level *level, vec2i move_dir) {
     update_camera(level);
@@ -964,7 +1703,7 @@ update_and_render_menu(void) {
                     // NOTE: stupid
                     delete_particles(&game_data->bg_particles, core->procs);
                     PSystemParams bg_particles_params = {};
-                    bg_particles_params.add_texture(&game_data->sprite_particle);
+                    bg_particles_params.add_texture(game_data->sprite_particle);
                     bg_particles_params.spawn_area = AREA_quad;
                     bg_particles_params.sides = { 160.0f, 160.0f };
                     bg_particles_params.rotated_particles = false;
@@ -1120,6 +1859,55 @@ update_and_render_menu(void) {
                     menu->custom_level_params.looping = false;
                 }
             }
+            
+            {
+                ButtonLayout layout_row = setup_button_layout(LAYOUT_horizontal, next_button_position(&layout), space, button_size); 
+                
+                u32 *pattern = &menu->custom_level_params.wall_pattern;
+                if(*pattern >= WALLS_COUNT) {
+                    *pattern = WALLS_none;
+                }
+                if(do_button(&game_data->ui, input, wall_pattern_names[*pattern], next_button_position(&layout_row),
+                             button_size, &theme, { 7721301 })) {
+                    if(++*pattern >= WALLS_COUNT) {
+                        *pattern = WALLS_none;
+                    }
+                }
+                
+                char *strings[] = {
+                    "10%",
+                    "20%",
+                    "30%",
+                    "40%",
+                };
+                
+                f32 densities[] = {
+                    0.1f,
+                    0.2f,
+                    0.3f,
+                    0.4f,
+                };
+                
+                i32 which = -1;
+                for(i32 i = 0; i < size_array(densities); ++i) {
+                    if(densities[i] == menu->custom_level_params.wall_density) {
+                        which = i;
+                    }
+                }
+                
+                if(which == -1) {
+                    which = 0;
+                    menu->custom_level_params.wall_density = densities[which];
+                }
+                
+                if(do_button(&game_data->ui, input, strings[which], next_button_position(&layout_row),
+                             button_size, &theme, { 7721302 })) {
+                    if(++which >= size_array(densities)) {
+                        which = 0;
+                    }
+                    menu->custom_level_params.wall_density = densities[which];
+                }
+            }
         }
         else {
             ButtonLayout layout = setup_button_layout(LAYOUT_vertical, { 10.0f, 10.0f }, space, button_size);
@@ -1277,7 +2065,7 @@ update_and_render_menu(void) {
         // TODO:
         delete_particles(&game_data->bg_particles, core->procs);
         PSystemParams bg_particles_params = {};
-        bg_particles_params.add_texture(&game_data->sprite_particle);
+        bg_particles_params.add_texture(game_data->sprite_particle);
         bg_particles_params.spawn_area = AREA_quad;
         bg_particles_params.sides = { 160.0f, 160.0f };
         bg_particles_params.rotated_particles = false;
@@ -1409,7 +2197,7 @@ update_and_render_game(void) {
             theme.color = WHITE(1.0f);
             theme.bg_color = BLACK(1.0f);
             theme.font = font;
-            char *text = game_data->win ? "WIN !!!\0" : "GAME OVER\0";
+            const char *text = game_data->win ? "WIN !!!\0" : "GAME OVER\0";
             vec2 text_dim = get_text_size(text, font, theme.font_height);
             vec2 size = { text_dim.x * 1.05f , text_dim.y * 1.2f };
             do_label(&game_data->ui, text, make_vec2(screen_dim.x * 0.5f, screen_dim.y * 0.8f)
@@ -1429,7 +2217,7 @@ update_and_render_game(void) {
     Font *font = &game_data->font;
     f32 title_height = 48.0f;
     char title[128];
-    sprintf_s(title, size_array(title), "SCORE: %lu", level->score);
+    snprintf(title, size_array(title), "SCORE: %u", level->score);
     vec2 title_dim = get_text_size(title, font, title_height);
     vec2 title_pos = { screen_dim.x - title_dim.x - 16.0f, screen_dim.y - title_dim.y + 2.0f };
     f32  title_color_t = (cosf(input->time_elapsed * 2.0f) + 1.0f) * 0.5f;
@@ -1571,6 +2359,14 @@ GAME_INIT_PROC(game_init) {
     game_data->level_arena = make_arena(push_memory(&game_data->permanent_memory, MB(8)), MB(8));
     game_data->menu.arena  = make_arena(push_memory(&game_data->permanent_memory, MB(8)), MB(8));
     
+    game_data->replay   = push_struct(&game_data->permanent_memory, Replay);
+    game_data->playback = push_struct(&game_data->permanent_memory, Replay);
+    make_replay(game_data->replay,   &game_data->permanent_memory, REPLAY_MAX_BYTES);
+    make_replay(game_data->playback, &game_data->permanent_memory, REPLAY_MAX_BYTES);
+    
+    game_data->autopilot = push_struct(&game_data->permanent_memory, Autopilot);
+    init_autopilot(game_data->autopilot, &game_data->permanent_memory, core->procs, core->work_queue);
+    
     init_game();
     init_menu();
     init_ui(&game_data->ui, core->renderer);
@@ -1583,27 +2379,15 @@ GAME_INIT_PROC(game_init) {
         camera->aspect = (f32)game_data->framebuffer.width / (f32)game_data->framebuffer.height;
     }
     
-    delete_particles(&game_data->bg_particles, core->procs);
-    PSystemParams bg_particles_params = {};
-    bg_particles_params.add_texture(&game_data->sprite_particle);
-    bg_particles_params.spawn_area = AREA_quad;
-    bg_particles_params.sides = { 160.0f, 160.0f };
-    bg_particles_params.rotated_particles = false;
-    bg_particles_params.rotation.set(0.0f);
-    bg_particles_params.size.set({ 0.2f, 0.2f }, { 0.4f, 0.4f });
-    bg_particles_params.desired_size.set({ 0.05f, 0.05f }, { 0.0f, 0.0f});
-    bg_particles_params.direction.set(0.0f, 360.0f);
-    bg_particles_params.color.set(WHITE(1.0f), GRAY(0.9f, 1.0f));
-    bg_particles_params.desired_color.set(WHITE(0.2f), WHITE(0.4f));
-    bg_particles_params.life_time.set(2.0f, 4.0f);
-    bg_particles_params.fade_in.set(0.2f, 0.4f);
-    init_particles(&game_data->bg_particles, 8096, 256, bg_particles_params, core->procs);
-    
     VarsFile *tweak_file = &game_data->tweak_file;
     *tweak_file = {};
     init_vars_file(DATA_DIR("p_game.tweak"), tweak_file);
     attach_var(&game_data->game_speed, VAR_f32, "game_speed", tweak_file);
     attach_var(&game_data->debug_state, VAR_bool, "debug", tweak_file);
+    attach_var(&game_data->use_tile_map, VAR_bool, "tile_map", tweak_file);
+    attach_var(&game_data->use_autopilot, VAR_bool, "autopilot", tweak_file);
+    attach_var(&game_data->autopilot->use_cycle, VAR_bool, "autopilot_cycle", tweak_file);
+    attach_var(&game_data->autopilot->use_mcts, VAR_bool, "autopilot_mcts", tweak_file);
     load_attached_vars(tweak_file, core->procs);
     
     Texture2DParams params = {
@@ -1616,10 +2400,32 @@ GAME_INIT_PROC(game_init) {
         WRAP_repeat,
     };
     
-    game_data->sprites = create_sprite_sheet(core->renderer, DATA_DIR("spritesheet.png"), 64, 64, &params);
-    game_data->sprite_particle = create_texture_2d(core->renderer, DATA_DIR("particle.png"), &params);
+    // NOTE: the sprites and the glyphs share the atlas pages, text and sprites batch together
+    Texture2DParams atlas_params = params;
+    atlas_params.wrap_s = WRAP_clamp_to_edge;
+    atlas_params.wrap_t = WRAP_clamp_to_edge;
+    game_data->atlas = create_texture_atlas(&atlas_params);
+    game_data->sprites = create_sprite_sheet(core->renderer, DATA_DIR("spritesheet.png"), 64, 64, &params, &game_data->atlas);
+    game_data->sprite_particle = create_texture_region(core->renderer, DATA_DIR("particle.png"), &params, &game_data->atlas);
+    
+    delete_particles(&game_data->bg_particles, core->procs);
+    PSystemParams bg_particles_params = {};
+    bg_particles_params.add_texture(game_data->sprite_particle);
+    bg_particles_params.spawn_area = AREA_quad;
+    bg_particles_params.sides = { 160.0f, 160.0f };
+    bg_particles_params.rotated_particles = false;
+    bg_particles_params.rotation.set(0.0f);
+    bg_particles_params.size.set({ 0.2f, 0.2f }, { 0.4f, 0.4f });
+    bg_particles_params.desired_size.set({ 0.05f, 0.05f }, { 0.0f, 0.0f});
+    bg_particles_params.direction.set(0.0f, 360.0f);
+    bg_particles_params.color.set(WHITE(1.0f), GRAY(0.9f, 1.0f));
+    bg_particles_params.desired_color.set(WHITE(0.2f), WHITE(0.4f));
+    bg_particles_params.life_time.set(2.0f, 4.0f);
+    bg_particles_params.fade_in.set(0.2f, 0.4f);
+    init_particles(&game_data->bg_particles, 8096, 256, bg_particles_params, core->procs);
     
     game_data->framebuffer_shader = create_shader(core->renderer, DATA_DIR("framebuffer.glsl"));
+    game_data->tile_map_shader = create_shader(core->renderer, DATA_DIR("tilemap.glsl"));
     game_data->level_fb = create_framebuffer(core->renderer, 1, 1);
     
     game_data->transition_t_desired = 0.0f;
@@ -1636,7 +2442,7 @@ GAME_INIT_PROC(game_init) {
     load_attached_vars(&ini_file, core->procs);
     
     char font_path[256] = {};
-    sprintf_s(font_path, size_array(font_path), DATA_DIR("%s"), font);
+    snprintf(font_path, size_array(font_path), DATA_DIR("%s"), font);
     
     Texture2DParams font_params = {
         FORMAT_rgba8,
@@ -1647,7 +2453,7 @@ GAME_INIT_PROC(game_init) {
         WRAP_repeat,
         WRAP_repeat,
     };
-    game_data->font = create_font(core->renderer, font_path, 128.0f, &font_params);
+    game_data->font = create_font(core->renderer, font_path, 128.0f, &font_params, &game_data->atlas);
     
     {
         LoadedSound sound = load_sound_wav(DATA_DIR("sound.wav"), core->procs);
@@ -1711,7 +2517,7 @@ GAME_FRAME_PROC(game_frame) {
                     label_theme.font = font;
                     
                     char label[1024];
-                    sprintf_s(label, size_array(label), "GAME OVER\nSCORE: %d",
+                    snprintf(label, size_array(label), "GAME OVER\nSCORE: %d",
                               game_data->game_over_score);
                     vec2 label_size = get_text_size(label, font, label_theme.font_height, true);
                     f32 label_height = label_size.y * 1.1f; // 128.0f;
@@ -1739,7 +2545,7 @@ GAME_FRAME_PROC(game_frame) {
                     label_theme.font = font;
                     
                     char label[1024];
-                    sprintf_s(label, size_array(label), "WIN!!!");
+                    snprintf(label, size_array(label), "WIN!!!");
                     vec2 label_size = get_text_size(label, font, label_theme.font_height, true);
                     f32 label_height = label_size.y * 1.1f; // 128.0f;
                     f32 label_width  = label_size.x * 1.05f;
@@ -1792,14 +2598,17 @@ GAME_FRAME_PROC(game_frame) {
             
             f32 margin = 8.0f;
             char label[1024];
-            sprintf_s(label, size_array(label), "level_arena: %d|%d\nmenu_arena: %d|%d\ngame_speed %.4f\nwindow_focused: %s\nstate: %s\nlast_frame_draw_calls: %d\nlast_frame_quads_drawn: %d\nlast_frame_time: %.5f\nframerate: %d", 
+            snprintf(label, size_array(label), "level_arena: %d|%d\nmenu_arena: %d|%d\ngame_speed %.4f\nwindow_focused: %s\nstate: %s\nlast_frame_draw_calls: %d (%d saved)\nlast_frame_quads_drawn: %d (%u bytes)\nlevel_fb: %ux%u (%u px per tile)\nlast_frame_time: %.5f\nframerate: %d", 
                       game_data->level_arena.used, game_data->level_arena.size,
                       game_data->menu.arena.used, game_data->menu.arena.size,
                       game_data->game_speed,
                       core->window->is_focused ? "true" : "false",
                       game_data->state == STATE_game ? "STATE_game" : "STATE_menu",
                       game_data->last_frame_draw_calls,
+                      game_data->last_frame_batches_saved,
                       game_data->last_frame_quads_drawn,
+                      game_data->last_frame_upload_bytes,
+                      game_data->level_fb.width, game_data->level_fb.height, game_data->level_fb_tile_px,
                       input->delta_time, framerate);
             vec2 label_size = get_text_size(label, font, label_theme.font_height, true);
             f32 label_height = label_size.y * 1.05f; // 128.0f;
@@ -1824,7 +2633,7 @@ GAME_FRAME_PROC(game_frame) {
             
             ButtonLayout layout = setup_button_layout(LAYOUT_vertical, { game_data->ui.width - button_size.x - 10.0f, 10.0f }, 0.0f, button_size, true);
             if(debug_buttons) {
-                offset_for_button_layout(&layout, 6);
+                offset_for_button_layout(&layout, 14);
                 
                 if(do_button(&game_data->ui, input, game_data->paused ? "unpause" : "pause", 
                              next_button_position(&layout), button_size, &theme, { 144113 })) {
@@ -1856,7 +2665,7 @@ GAME_FRAME_PROC(game_frame) {
                     random_seed seed = 144;
                     delete_particles(&game_data->bg_particles, core->procs);
                     PSystemParams bg_particles_params = {};
-                    bg_particles_params.add_texture(&game_data->sprite_particle);
+                    bg_particles_params.add_texture(game_data->sprite_particle);
                     bg_particles_params.spawn_area = AREA_quad;
                     bg_particles_params.sides = { 60.0f, 20.0f };
                     bg_particles_params.rotated_particles = false;
@@ -1871,6 +2680,100 @@ GAME_FRAME_PROC(game_frame) {
                     init_particles(&game_data->bg_particles, 20000, 30000, bg_particles_params, core->procs);
                 }
                 
+                if(do_button(&game_data->ui, input, "sim bench", next_button_position(&layout), 
+                             button_size, &theme, { 1337 })) {
+                    SimParams params = {};
+                    params.width = 64;
+                    params.height = 64;
+                    params.looping = true;
+                    params.head_pos = { 24, 22 };
+                    params.move_dir = DIR_right;
+                    params.length = 16;
+                    params.wall_count = 32;
+                    
+                    SimBenchResult result = run_sim_benchmark(params, 4096, 1000, core->procs, core->work_queue);
+                    game_log("sim bench: %u levels, %u ticks, %llu moves, %llu games, %.3fs, %.2fM moves/s\n", 
+                             result.level_count, result.ticks, (unsigned long long)result.moves, (unsigned long long)result.games, 
+                             result.seconds, result.moves_per_second / 1000000.0);
+                }
+                
+                if(do_button(&game_data->ui, input, "replay", next_button_position(&layout), 
+                             button_size, &theme, { 1338 })) {
+                    if(game_data->replay->header.tick_count) {
+                        copy_replay(game_data->playback, game_data->replay);
+                        start_replay(game_data->playback);
+                    }
+                }
+                
+                if(do_button(&game_data->ui, input, "save replay", next_button_position(&layout), 
+                             button_size, &theme, { 1339 })) {
+                    if(!save_replay(game_data->replay, DATA_DIR("last.replay"), core->procs)) {
+                        game_log("couldn't save the replay...\n");
+                    }
+                }
+                
+                if(do_button(&game_data->ui, input, "load replay", next_button_position(&layout), 
+                             button_size, &theme, { 1340 })) {
+                    if(!load_replay(game_data->playback, DATA_DIR("last.replay"), core->procs) || 
+                       !start_replay(game_data->playback)) {
+                        game_log("couldn't load the replay...\n");
+                    }
+                }
+                
+                if(do_button(&game_data->ui, input, "replay bench", next_button_position(&layout), 
+                             button_size, &theme, { 1341 })) {
+                    Replay *replay = game_data->playback->header.tick_count ? game_data->playback : game_data->replay;
+                    
+                    u32 runs = 1000;
+                    u32 mismatches = 0;
+                    u64 ticks = 0;
+                    f64 start = core->procs->get_wall_clock();
+                    for(u32 i = 0; i < runs; ++i) {
+                        ReplayResult result = play_replay_headless(replay, &game_data->temporary_memory);
+                        ticks += result.ticks;
+                        if(!result.matches) {
+                            ++mismatches;
+                        }
+                    }
+                    f64 seconds = core->procs->get_wall_clock() - start;
+                    game_log("replay bench: %u runs, %llu ticks, %.3fs, %.2fM ticks/s, %u mismatches\n", 
+                             runs, (unsigned long long)ticks, seconds, seconds > 0.0 ? (f64)ticks / seconds / 1000000.0 : 0.0, mismatches);
+                }
+                
+                if(do_button(&game_data->ui, input, game_data->use_autopilot ? "manual" : "autopilot", 
+                             next_button_position(&layout), button_size, &theme, { 1342 })) {
+                    game_data->use_autopilot = !game_data->use_autopilot;
+                }
+                
+                if(do_button(&game_data->ui, input, "cycle bench", next_button_position(&layout), 
+                             button_size, &theme, { 1343 })) {
+                    LevelParams params = get_level_params(LEVEL_big);
+                    CycleBenchResult result = run_cycle_benchmark(params, &game_data->temporary_memory, core->procs);
+                    if(result.built) {
+                        game_log("cycle bench: %s, %llu moves, %u apples, %.1f moves per apple, %.3fs\n", 
+                                 result.won ? "won" : "lost", (unsigned long long)result.moves, result.score, 
+                                 result.score ? (f64)result.moves / (f64)result.score : 0.0, result.seconds);
+                    }
+                    else {
+                        game_log("cycle bench: no hamiltonian cycle for the level...\n");
+                    }
+                }
+                
+                if(do_button(&game_data->ui, input, "mcts bench", next_button_position(&layout), 
+                             button_size, &theme, { 1344 })) {
+                    Level *level = get_level(game_data->current_level);
+                    if(!level->initialized || !level->snake_count) {
+                        level = load_level(LEVEL_big);
+                    }
+                    
+                    TemporaryMemory memory = begin_temporary_memory(&game_data->temporary_memory);
+                    MctsAgent agent = make_mcts_agent(level->width, level->height, MCTS_AUTOPILOT_NODES, &game_data->temporary_memory);
+                    MctsResult result = run_mcts(&agent, level, 20000, rand_u64(&game_data->random), core->procs, core->work_queue);
+                    end_temporary_memory(memory);
+                    game_log("mcts bench: %u playouts, %u nodes, dir %u, value %.3f, %.3fs, %.0f playouts/s\n", 
+                             result.playouts, result.nodes, result.dir, result.value, result.seconds, result.playouts_per_second);
+                }
+                
                 offset_for_button_layout(&layout, 1);
                 if(do_button(&game_data->ui, input, "debug", next_button_position(&layout),
                              button_size, &theme, { 111333 })) {
@@ -1940,6 +2843,8 @@ GAME_FRAME_PROC(game_frame) {
     flush(core->renderer);
     
     game_data->last_frame_draw_calls = core->renderer->stats.draw_calls;
+    game_data->last_frame_batches_saved = (i32)core->renderer->stats.immediate_draw_calls - (i32)core->renderer->stats.draw_calls;
+    game_data->last_frame_upload_bytes = core->renderer->stats.upload_bytes;
     game_data->last_frame_quads_drawn = core->renderer->stats.quad_count;
     
     return !(game_data->quit_game);
@@ -1,22 +1,22 @@
 #ifndef P_GAME_MAIN_H
 #define P_GAME_MAIN_H
 
-#define game_log(str, ...) printf("GAME: "##str, __VA_ARGS__)
+#define game_log(str, ...) printf("GAME: " str, ##__VA_ARGS__)
 
+// NOTE: not stored, rebuilt from the level's snake_dirs for drawing
 struct SnakePart {
     vec2i tile_pos;
     vec2i last_tile_pos;
     
     vec2i move_dir;
     vec2i last_move_dir;
-    
-    bool just_spawned;
 };
 
 enum tile_type {
     TILE_none,
     TILE_wall,
     TILE_apple,
+    TILE_snake,
     
     TILE_COUNT
 };
@@ -25,24 +25,125 @@ struct Tile {
     tile_type type;
 };
 
+// NOTE: tiles live in square chunks, a chunk is only allocated while something is in it,
+// empty parts of the board cost one pointer per chunk. Get and set tiles through get_tile/set_tile.
+#define LEVEL_CHUNK_SHIFT 6
+#define LEVEL_CHUNK_SIZE  (1 << LEVEL_CHUNK_SHIFT)
+#define LEVEL_CHUNK_TILES (LEVEL_CHUNK_SIZE * LEVEL_CHUNK_SIZE)
+
+// NOTE: chunks keep 2 bits per tile, 32 tiles per word, two words per row
+#define LEVEL_TILE_BITS   2
+#define LEVEL_TILE_MASK   ((1ull << LEVEL_TILE_BITS) - 1)
+#define LEVEL_CHUNK_WORDS (LEVEL_CHUNK_TILES / 32)
+
+// NOTE: the snake ring doesn't have to cover the board, the snake stops growing at this length
+#define LEVEL_MAX_SNAKE_PARTS (1 << 20)
+
+// NOTE: bigger levels go without the bitboard layers
+#define LEVEL_MAX_BITBOARD_TILES (1024 * 1024)
+
+// NOTE: tiles min..max inclusive, empty when min > max
+struct TileRect {
+    vec2i min;
+    vec2i max;
+};
+
+struct LevelChunk {
+    u64 tiles[LEVEL_CHUNK_WORDS]; // NOTE: packed tile_type, local index y * LEVEL_CHUNK_SIZE + x
+    u32 free_count; // NOTE: TILE_none tiles inside the level
+    u32 tile_count; // NOTE: tiles of the chunk inside the level
+    
+    LevelChunk *next_free;
+};
+
+#define LEVEL_MAP_NAME_SIZE 32
+
+struct InitSnakeInfo {
+    vec2i head_pos;
+    vec2i move_dir;
+    u32   length;
+};
+
+struct LevelParams {
+    bool looping;
+    bool init_apple;
+    
+    i32 width;
+    i32 height;
+    f32 camera_zpos;
+    f32 time_per_move;
+    InitSnakeInfo snake_info;
+    
+    u32 wall_count;
+    random_seed seed; // NOTE: 0 takes one from game_data->random
+    
+    // NOTE: level file in data/levels/ the rest of the params and the walls come from, see p_level_file.h
+    char map_name[LEVEL_MAP_NAME_SIZE];
+    
+    // NOTE: wall_pattern, generated after the snake and the random walls, see p_maze.h
+    u32 wall_pattern;
+    f32 wall_density;
+};
+
 struct Level {
     bool initialized;
     bool looping;
     bool do_not_draw;
     
+    // NOTE: params.seed is always set, params fully describe the starting state
+    LevelParams params;
+    random_seed random;
+    u32 tick_count;
+    
     Camera camera;
     f32 default_camera_z_pos;
     f32 desired_camera_z_pos;
     
-    Tile *tiles;
-    u32   width;
-    u32   height;
+    u32 width;
+    u32 height;
+    
+    // NOTE: chunks_x * chunks_y, null for empty chunks. Released chunks are kept
+    // in 'free_chunks' and new ones come from 'chunk_arena'
+    LevelChunk **chunks;
+    u32 chunks_x;
+    u32 chunks_y;
+    u32 chunk_count;
+    LevelChunk *free_chunks;
+    MemoryArena *chunk_arena;
+    MappedFile map_file; // NOTE: chunks from the level file point into it, see release_level
+    u64 map_hash; // NOTE: source_hash of the level file, 0 without one
+    
+    // NOTE: the same layers as the tiles, one bit per tile, kept in sync by set_tile.
+    // 'words' is null past LEVEL_MAX_BITBOARD_TILES
+    Bitboard wall_bits;
+    Bitboard apple_bits;
+    Bitboard snake_bits;
+    
+    u32 free_count; // NOTE: sum of the chunk free counts, empty chunks are all free
+    
+    // NOTE: get_free_tile_pos finds the chunk with the n-th free tile in a Fenwick tree over
+    // the chunk free counts (1 based), then the word in the chunk by the free tiles per word.
+    // Both count empty chunks too
+    u32 *chunk_free_tree;
+    u8  *word_free_counts; // NOTE: LEVEL_CHUNK_WORDS per chunk
+    
+    // NOTE: the tiles changed since draw_level last put them in the tile map and in level_fb
+    TileRect tile_map_dirty;
+    TileRect fb_dirty;
     
     bool head_warped;
     bool tail_warped;
-    SnakePart *head;
-    SnakePart *snake_parts;
+    bool tail_stayed;
+    vec2i snake_head;
+    vec2i snake_tail;
+    vec2i apple_pos; // NOTE: -1, -1 when there is no apple
+    
+    // NOTE: ring buffer of snake_dir, one per part, tail -> head. 
+    // Each one is the direction the part moved into its tile, 2 bits each, 4 per byte.
+    // snake_max is the capacity, at most LEVEL_MAX_SNAKE_PARTS whatever the board size.
+    u8 *snake_dirs;
     u32 snake_max;
+    u32 snake_first;
     u32 snake_count;
     
     u32   snake_next_dir_count;
@@ -55,23 +156,21 @@ struct Level {
     f32 move_counter;
 };
 
-struct InitSnakeInfo {
-    vec2i head_pos;
-    vec2i move_dir;
-    u32   length;
+// NOTE: a copy of a level's state living in a caller's arena, see fork_level
+struct LevelFork {
+    Level level;
+    TemporaryMemory memory;
 };
 
-struct LevelParams {
-    bool looping;
-    bool init_apple;
-    
-    i32 width;
-    i32 height;
-    f32 camera_zpos;
-    f32 time_per_move;
-    InitSnakeInfo snake_info;
+enum snake_event {
+    SNAKE_none,
+    SNAKE_ate,
+    SNAKE_died,
+    SNAKE_won,
 };
 
+#define MAX_MOVES_PER_UPDATE 8
+
 enum game_state {
     STATE_menu,
     STATE_game,
@@ -105,14 +204,41 @@ enum game_level {
     LEVEL_custom,
 };
 
-static Tile   *get_tile(Level *level, u32 x, u32 y);
+struct Replay;
+struct Autopilot;
+
+inline u32     get_chunk_tile_index(u32 x, u32 y);
+inline tile_type get_chunk_tile(LevelChunk *chunk, u32 tile_index);
+inline u64     get_chunk_free_mask(LevelChunk *chunk, u32 word, u32 chunk_w, u32 chunk_h);
+static LevelChunk *acquire_level_chunk(Level *level, u32 chunk_index);
+static void    release_level_chunk(Level *level, u32 chunk_index);
+inline u32     get_word_tile_count(u32 word, u32 chunk_w, u32 chunk_h);
+static void    init_level_free_index(Level *level);
+static void    add_chunk_free_count(Level *level, u32 chunk_index, u32 word, i32 delta);
+static u32     find_free_chunk(Level *level, u32 *index);
+static Tile    get_tile(Level *level, u32 x, u32 y);
 static void    set_tile(Level *level, u32 x, u32 y, tile_type type);
+inline TileRect empty_tile_rect(void);
+inline bool    is_empty(TileRect rect);
+static void    add_to_tile_rect(TileRect *rect, u32 x, u32 y, u32 width, u32 height);
+static void    add_to_tile_rect(TileRect *rect, TileRect other);
+static void    mark_level_dirty(Level *level, u32 x, u32 y, u32 width, u32 height);
+inline Bitboard *get_tile_bits(Level *level, tile_type type);
 static vec2i   get_free_tile_pos(Level *level);
 inline Camera *get_level_camera(Level *level);
 inline Level  *get_level(game_level _level);
+static LevelParams get_level_params(game_level level);
+static Level  *load_level(game_level _level);
 static vec2    get_desired_camera_xy(Level *level);
 
+static u64   get_level_memory_size(u32 width, u32 height);
+static void  push_level_memory(Level *level, MemoryArena *arena);
+static void  copy_snake_ring(Level *dest, Level *source);
+static LevelFork fork_level(Level *source, MemoryArena *arena);
+static void  commit_level(Level *dest, LevelFork *fork);
+static void  discard_level(LevelFork *fork);
 static Level make_level(LevelParams params, MemoryArena *arena);
+static void  release_level(Level *level);
 static void  init_snake(Level *level, vec2i start_pos, vec2i dir, u32 count);
 static void  init_game(void);
 static void  init_menu(void);
@@ -121,8 +247,11 @@ static void  place_apple(Level *level);
 inline void transition(f32 speed = 10.0f);
 static void add_snake_part(Level *level);
 
+static void get_tile_sprite(tile_type type, i32 *x_id, i32 *y_id, vec4 *color);
+static bool update_level_tile_map(Level *level);
+static u32  get_level_fb_tile_px(Level *level);
 static void draw_level(Level *level);
-static void draw_snake_body(Level *level, SnakePart *part, vec4 color, bool no_corner = false, bool no_regular = false);
+static void draw_snake_body(Level *level, SnakePart *part, u32 part_index, vec4 color, bool no_corner = false);
 static void draw_snake(Level *level);
 
 static void game_won(void);
@@ -130,11 +259,18 @@ static void game_over(void);
 static void goto_menu(bool from_game = false, bool restart_game = false);
 static void switch_to_level(game_level level, f32 transition_speed = 10.0f);
 static void start_game(game_level level = (game_level)0);
+static bool start_replay(Replay *replay);
 
-static bool maybe_warp(Level *level, SnakePart *part);
+inline u32  get_ring_snake_dir(Level *level, u32 ring_index);
+inline void set_ring_snake_dir(Level *level, u32 ring_index, u32 dir);
+inline u32  get_snake_dir(Level *level, u32 part_index);
+static bool maybe_warp(Level *level, vec2i *tile_pos);
+inline bool step_tile_pos(Level *level, vec2i tile_pos, u32 dir, vec2i *result);
 static void update_free_camera(void);
 static void update_camera(Level *level);
 static void update_snake(Level *level, vec2i move_dir);
+static vec2i next_snake_dir(Level *level);
+static snake_event tick_snake(Level *level, vec2i head_dir);
 static void update_level(Level *level, vec2i move_dir);
 static void update_and_render_menu(void);
 static void update_and_render_game(void);
@@ -157,7 +293,9 @@ struct GameData {
     f32 update_dt;
     recti32 viewport;
     u32 last_frame_draw_calls;
+    i32 last_frame_batches_saved;
     u32 last_frame_quads_drawn;
+    u32 last_frame_upload_bytes;
     
     random_seed random;
     game_state  state;
@@ -166,10 +304,32 @@ struct GameData {
     UI ui;
     Font font;
     PSystem bg_particles;
+    // NOTE: level_fb follows the board's size on the screen, see get_level_fb_tile_px.
+    // 0 px per tile when the level was drawn without it
+#define LEVEL_FB_MAX_TILE_PX 128
+#define LEVEL_FB_MAX_SIZE    8192
+#define LEVEL_FB_MAX_BYTES   (64 * 1024 * 1024)
+#define LEVEL_FB_PIXEL_BYTES 8 // NOTE: rgba8 color + depth24_stencil8
     Framebuffer level_fb;
+    u32 level_fb_tile_px;
+    
+    // NOTE: the level level_fb holds, draw_level redraws only its fb_dirty tiles into it, the snake
+    // is drawn over it in the scene. Null after the debug view or a resize, the next draw fills it again
+    Level *level_fb_level;
     Framebuffer framebuffer;
     ShaderRef *framebuffer_shader;
     
+    // NOTE: the board of 'tile_map_level' for tilemap.glsl, one r8 texel per tile, see draw_level.
+    // Bigger boards and the debug view draw tile by tile.
+#define TILE_MAP_MAX_SIZE 4096
+    // NOTE: the last of the 16 units GL 3.3 guarantees, tilemap.glsl has 15 batch slots so
+    // u_textures and u_tile_map fit in them together
+#define TILE_MAP_TEXTURE_UNIT 15
+    bool use_tile_map;
+    ShaderRef *tile_map_shader;
+    Texture2D tile_map;
+    Level *tile_map_level;
+    
     f32 transition_t_desired;
     f32 transition_t;
     f32 transition_speed;
@@ -177,8 +337,9 @@ struct GameData {
     bool reverse_colors;
     f32  reverse_factor;
     
-    SpriteSheet sprites;
-    Texture2D   sprite_particle;
+    TextureAtlas  atlas;
+    SpriteSheet   sprites;
+    TextureRegion sprite_particle;
     
     bool ui_kb_up;
     bool ui_kb_down;
@@ -201,6 +362,14 @@ struct GameData {
     game_level current_level;
     Level levels[LEVEL_COUNT];
     Level level_custom;
+    
+    Replay *replay;   // NOTE: recording of the last started game
+    Replay *playback;
+    Level  *recording_level;
+    Level  *playback_level;
+    
+    bool use_autopilot;
+    Autopilot *autopilot;
 };
 
 #endif /* P_GAME_MAIN_H */
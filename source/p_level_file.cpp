@@ -0,0 +1,343 @@
+// NOTE: cuts the next word out of the line, null at the end of the line or at a comment
+static char *
+next_level_word(char **at) {
+    char *c = *at;
+    while(*c == ' ' || *c == '\t' || *c == '\r') {
+        ++c;
+    }
+    
+    if(*c == '\0' || *c == '#') {
+        *at = c;
+        return nullptr;
+    }
+    
+    char *word = c;
+    while(*c != '\0' && *c != ' ' && *c != '\t' && *c != '\r') {
+        ++c;
+    }
+    if(*c != '\0') {
+        *c++ = '\0';
+    }
+    *at = c;
+    return word;
+}
+
+static bool
+parse_level_text(char *text, LevelParams *params, Level *map, MemoryArena *arena) {
+    *params = {};
+    *map = {};
+    params->init_apple = true;
+    
+    char *map_rows = nullptr;
+    for(char *line = text; line && *line;) {
+        char *next_line = strchr(line, '\n');
+        if(next_line) {
+            *next_line++ = '\0';
+        }
+        
+        char *at = line;
+        char *key = next_level_word(&at);
+        line = next_line;
+        if(!key) {
+            continue;
+        }
+        
+        char *values[4] = {};
+        for(u32 i = 0; i < size_array(values); ++i) {
+            values[i] = next_level_word(&at);
+            if(!values[i]) {
+                break;
+            }
+        }
+        
+        if(compare_strings(key, "map")) {
+            map_rows = next_line;
+            break;
+        }
+        else if(!values[0]) {
+            game_log("level file: '%s' without a value...\n", key);
+            return false;
+        }
+        else if(compare_strings(key, "width")) {
+            params->width = atoi(values[0]);
+        }
+        else if(compare_strings(key, "height")) {
+            params->height = atoi(values[0]);
+        }
+        else if(compare_strings(key, "looping")) {
+            params->looping = compare_strings(values[0], "true");
+        }
+        else if(compare_strings(key, "apple")) {
+            params->init_apple = compare_strings(values[0], "true");
+        }
+        else if(compare_strings(key, "camera_zpos")) {
+            params->camera_zpos = (f32)atof(values[0]);
+        }
+        else if(compare_strings(key, "time_per_move")) {
+            params->time_per_move = (f32)atof(values[0]);
+        }
+        else if(compare_strings(key, "random_walls")) {
+            params->wall_count = (u32)atoi(values[0]);
+        }
+        else if(compare_strings(key, "walls")) {
+            if(!values[1]) {
+                game_log("level file: walls needs a pattern and a density...\n");
+                return false;
+            }
+            
+            params->wall_pattern = WALLS_COUNT;
+            for(u32 i = 0; i < WALLS_COUNT; ++i) {
+                if(compare_strings(values[0], wall_pattern_names[i])) {
+                    params->wall_pattern = i;
+                }
+            }
+            if(params->wall_pattern == WALLS_COUNT) {
+                game_log("level file: '%s' is not a wall pattern...\n", values[0]);
+                return false;
+            }
+            params->wall_density = clamp((f32)atof(values[1]), 0.0f, 1.0f);
+        }
+        else if(compare_strings(key, "snake")) {
+            if(!values[3]) {
+                game_log("level file: snake needs x, y, direction and length...\n");
+                return false;
+            }
+            
+            u32 dir = DIR_none;
+            const char *dir_names[DIR_COUNT] = { "right", "up", "left", "down" };
+            for(u32 i = 0; i < DIR_COUNT; ++i) {
+                if(compare_strings(values[2], dir_names[i])) {
+                    dir = i;
+                }
+            }
+            if(dir == DIR_none) {
+                game_log("level file: '%s' is not a direction...\n", values[2]);
+                return false;
+            }
+            params->snake_info.head_pos = { atoi(values[0]), atoi(values[1]) };
+            params->snake_info.move_dir = dir_to_vec2i(dir);
+            params->snake_info.length   = (u32)atoi(values[3]);
+        }
+        else {
+            game_log("level file: unknown key '%s'...\n", key);
+            return false;
+        }
+    }
+    
+    if(params->width <= 0 || params->height <= 0) {
+        game_log("level file: no size...\n");
+        return false;
+    }
+    
+    map->width  = params->width;
+    map->height = params->height;
+    push_level_memory(map, arena);
+    
+    // NOTE: top row first, anything but '#' is floor, short rows are padded with floor
+    for(u32 row = 0; map_rows && *map_rows && row < map->height; ++row) {
+        u32 y = map->height - 1 - row;
+        char *c = map_rows;
+        for(u32 x = 0; *c != '\0' && *c != '\n' && *c != '\r'; ++x, ++c) {
+            if(*c == '#' && x < map->width) {
+                set_tile(map, x, y, TILE_wall);
+            }
+        }
+        
+        map_rows = strchr(c, '\n');
+        if(map_rows) {
+            ++map_rows;
+        }
+    }
+    
+    // NOTE: init_snake only warps the body on looping levels, and it must not cross itself
+    InitSnakeInfo *snake = &params->snake_info;
+    if(snake->length > 0) {
+        vec2i pos = snake->head_pos;
+        i32 board_length = snake->move_dir.x ? params->width : params->height;
+        if(params->looping && snake->length >= (u32)board_length) {
+            game_log("level file: snake is too long to fit...\n");
+            return false;
+        }
+        for(u32 i = 0; i <= snake->length; ++i) {
+            if(i > 0) {
+                pos -= snake->move_dir;
+                if(params->looping) {
+                    maybe_warp(map, &pos);
+                }
+            }
+            if(!is_in_bounds(pos.x, 0, params->width - 1) || !is_in_bounds(pos.y, 0, params->height - 1)) {
+                game_log("level file: snake goes off the board...\n");
+                return false;
+            }
+            if(get_tile(map, pos.x, pos.y).type == TILE_wall) {
+                game_log("level file: snake starts on a wall...\n");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static b32
+compile_level_file(const char *text_path, const char *binary_path, MemoryArena *arena, PlatformProcs *procs) {
+    FileContents file;
+    if(!procs->read_file(&file, text_path, true)) {
+        return false;
+    }
+    
+    TemporaryMemory memory = begin_temporary_memory(arena);
+    // NOTE: before the parser gets to the text
+    u64 source_hash = hash_bytes(file.contents, file.size);
+    LevelParams params;
+    Level map;
+    bool parsed = parse_level_text((char *)file.contents, &params, &map, arena);
+    procs->free_file(&file);
+    
+    b32 result = false;
+    if(parsed) {
+        u32 chunk_total   = map.chunks_x * map.chunks_y;
+        u32 table_offset  = sizeof(LevelFileHeader);
+        u32 chunks_offset = (table_offset + chunk_total * sizeof(u32) + LEVEL_FILE_ALIGNMENT - 1) & ~(LEVEL_FILE_ALIGNMENT - 1);
+        u32 size = chunks_offset + map.chunk_count * sizeof(LevelChunk);
+        u8 *data = (u8 *)procs->alloc(size);
+        if(data) {
+            zero_memory(data, size);
+            LevelFileHeader *header = (LevelFileHeader *)data;
+            header->magic         = LEVEL_FILE_MAGIC;
+            header->version       = LEVEL_FILE_VERSION;
+            header->chunk_size    = sizeof(LevelChunk);
+            header->chunk_count   = map.chunk_count;
+            header->chunks_x      = map.chunks_x;
+            header->chunks_y      = map.chunks_y;
+            header->table_offset  = table_offset;
+            header->chunks_offset = chunks_offset;
+            header->source_time   = procs->last_write_time(text_path);
+            header->source_hash   = source_hash;
+            header->params        = params;
+            
+            u32 *table = (u32 *)(data + table_offset);
+            LevelChunk *chunks = (LevelChunk *)(data + chunks_offset);
+            u32 stored = 0;
+            for(u32 chunk_index = 0; chunk_index < chunk_total; ++chunk_index) {
+                LevelChunk *chunk = map.chunks[chunk_index];
+                table[chunk_index] = LEVEL_FILE_NO_CHUNK;
+                if(chunk) {
+                    table[chunk_index] = stored;
+                    chunks[stored] = *chunk;
+                    chunks[stored].next_free = nullptr;
+                    header->wall_count += chunk->tile_count - chunk->free_count;
+                    ++stored;
+                }
+            }
+            
+            result = procs->write_file(binary_path, data, size);
+            procs->free(data);
+        }
+    }
+    
+    end_temporary_memory(memory);
+    return result;
+}
+
+// NOTE: null unless the whole file checks out
+static LevelFileHeader *
+check_level_file(MappedFile *file) {
+    LevelFileHeader *header = (LevelFileHeader *)file->contents;
+    if(file->size < sizeof(LevelFileHeader) || header->magic != LEVEL_FILE_MAGIC ||
+       header->version != LEVEL_FILE_VERSION || header->chunk_size != sizeof(LevelChunk)) {
+        return nullptr;
+    }
+    
+    LevelParams *params = &header->params;
+    if(params->width <= 0 || params->height <= 0 ||
+       header->chunks_x != (((u32)params->width  + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT) ||
+       header->chunks_y != (((u32)params->height + LEVEL_CHUNK_SIZE - 1) >> LEVEL_CHUNK_SHIFT)) {
+        return nullptr;
+    }
+    
+    u32 chunk_total = header->chunks_x * header->chunks_y;
+    u64 table_end  = (u64)header->table_offset  + (u64)chunk_total * sizeof(u32);
+    u64 chunks_end = (u64)header->chunks_offset + (u64)header->chunk_count * sizeof(LevelChunk);
+    if(table_end > file->size || chunks_end > file->size || (header->chunks_offset & (LEVEL_FILE_ALIGNMENT - 1))) {
+        return nullptr;
+    }
+    
+    u32 *table = (u32 *)((u8 *)file->contents + header->table_offset);
+    for(u32 chunk_index = 0; chunk_index < chunk_total; ++chunk_index) {
+        if(table[chunk_index] != LEVEL_FILE_NO_CHUNK && table[chunk_index] >= header->chunk_count) {
+            return nullptr;
+        }
+    }
+    return header;
+}
+
+// NOTE: compiles the text first when the binary is missing, stale or from another build
+static LevelFileHeader *
+map_level_file(const char *map_name, MappedFile *file, MemoryArena *arena, PlatformProcs *procs) {
+    char text_path[256];
+    char binary_path[256];
+    snprintf(text_path,   size_array(text_path),   "%s%s.lvl",  LEVEL_FILE_DIR, map_name);
+    snprintf(binary_path, size_array(binary_path), "%s%s.lvlb", LEVEL_FILE_DIR, map_name);
+    
+    PTime no_time = {};
+    PTime text_time = procs->last_write_time(text_path);
+    bool has_text = !p_time_cmp(&text_time, &no_time);
+    
+    if(procs->map_file(file, binary_path)) {
+        LevelFileHeader *header = check_level_file(file);
+        if(header && (!has_text || p_time_cmp(&header->source_time, &text_time))) {
+            return header;
+        }
+        procs->unmap_file(file);
+    }
+    
+    if(!has_text || !compile_level_file(text_path, binary_path, arena, procs)) {
+        return nullptr;
+    }
+    
+    if(!procs->map_file(file, binary_path)) {
+        return nullptr;
+    }
+    LevelFileHeader *header = check_level_file(file);
+    if(!header) {
+        procs->unmap_file(file);
+    }
+    return header;
+}
+
+// NOTE: the level's chunks point straight into the mapped file, nothing is copied
+static void
+attach_level_file(Level *level, LevelFileHeader *header) {
+    ASSERT(header->chunks_x == level->chunks_x && header->chunks_y == level->chunks_y, "level file size mismatch");
+    u32 *table = (u32 *)((u8 *)header + header->table_offset);
+    LevelChunk *chunks = (LevelChunk *)((u8 *)header + header->chunks_offset);
+    
+    u32 chunk_total = level->chunks_x * level->chunks_y;
+    for(u32 chunk_index = 0; chunk_index < chunk_total; ++chunk_index) {
+        if(table[chunk_index] == LEVEL_FILE_NO_CHUNK) {
+            continue;
+        }
+        
+        LevelChunk *chunk = chunks + table[chunk_index];
+        level->chunks[chunk_index] = chunk;
+        level->free_count -= chunk->tile_count - chunk->free_count;
+        ++level->chunk_count;
+        
+        if(!level->wall_bits.words) {
+            continue;
+        }
+        
+        // NOTE: TILE_wall is the only code with just the low bit set
+        u32 x0 = (chunk_index % level->chunks_x) << LEVEL_CHUNK_SHIFT;
+        u32 y0 = (chunk_index / level->chunks_x) << LEVEL_CHUNK_SHIFT;
+        for(u32 word = 0; word < LEVEL_CHUNK_WORDS; ++word) {
+            u64 tiles = chunk->tiles[word];
+            u64 walls = tiles & ~(tiles >> 1) & 0x5555555555555555ull;
+            for(; walls; walls &= walls - 1) {
+                u32 local = word * 32 + popcount_u64((walls & (~walls + 1)) - 1) / LEVEL_TILE_BITS;
+                bitboard_set(&level->wall_bits, x0 + (local & (LEVEL_CHUNK_SIZE - 1)), y0 + (local >> LEVEL_CHUNK_SHIFT));
+            }
+        }
+    }
+    init_level_free_index(level);
+}
@@ -0,0 +1,48 @@
+#ifndef P_LEVEL_FILE_H
+#define P_LEVEL_FILE_H
+
+// NOTE: levels are authored as text in data/levels/<name>.lvl and compiled on load to
+// <name>.lvlb next to it, whenever the text changed. The binary file is the header, a table
+// with one entry per chunk and the non empty chunks as LevelChunks, so a mapped file is
+// used as the level's tiles as it is. The view is copy on write, the game writes to it freely.
+//
+// Text format, one key per line, '#' starts a comment:
+//   width 16
+//   height 16
+//   looping true
+//   apple true
+//   camera_zpos 25
+//   time_per_move 0.2
+//   snake 6 6 right 4    (head x, head y, move direction, parts behind the head)
+//   random_walls 8       (placed on top of the map's walls when the level is made)
+//   walls maze 0.3       (wall_pattern and density, generated after the random walls, see p_maze.h)
+//   map                  (optional, the rest of the file, top row first, '#' is a wall)
+
+#define LEVEL_FILE_MAGIC     0x564c4e53 // NOTE: "SNLV"
+#define LEVEL_FILE_VERSION   3
+#define LEVEL_FILE_ALIGNMENT 4096       // NOTE: chunks start on a page
+#define LEVEL_FILE_NO_CHUNK  U32_MAX
+#define LEVEL_FILE_DIR       DATA_DIR("levels/")
+
+struct LevelFileHeader {
+    u32 magic;
+    u32 version;
+    u32 chunk_size;  // NOTE: sizeof(LevelChunk) of the build that wrote it
+    u32 chunk_count;
+    u32 chunks_x;
+    u32 chunks_y;
+    u32 wall_count;
+    u32 table_offset;  // NOTE: u32 per chunk, index of the stored chunk or LEVEL_FILE_NO_CHUNK
+    u32 chunks_offset;
+    PTime source_time; // NOTE: last write time of the text it was compiled from
+    u64   source_hash; // NOTE: hash_bytes of the text, replays keep it, see p_replay.h
+    LevelParams params;
+};
+
+static bool parse_level_text(char *text, LevelParams *params, Level *map, MemoryArena *arena);
+static b32  compile_level_file(const char *text_path, const char *binary_path, MemoryArena *arena, PlatformProcs *procs);
+static LevelFileHeader *check_level_file(MappedFile *file);
+static LevelFileHeader *map_level_file(const char *map_name, MappedFile *file, MemoryArena *arena, PlatformProcs *procs);
+static void attach_level_file(Level *level, LevelFileHeader *header);
+
+#endif /* P_LEVEL_FILE_H */
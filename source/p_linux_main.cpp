@@ -0,0 +1,890 @@
+#include <stdlib.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "p_platform_common.h"
+
+#include "p_renderer_null.h"
+#include "p_renderer_null.cpp"
+#include "p_renderer_software.h"
+#include "p_renderer_software.cpp"
+
+#include "p_linux_main.h"
+
+// NOTE: set working directory to the executable's location
+static void set_working_directory(void) {
+    char exe_path[256];
+    ssize_t length = readlink("/proc/self/exe", exe_path, size_array(exe_path) - 1);
+    if(length > 0) {
+        exe_path[length] = '\0';
+        if(chdir(dirname(exe_path)) != 0) {
+            linux_log("couldn't set the working directory...\n");
+        }
+    }
+}
+
+inline bool
+file_exists(const char *file_path) {
+    return access(file_path, F_OK) == 0;
+}
+
+inline bool
+delete_file(const char *file_path) {
+    return unlink(file_path) == 0;
+}
+
+static bool
+copy_file(const char *source_path, const char *dest_path) {
+    i32 source = open(source_path, O_RDONLY);
+    if(source < 0) {
+        return false;
+    }
+    
+    // NOTE: a new inode, the loaded module may still be mapped from the old one
+    unlink(dest_path);
+    i32 dest = open(dest_path, O_WRONLY | O_CREAT | O_TRUNC, 0755);
+    bool result = (dest >= 0);
+    
+    char buffer[64 * 1024];
+    ssize_t bytes;
+    while(result && (bytes = read(source, buffer, sizeof(buffer))) > 0) {
+        result = (write(dest, buffer, bytes) == bytes);
+    }
+    
+    close(source);
+    if(dest >= 0) {
+        close(dest);
+    }
+    return result;
+}
+
+ALLOC_MEMORY_PROC(alloc_memory) {
+    if(bytes == 0) { return nullptr; }
+    void *mem = malloc(bytes);
+    return mem;
+}
+
+REALLOC_MEMORY_PROC(realloc_memory) {
+    void *mem = realloc(*mem_ptr, bytes);
+    if(mem) {
+        *mem_ptr = mem;
+        return true;
+    }
+    return false;
+}
+
+FREE_MEMORY_PROC(free_memory) {
+    free(mem);
+}
+
+READ_FILE_PROC(read_file) {
+    FILE *_file = fopen(path, "rb");
+    if(_file) {
+        fseek(_file, 0, SEEK_END);
+        file->size = ftell(_file);
+        fseek(_file, 0, SEEK_SET);
+        if(null_terminated) {
+            file->contents = malloc(file->size + 1);
+            file->size = (u32)fread(file->contents, 1, file->size, _file);
+            ((char *)file->contents)[file->size] = '\0';
+        }
+        else {
+            file->contents = malloc(file->size);
+            file->size = (u32)fread(file->contents, 1, file->size, _file);
+        }
+        fclose(_file);
+        return true;
+    }
+    else {
+        file->size = 0;
+        file->contents = 0;
+    }
+    return false;
+}
+
+FREE_FILE_PROC(free_file) {
+    free(file->contents);
+    file->size = 0;
+    file->contents = nullptr;
+}
+
+WRITE_FILE_PROC(write_file) {
+    FILE *_file = fopen(path, "wb");
+    if(_file) {
+        size_t written = fwrite(data, 1, size, _file);
+        fclose(_file);
+        return written == size;
+    }
+    return false;
+}
+
+// NOTE: UTC like the win32 one
+LAST_WRITE_TIME_PROC(last_write_time) {
+    PTime last_write_time = {};
+    struct stat file_stat;
+    struct tm time;
+    if(stat(path, &file_stat) == 0 && gmtime_r(&file_stat.st_mtim.tv_sec, &time)) {
+        last_write_time.year = (u16)(time.tm_year + 1900);
+        last_write_time.month = (u16)(time.tm_mon + 1);
+        last_write_time.day = (u16)time.tm_mday;
+        last_write_time.hour = (u16)time.tm_hour;
+        last_write_time.minute = (u16)time.tm_min;
+        last_write_time.second = (u16)time.tm_sec;
+        last_write_time.milliseconds = (u16)(file_stat.st_mtim.tv_nsec / 1000000);
+    }
+    return last_write_time;
+}
+
+MAP_FILE_PROC(map_file) {
+    *file = {};
+    i32 fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    
+    struct stat file_stat;
+    void *view = MAP_FAILED;
+    if(fstat(fd, &file_stat) == 0 && file_stat.st_size > 0 && file_stat.st_size <= U32_MAX) {
+        view = mmap(0, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    
+    // NOTE: the mapping keeps the file open
+    close(fd);
+    if(view == MAP_FAILED) {
+        return false;
+    }
+    file->size = (u32)file_stat.st_size;
+    file->contents = view;
+    return true;
+}
+
+UNMAP_FILE_PROC(unmap_file) {
+    if(file->contents) {
+        munmap(file->contents, file->size);
+    }
+    *file = {};
+}
+
+// NOTE: no audio device on the servers, sounds are dropped
+CREATE_SOUND_PROC(create_sound) {
+    return 0;
+}
+
+DELETE_SOUND_PROC(delete_sound) {
+}
+
+PLAY_SOUND_PROC(play_sound) {
+}
+
+ADD_WORK_ENTRY_PROC(add_work_entry) {
+    u32 new_next_entry_to_write = (queue->next_entry_to_write + 1) % size_array(queue->entries);
+    ASSERT(new_next_entry_to_write != queue->next_entry_to_read, "work queue overflow");
+    PlatformWorkQueueEntry *entry = queue->entries + queue->next_entry_to_write;
+    entry->callback = callback;
+    entry->data = data;
+    ++queue->completion_goal;
+    
+    // NOTE: entry has to be visible before the write index moves
+    __sync_synchronize();
+    queue->next_entry_to_write = new_next_entry_to_write;
+    sem_post(&queue->semaphore);
+}
+
+static bool
+do_next_work_entry(PlatformWorkQueue *queue) {
+    bool should_sleep = false;
+    
+    u32 original_next_entry_to_read = queue->next_entry_to_read;
+    u32 new_next_entry_to_read = (original_next_entry_to_read + 1) % size_array(queue->entries);
+    if(original_next_entry_to_read != queue->next_entry_to_write) {
+        u32 index = atomic_compare_exchange_u32(&queue->next_entry_to_read,
+                                                original_next_entry_to_read, new_next_entry_to_read);
+        if(index == original_next_entry_to_read) {
+            PlatformWorkQueueEntry entry = queue->entries[index];
+            entry.callback(queue, entry.data);
+            atomic_add_u32(&queue->completion_count, 1);
+        }
+    }
+    else {
+        should_sleep = true;
+    }
+    return should_sleep;
+}
+
+COMPLETE_ALL_WORK_PROC(complete_all_work) {
+    // NOTE: calling thread helps with the work instead of waiting
+    while(queue->completion_goal != queue->completion_count) {
+        do_next_work_entry(queue);
+    }
+    queue->completion_goal = 0;
+    queue->completion_count = 0;
+}
+
+static void *
+worker_thread_proc(void *param) {
+    PlatformWorkQueue *queue = (PlatformWorkQueue *)param;
+    for(;;) {
+        if(do_next_work_entry(queue)) {
+            sem_wait(&queue->semaphore);
+        }
+    }
+    return 0;
+}
+
+static void
+init_work_queue(PlatformWorkQueue *queue, u32 thread_count) {
+    queue->completion_goal = 0;
+    queue->completion_count = 0;
+    queue->next_entry_to_write = 0;
+    queue->next_entry_to_read = 0;
+    queue->thread_count = thread_count;
+    sem_init(&queue->semaphore, 0, 0);
+    for(u32 i = 0; i < thread_count; ++i) {
+        pthread_t thread;
+        if(pthread_create(&thread, 0, worker_thread_proc, queue) == 0) {
+            pthread_detach(thread);
+        }
+    }
+}
+
+static u32
+get_worker_thread_count(void) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    u32 count = (processors > 1) ? (u32)(processors - 1) : 0;
+    return count;
+}
+
+GET_WALL_CLOCK_PROC(get_wall_clock) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    f64 seconds = (f64)time.tv_sec + (f64)time.tv_nsec * 1e-9;
+    return seconds;
+}
+
+static void
+unload_game_so(GameSO *so) {
+    if(!so->loaded) {
+        return;
+    }
+    
+    if(so->module) {
+        dlclose(so->module);
+        so->module = 0;
+        so->loaded = false;
+    }
+}
+
+static GameSO
+load_game_so(void) {
+    GameSO so = {};
+    if(!so_lock_file || !file_exists(so_lock_file)) {
+        if(copy_file(so_path, so_temp_path)) {
+            so.last_write_time = last_write_time(so_path);
+            so.module = dlopen(so_temp_path, RTLD_NOW | RTLD_LOCAL);
+            if(so.module) {
+                so.game_init = (game_init_proc *)
+                    dlsym(so.module, "game_init");
+                so.game_frame = (game_frame_proc *)
+                    dlsym(so.module, "game_frame");
+                so.size_callback = (game_size_callback_proc *)
+                    dlsym(so.module, "size_callback");
+                so.hotload_callback = (game_hotload_callback_proc *)
+                    dlsym(so.module, "hotload_callback");
+                so.get_startup_params = (game_get_startup_params_proc *)
+                    dlsym(so.module, "get_startup_params");
+            }
+            else {
+                linux_log("%s\n", dlerror());
+            }
+            so.loaded = so.game_init && so.game_frame && so.size_callback
+                && so.hotload_callback && so.get_startup_params;
+        }
+        else {
+            so.loaded = false;
+        }
+    }
+    return so;
+}
+
+static void
+hotload_game_so(GameSO *so, Core *core) {
+    PTime game_so_last_write_time = last_write_time(so_path);
+    if(!p_time_cmp(&game_so_last_write_time, &so->last_write_time) && !file_exists(so_lock_file)) {
+        // NOTE: dlopen hands back the loaded module for a path it already has, the old one goes first
+        unload_game_so(so);
+        *so = load_game_so();
+        if(so->hotload_callback) {
+            so->hotload_callback(core);
+        }
+        linux_log("game so hotloaded...\n");
+    }
+}
+
+static u32 png_crc_table[256];
+
+static u32
+png_crc(u32 crc, u8 *data, size_t size) {
+    if(!png_crc_table[1]) {
+        for(u32 n = 0; n < 256; ++n) {
+            u32 c = n;
+            for(u32 k = 0; k < 8; ++k) {
+                c = (c & 1) ? (0xedb88320 ^ (c >> 1)) : (c >> 1);
+            }
+            png_crc_table[n] = c;
+        }
+    }
+    
+    crc = ~crc;
+    for(size_t i = 0; i < size; ++i) {
+        crc = png_crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+inline u8 *
+png_put_u32(u8 *at, u32 value) {
+    at[0] = (u8)(value >> 24);
+    at[1] = (u8)(value >> 16);
+    at[2] = (u8)(value >> 8);
+    at[3] = (u8)value;
+    return at + 4;
+}
+
+// NOTE: 'data' starts 8 bytes in so the length and type go in front, crc after
+static u8 *
+png_put_chunk(u8 *at, const char *type, u32 size) {
+    png_put_u32(at, size);
+    copy_memory((void *)type, at + 4, 4);
+    return png_put_u32(at + 8 + size, png_crc(0, at + 4, size + 4));
+}
+
+// NOTE: deflate with stored blocks, no zlib here and the writer has to keep up with the game.
+// Rows are flipped on the way since read_pixels hands them bottom up.
+static bool
+write_png(const char *file_path, CaptureFrame *frame, u8 **scratch, size_t *scratch_size) {
+    const u32 max_block = 65535;
+    size_t row_size = 1 + (size_t)frame->width * 4;
+    size_t raw_size = row_size * frame->height;
+    size_t block_count = max_value((raw_size + max_block - 1) / max_block, (size_t)1);
+    size_t idat_size = 2 + block_count * 5 + raw_size + 4;
+    size_t png_size = 8 + (12 + 13) + (12 + idat_size) + 12;
+    if(*scratch_size < png_size) {
+        if(!realloc_memory((void **)scratch, png_size)) {
+            return false;
+        }
+        *scratch_size = png_size;
+    }
+    
+    u8 *at = *scratch;
+    const u8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    copy_memory((void *)signature, at, 8);
+    at += 8;
+    
+    u8 *ihdr = at + 8;
+    png_put_u32(ihdr + 0, frame->width);
+    png_put_u32(ihdr + 4, frame->height);
+    ihdr[8]  = 8; // NOTE: bit depth
+    ihdr[9]  = 6; // NOTE: RGBA
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    at = png_put_chunk(at, "IHDR", 13);
+    
+    u8 *idat = at + 8;
+    u8 *out = idat;
+    *out++ = 0x78;
+    *out++ = 0x01;
+    u32 adler_a = 1;
+    u32 adler_b = 0;
+    size_t block_left = 0;
+    size_t raw_left = raw_size;
+    for(i32 y = frame->height - 1; y >= 0; --y) {
+        u8 *row = frame->pixels + (size_t)y * frame->width * 4;
+        for(size_t i = 0; i < row_size; ++i) {
+            if(!block_left) {
+                block_left = min_value(raw_left, (size_t)max_block);
+                raw_left -= block_left;
+                *out++ = (raw_left == 0) ? 1 : 0;
+                *out++ = (u8)block_left;
+                *out++ = (u8)(block_left >> 8);
+                *out++ = (u8)~block_left;
+                *out++ = (u8)(~block_left >> 8);
+            }
+            
+            // NOTE: filter type 0 in front of every row
+            u8 byte = i ? row[i - 1] : 0;
+            *out++ = byte;
+            --block_left;
+            adler_a = (adler_a + byte) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+    }
+    out = png_put_u32(out, (adler_b << 16) | adler_a);
+    at = png_put_chunk(at, "IDAT", (u32)(out - idat));
+    at = png_put_chunk(at, "IEND", 0);
+    
+    return write_file(file_path, *scratch, (u32)(at - *scratch));
+}
+
+static bool
+write_raw_frame(FILE *file, CaptureFrame *frame) {
+    bool result = true;
+    size_t row_size = (size_t)frame->width * 4;
+    for(i32 y = frame->height - 1; y >= 0 && result; --y) {
+        result = fwrite(frame->pixels + (size_t)y * row_size, 1, row_size, file) == row_size;
+    }
+    return result;
+}
+
+static void
+log_raw_capture_hint(Capture *capture) {
+    linux_log("capture: ffmpeg -f rawvideo -pix_fmt rgba -s %dx%d -r %.0f -i %s\n", capture->raw_width, capture->raw_height,
+              capture->frame_rate, capture->raw_path);
+}
+
+// NOTE: ffmpeg reads a raw file at one size, a frame of another size goes to the next file
+static bool
+write_raw_capture_frame(Capture *capture, CaptureFrame *frame) {
+    if(frame->width != capture->raw_width || frame->height != capture->raw_height) {
+        if(capture->raw_frames) {
+            log_raw_capture_hint(capture);
+            if(capture->raw_file) {
+                fclose(capture->raw_file);
+            }
+            snprintf(capture->raw_path, size_array(capture->raw_path), "%s.%u", capture->path, ++capture->raw_part);
+            capture->raw_file = fopen(capture->raw_path, "wb");
+            capture->raw_frames = 0;
+            if(!capture->raw_file) {
+                linux_log("couldn't open '%s' for capture...\n", capture->raw_path);
+            }
+        }
+        capture->raw_width  = frame->width;
+        capture->raw_height = frame->height;
+    }
+    
+    if(!capture->raw_file || !write_raw_frame(capture->raw_file, frame)) {
+        return false;
+    }
+    ++capture->raw_frames;
+    return true;
+}
+
+static void *
+capture_thread_proc(void *param) {
+    Capture *capture = (Capture *)param;
+    u8 *scratch = nullptr;
+    size_t scratch_size = 0;
+    for(;;) {
+        if(capture->next_frame_to_read == capture->next_frame_to_write) {
+            if(capture->quit) {
+                break;
+            }
+            sem_wait(&capture->semaphore);
+            continue;
+        }
+        
+        CaptureFrame *frame = capture->frames + capture->next_frame_to_read;
+        bool written = false;
+        if(capture->format == CAPTURE_png) {
+            char file_path[512];
+            snprintf(file_path, size_array(file_path), "%s_%05u.png", capture->path, frame->frame);
+            written = write_png(file_path, frame, &scratch, &scratch_size);
+        }
+        else {
+            written = write_raw_capture_frame(capture, frame);
+        }
+        atomic_add_u32(written ? &capture->written_count : &capture->failed_count, 1);
+        
+        // NOTE: done with the pixels before the slot goes back to the game thread
+        __sync_synchronize();
+        capture->next_frame_to_read = (capture->next_frame_to_read + 1) % CAPTURE_QUEUE_SIZE;
+    }
+    
+    free_memory(scratch);
+    return 0;
+}
+
+// NOTE: makes the directory and its parents, fails if it ends up not writable
+static bool
+make_capture_directory(const char *path) {
+    char dir[512];
+    snprintf(dir, size_array(dir), "%s", path);
+    for(char *at = dir + 1; *at; ++at) {
+        if(*at == '/') {
+            *at = 0;
+            mkdir(dir, 0755);
+            *at = '/';
+        }
+    }
+    mkdir(dir, 0755);
+    
+    struct stat dir_stat;
+    return stat(dir, &dir_stat) == 0 && S_ISDIR(dir_stat.st_mode) && access(dir, W_OK) == 0;
+}
+
+static bool
+init_capture(Capture *capture, capture_format format, const char *path, f32 frame_rate) {
+    *capture = {};
+    capture->format = format;
+    capture->path = path;
+    capture->frame_rate = frame_rate;
+    capture->report_time = get_wall_clock();
+    if(format == CAPTURE_png) {
+        // NOTE: the path is a file name prefix, the frames go in its directory
+        char path_copy[512];
+        snprintf(path_copy, size_array(path_copy), "%s", path);
+        const char *dir = dirname(path_copy);
+        if(!make_capture_directory(dir)) {
+            linux_log("can't write captured frames to '%s'...\n", dir);
+            return false;
+        }
+    }
+    else if(format == CAPTURE_raw) {
+        snprintf(capture->raw_path, size_array(capture->raw_path), "%s", path);
+        capture->raw_file = fopen(path, "wb");
+        if(!capture->raw_file) {
+            linux_log("couldn't open '%s' for capture...\n", path);
+            return false;
+        }
+    }
+    
+    sem_init(&capture->semaphore, 0, 0);
+    if(pthread_create(&capture->thread, 0, capture_thread_proc, capture) != 0) {
+        linux_log("couldn't start the capture thread...\n");
+        return false;
+    }
+    return true;
+}
+
+// NOTE: never waits on the writer, a full queue drops the frame
+static void
+capture_frame(Capture *capture, RendererAPI *api, u32 frame, i32 width, i32 height) {
+    u32 new_next_frame_to_write = (capture->next_frame_to_write + 1) % CAPTURE_QUEUE_SIZE;
+    if(new_next_frame_to_write == capture->next_frame_to_read) {
+        ++capture->dropped_count;
+        return;
+    }
+    
+    CaptureFrame *slot = capture->frames + capture->next_frame_to_write;
+    u32 size = (u32)width * (u32)height * 4;
+    if(slot->size < size) {
+        if(!realloc_memory((void **)&slot->pixels, size)) {
+            ++capture->dropped_count;
+            return;
+        }
+        slot->size = size;
+    }
+    if(!api->read_pixels(nullptr, 0, 0, width, height, slot->pixels)) {
+        ++capture->dropped_count;
+        return;
+    }
+    slot->frame = frame;
+    slot->width = width;
+    slot->height = height;
+    ++capture->captured_count;
+    
+    // NOTE: pixels have to be visible before the write index moves
+    __sync_synchronize();
+    capture->next_frame_to_write = new_next_frame_to_write;
+    sem_post(&capture->semaphore);
+}
+
+// NOTE: whether the writer keeps up while the capture runs, the drops since the last report
+static void
+report_capture(Capture *capture, u32 frame) {
+    f64 now = get_wall_clock();
+    f64 seconds = now - capture->report_time;
+    u32 queued = (capture->next_frame_to_write + CAPTURE_QUEUE_SIZE - capture->next_frame_to_read) % CAPTURE_QUEUE_SIZE;
+    linux_log("capture: %.0f frames/s, %u dropped in the last %.1fs, %u dropped in total, %u queued\n", 
+              (seconds > 0.0) ? (f64)(frame - capture->report_frame) / seconds : 0.0, 
+              capture->dropped_count - capture->report_dropped, seconds, capture->dropped_count, queued);
+    capture->report_time = now;
+    capture->report_frame = frame;
+    capture->report_dropped = capture->dropped_count;
+}
+
+// NOTE: lets the writer drain the queue
+static void
+finish_capture(Capture *capture) {
+    capture->quit = true;
+    sem_post(&capture->semaphore);
+    pthread_join(capture->thread, 0);
+    if(capture->raw_file) {
+        fclose(capture->raw_file);
+    }
+    if(capture->raw_frames) {
+        log_raw_capture_hint(capture);
+    }
+    for(u32 i = 0; i < CAPTURE_QUEUE_SIZE; ++i) {
+        free_memory(capture->frames[i].pixels);
+    }
+    
+    linux_log("capture: %u frames captured, %u dropped, %u written, %u failed\n", capture->captured_count,
+              capture->dropped_count, capture->written_count, capture->failed_count);
+}
+
+static void
+get_headless_input(Input *input, HeadlessParams *params) {
+    u32 frame = input->frames_elapsed;
+    
+    // NOTE: Keyboard
+    bool kb_input = false;
+    for(u32 i = 0; i < KB_KEY_COUNT; ++i) {
+        bool key_down = false;
+        for(u32 press_index = 0; press_index < params->press_count; ++press_index) {
+            HeadlessPress *press = params->presses + press_index;
+            if(press->key == (kb_key)i && frame >= press->frame && frame < (press->frame + press->frame_count)) {
+                key_down = true;
+            }
+        }
+        
+        ButtonState key = get_kb_key_state(input, (kb_key)i);
+        if(update_button_state(key, key_down)) {
+            kb_input = true;
+        }
+    }
+    input->kb_input = kb_input;
+    
+    // NOTE: Mouse, never moves
+    for(u32 i = 0; i < MOUSE_BUTTON_COUNT; ++i) {
+        update_button_state(get_mouse_button_state(input, (mouse_button)i), false);
+    }
+    input->mouse_input = false;
+    input->mouse_last = input->mouse;
+    input->mouse_moved = false;
+    input->scroll_move = 0;
+    
+    // NOTE: time
+    ++input->frames_elapsed;
+    input->delta_time = params->delta_time;
+    input->time_elapsed += params->delta_time;
+}
+
+static kb_key
+get_kb_key_from_name(const char *name) {
+    for(u32 i = 0; i < KB_KEY_COUNT; ++i) {
+        if(compare_strings(name, kb_key_names[i])) {
+            return (kb_key)i;
+        }
+    }
+    return ((kb_key)-1);
+}
+
+static bool
+parse_headless_params(HeadlessParams *params, i32 argc, char **argv) {
+    *params = {};
+    params->delta_time = 1.0f / 60.0f;
+    params->hotload = true;
+    
+    for(i32 i = 1; i < argc; ++i) {
+        char *arg = argv[i];
+        bool has_value = (i + 1) < argc;
+        if(compare_strings(arg, "-frames") && has_value) {
+            params->frame_count = (u32)atoi(argv[++i]);
+        }
+        else if(compare_strings(arg, "-dt") && has_value) {
+            params->delta_time = (f32)atof(argv[++i]);
+        }
+        else if(compare_strings(arg, "-renderer") && has_value) {
+            params->software = compare_strings(argv[++i], "software");
+            if(!params->software && !compare_strings(argv[i], "null")) {
+                linux_log("bad -renderer '%s'...\n", argv[i]);
+                return false;
+            }
+        }
+        else if(compare_strings(arg, "-capture") && (i + 2) < argc) {
+            const char *format = argv[++i];
+            params->capture_path = argv[++i];
+            params->capture = compare_strings(format, "png") ? CAPTURE_png : (compare_strings(format, "raw") ? CAPTURE_raw : CAPTURE_none);
+            if(params->capture == CAPTURE_none) {
+                linux_log("bad -capture format '%s'...\n", format);
+                return false;
+            }
+        }
+        else if(compare_strings(arg, "-no_hotload")) {
+            params->hotload = false;
+        }
+        else if(compare_strings(arg, "-press") && (i + 2) < argc) {
+            kb_key key = get_kb_key_from_name(argv[i + 1]);
+            if(key == (kb_key)-1 || params->press_count >= HEADLESS_MAX_PRESSES) {
+                linux_log("bad -press '%s'...\n", argv[i + 1]);
+                return false;
+            }
+            
+            HeadlessPress *press = params->presses + params->press_count++;
+            press->key = key;
+            press->frame = (u32)atoi(argv[i + 2]);
+            press->frame_count = 1;
+            i += 2;
+            if((i + 1) < argc && argv[i + 1][0] != '-') {
+                press->frame_count = max_value((u32)atoi(argv[++i]), 1);
+            }
+        }
+        else {
+            linux_log("usage: %s [-frames count] [-dt seconds] [-press key frame [frames]]... [-renderer null|software] [-capture png|raw path] [-no_hotload]\n", argv[0]);
+            return false;
+        }
+    }
+    
+    // NOTE: the null renderer has nothing to read back
+    if(params->capture && !params->software) {
+        linux_log("-capture needs -renderer software...\n");
+        return false;
+    }
+    return true;
+}
+
+static GameMemory
+get_memory(MemoryAllocationParams *params) {
+    GameMemory memory = {};
+    memory.permanent_memory.size = params->permanent_memory_size;
+    memory.permanent_memory.ptr = (byte *)malloc(params->permanent_memory_size);
+    memory.temporary_memory.size = params->temporary_memory_size;
+    memory.temporary_memory.ptr = (byte *)malloc(params->temporary_memory_size);
+    if(memory.permanent_memory.ptr && memory.temporary_memory.ptr) {
+        memory.allocated = true;
+        zero_memory(memory.permanent_memory.ptr, memory.permanent_memory.size);
+        zero_memory(memory.temporary_memory.ptr, memory.temporary_memory.size);
+    }
+    return memory;
+}
+
+int main(int argc, char **argv) {
+    HeadlessParams headless;
+    if(!parse_headless_params(&headless, argc, argv)) {
+        return -1;
+    }
+    set_working_directory();
+    
+    PlatformProcs procs = {
+        (alloc_memory_proc *)alloc_memory,
+        (realloc_memory_proc *)realloc_memory,
+        (free_memory_proc *)free_memory,
+        (read_file_proc *)read_file,
+        (free_file_proc *)free_file,
+        (write_file_proc *)write_file,
+        (last_write_time_proc *)last_write_time,
+        (map_file_proc *)map_file,
+        (unmap_file_proc *)unmap_file,
+        (create_sound_proc *)create_sound,
+        (delete_sound_proc *)delete_sound,
+        (play_sound_proc *)play_sound,
+        (add_work_entry_proc *)add_work_entry,
+        (complete_all_work_proc *)complete_all_work,
+        (get_wall_clock_proc *)get_wall_clock,
+    };
+    
+    static PlatformWorkQueue work_queue = {};
+    init_work_queue(&work_queue, get_worker_thread_count());
+    
+    GameSO game_so = load_game_so();
+    if(!game_so.loaded) {
+        linux_log("couldn't load the game so...\n");
+        return -1;
+    }
+    StartupParams startup = game_so.get_startup_params(&procs);
+    
+    GameMemory memory = get_memory(&startup.memory);
+    if(!memory.allocated) {
+        linux_log("couldn't allocate memory...\n");
+        return -1;
+    }
+    
+    // NOTE: the window the game asked for, it just never shows up
+    WindowState window = startup.window;
+    window.width  = startup.window.window_width;
+    window.height = startup.window.window_height;
+    window.is_focused = true;
+    window.fullscreen = false;
+    
+    RendererAPI api = {};
+    if(headless.software) {
+        get_software_renderer_api(&api, &procs, &work_queue, work_queue.thread_count);
+        software_resize_backbuffer(window.width, window.height);
+    }
+    else {
+        get_null_renderer_api(&api);
+    }
+    ASSERT(is_renderer_api_valid(&api), "invalid renderer api\nprobably missing procs...\n");
+    
+    Renderer renderer = {};
+    init_renderer(&renderer, &api, &procs);
+    
+    Core core = {
+        &renderer,
+        &memory,
+        &window,
+        &procs,
+        &work_queue
+    };
+    
+    bool initialized = game_so.game_init(&core);
+    if(!initialized) {
+        linux_log("couldn't initialize the game...\n");
+        return -1;
+    }
+    
+    static Capture capture = {};
+    if(headless.capture && !init_capture(&capture, headless.capture, headless.capture_path, 1.0f / headless.delta_time)) {
+        return -1;
+    }
+    
+    Input input = {};
+    f64 start_time = get_wall_clock();
+    f64 last_hotload_check = start_time;
+    game_so.size_callback(&core, window.width, window.height);
+    while(!headless.frame_count || input.frames_elapsed < headless.frame_count) {
+        // NOTE: stat-ing the so every frame would be most of a headless frame
+        if(headless.hotload && (get_wall_clock() - last_hotload_check) >= HEADLESS_HOTLOAD_SECONDS) {
+            last_hotload_check = get_wall_clock();
+            hotload_game_so(&game_so, &core);
+        }
+        get_headless_input(&input, &headless);
+        
+        begin_renderer_frame(&renderer);
+        if(game_so.game_frame) {
+            bool do_not_quit = game_so.game_frame(&core, &input);
+            if(!do_not_quit) {
+                break;
+            }
+        }
+        
+        // NOTE: the backbuffer holds the composited frame, before the size change below reallocates it
+        if(headless.capture) {
+            capture_frame(&capture, &api, input.frames_elapsed - 1, window.width, window.height);
+            if((get_wall_clock() - capture.report_time) >= CAPTURE_REPORT_SECONDS) {
+                report_capture(&capture, input.frames_elapsed);
+            }
+        }
+        
+        if(window.window_width != window.width || window.window_height != window.height) {
+            window.width  = window.window_width;
+            window.height = window.window_height;
+            if(headless.software) {
+                software_resize_backbuffer(window.width, window.height);
+            }
+            game_so.size_callback(&core, window.width, window.height);
+        }
+    }
+    
+    f64 seconds = get_wall_clock() - start_time;
+    linux_log("%u frames in %.3fs, %.0f frames/s\n", input.frames_elapsed, seconds,
+              (seconds > 0.0) ? (f64)input.frames_elapsed / seconds : 0.0);
+    if(headless.capture) {
+        finish_capture(&capture);
+    }
+    
+    unload_game_so(&game_so);
+    if(file_exists(so_temp_path)) {
+        delete_file(so_temp_path);
+    }
+    
+    return 0;
+}
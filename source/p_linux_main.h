@@ -0,0 +1,145 @@
+#ifndef P_LINUX_MAIN_H
+#define P_LINUX_MAIN_H
+
+#define linux_log(str, ...) printf("linux: " str, ##__VA_ARGS__)
+
+// NOTE: p_platform_common.h -> kb_key, names for -press
+const static char *kb_key_names[KB_KEY_COUNT] = {
+    "up",
+    "down",
+    "left",
+    "right",
+    
+    "esc", "space",
+    "enter",
+    
+    "left_shift",
+    "left_ctrl",
+    
+    "page_up", "page_down",
+    "home",
+    
+    "minus", "equal",
+    
+    "f1",  "f2",  "f3",
+    "f4",  "f5",  "f6",
+    "f7",  "f8",  "f9",
+    "f10", "f11", "f12",
+    
+    "q", "w", "e", "r",
+    "t", "y", "u", "i",
+    "o", "p", "a", "s",
+    "d", "f", "g", "h",
+    "j", "k", "l", "z",
+    "x", "c", "v", "b",
+    "n", "m",
+};
+
+const char *so_path      = "./p_game.so";
+const char *so_temp_path = "./p_game_temp.so";
+const char *so_lock_file = "p_game_so.lock";
+
+struct GameSO {
+    b32 loaded;
+    void *module;
+    PTime last_write_time;
+    
+    game_init_proc               *game_init;
+    game_frame_proc              *game_frame;
+    game_size_callback_proc      *size_callback;
+    game_hotload_callback_proc   *hotload_callback;
+    game_get_startup_params_proc *get_startup_params;
+};
+
+struct PlatformWorkQueueEntry {
+    platform_work_queue_callback *callback;
+    void *data;
+};
+
+// NOTE: single producer (game thread), many consumers (worker threads)
+struct PlatformWorkQueue {
+    u32 volatile completion_goal;
+    u32 volatile completion_count;
+    u32 volatile next_entry_to_write;
+    u32 volatile next_entry_to_read;
+    sem_t semaphore;
+    
+    u32 thread_count;
+    PlatformWorkQueueEntry entries[256];
+};
+
+enum capture_format {
+    CAPTURE_none,
+    CAPTURE_png, // NOTE: one file per frame, 'path'_00000.png
+    CAPTURE_raw, // NOTE: every frame appended to 'path', top row first RGBA8. A frame of another
+                 // size starts a new file, 'path'.1, 'path'.2 and so on
+};
+
+struct CaptureFrame {
+    u32 frame;
+    i32 width;
+    i32 height;
+    u32 size;
+    u8 *pixels;
+};
+
+#define CAPTURE_QUEUE_SIZE 8
+#define CAPTURE_REPORT_SECONDS 5.0
+
+// NOTE: single producer (game thread), single consumer (writer thread). When the writer
+// falls behind the queue fills up and new frames are dropped instead of waiting for it.
+struct Capture {
+    capture_format format;
+    const char *path;
+    f32 frame_rate;
+    
+    // NOTE: the raw file being written and the one frame size in it, owned by the writer thread
+    FILE *raw_file;
+    char raw_path[512];
+    u32  raw_part;
+    i32  raw_width;
+    i32  raw_height;
+    u32  raw_frames;
+    
+    u32 volatile next_frame_to_write;
+    u32 volatile next_frame_to_read;
+    b32 volatile quit;
+    sem_t semaphore;
+    pthread_t thread;
+    CaptureFrame frames[CAPTURE_QUEUE_SIZE];
+    
+    u32 captured_count;
+    u32 dropped_count;
+    u32 volatile written_count;
+    u32 volatile failed_count;
+    
+    // NOTE: see report_capture
+    f64 report_time;
+    u32 report_frame;
+    u32 report_dropped;
+};
+
+// NOTE: the key is held down from 'frame' for 'frame_count' frames
+struct HeadlessPress {
+    kb_key key;
+    u32 frame;
+    u32 frame_count;
+};
+
+#define HEADLESS_MAX_PRESSES 64
+#define HEADLESS_HOTLOAD_SECONDS 1.0
+
+// NOTE: no window, the game runs on a fixed 'delta_time' as fast as it can
+struct HeadlessParams {
+    u32 frame_count; // NOTE: 0 runs until the game quits
+    f32 delta_time;
+    bool hotload;
+    bool software; // NOTE: -renderer software draws on the cpu, the null renderer is the default
+    capture_format capture;
+    const char *capture_path;
+    
+    u32 press_count;
+    HeadlessPress presses[HEADLESS_MAX_PRESSES];
+};
+
+#endif /* P_LINUX_MAIN_H */
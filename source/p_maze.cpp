@@ -0,0 +1,310 @@
+// NOTE: path halving, good enough without union by rank for these sizes
+static u32
+find_maze_root(u32 *parent, u32 index) {
+    while(parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+// NOTE: both wall codes are odd
+inline bool
+is_maze_wall(u8 cell) {
+    return (cell & 1);
+}
+
+inline bool
+maze_chance(random_seed *random, f32 chance) {
+    return ((f32)(rand_u32(random) & 0xffffff) / 16777216.0f) < chance;
+}
+
+// NOTE: 'scratch' has a u32 per tile
+static void
+generate_wall_pattern(u8 *cells, u32 width, u32 height, u32 pattern, f32 density, u32 *scratch, random_seed *random) {
+    switch(pattern) {
+        case WALLS_scatter: {
+            for(u32 i = 0; i < width * height; ++i) {
+                if(cells[i] == MAZE_free && maze_chance(random, density)) {
+                    cells[i] = MAZE_wall;
+                }
+            }
+        } break;
+        
+        case WALLS_blocks: {
+            for(u32 y = 0; (y + 1) < height; y += 2) {
+                for(u32 x = 0; (x + 1) < width; x += 2) {
+                    u8 *block[4] = {
+                        cells + y * width + x,       cells + y * width + x + 1,
+                        cells + (y + 1) * width + x, cells + (y + 1) * width + x + 1
+                    };
+                    if(!maze_chance(random, density) ||
+                       *block[0] == MAZE_keep || *block[1] == MAZE_keep || *block[2] == MAZE_keep || *block[3] == MAZE_keep) {
+                        continue;
+                    }
+                    
+                    for(u32 i = 0; i < size_array(block); ++i) {
+                        if(*block[i] == MAZE_free) {
+                            *block[i] = MAZE_wall;
+                        }
+                    }
+                }
+            }
+        } break;
+        
+        case WALLS_maze: {
+            // NOTE: maze cells are the tiles with both coordinates even, everything between them
+            // starts as a wall. An even size leaves the last row or column out of the maze, open.
+            u32 maze_w = (width  & 1) ? width  : width  - 1;
+            u32 maze_h = (height & 1) ? height : height - 1;
+            u32 cells_w = (maze_w + 1) / 2;
+            u32 cells_h = (maze_h + 1) / 2;
+            u32 *parent = scratch;
+            u32 *edges  = scratch + cells_w * cells_h;
+            u32 edge_count = 0;
+            
+            for(u32 i = 0; i < cells_w * cells_h; ++i) {
+                parent[i] = i;
+            }
+            
+            for(u32 y = 0; y < maze_h; ++y) {
+                for(u32 x = 0; x < maze_w; ++x) {
+                    u32 index = y * width + x;
+                    if(!((x | y) & 1)) {
+                        continue;
+                    }
+                    
+                    if(cells[index] == MAZE_free) {
+                        cells[index] = MAZE_wall;
+                    }
+                    if(((x ^ y) & 1) && cells[index] != MAZE_level_wall) {
+                        edges[edge_count++] = index;
+                    }
+                }
+            }
+            
+            for(u32 i = edge_count; i > 1; --i) {
+                u32 j = rand_u32(random) % i;
+                u32 swap = edges[i - 1];
+                edges[i - 1] = edges[j];
+                edges[j] = swap;
+            }
+            
+            // NOTE: Kruskal, the edges that would close a loop are kept at the front for braiding
+            u32 loop_count = 0;
+            for(u32 i = 0; i < edge_count; ++i) {
+                u32 index = edges[i];
+                u32 x = index % width;
+                u32 y = index / width;
+                u32 a = (y / 2) * cells_w + (x / 2);
+                u32 b = (x & 1) ? (a + 1) : (a + cells_w);
+                
+                u32 root_a = find_maze_root(parent, a);
+                u32 root_b = find_maze_root(parent, b);
+                if(root_a != root_b) {
+                    parent[root_a] = root_b;
+                    if(cells[index] == MAZE_wall) {
+                        cells[index] = MAZE_free;
+                    }
+                }
+                else {
+                    edges[loop_count++] = index;
+                }
+            }
+            
+            u32 wall_count = 0;
+            for(u32 i = 0; i < width * height; ++i) {
+                wall_count += is_maze_wall(cells[i]);
+            }
+            
+            u32 target = (u32)(density * (f32)(width * height));
+            for(u32 i = 0; i < loop_count && wall_count > target; ++i) {
+                if(cells[edges[i]] == MAZE_wall) {
+                    cells[edges[i]] = MAZE_free;
+                    --wall_count;
+                }
+            }
+        } break;
+    }
+}
+
+inline void
+union_maze_roots(u32 *parent, u32 a, u32 b) {
+    u32 root_a = find_maze_root(parent, a);
+    u32 root_b = find_maze_root(parent, b);
+    if(root_a != root_b) {
+        parent[root_a] = root_b;
+    }
+}
+
+// NOTE: unions the overlapping free tiles of two rows, once per stretch of overlap
+static void
+union_maze_rows(u8 *cells, u32 width, u32 *parent, u32 row, u32 next_row) {
+    for(u32 x = 0; x < width; ++x) {
+        u32 a = row + x;
+        u32 b = next_row + x;
+        if(is_maze_wall(cells[a]) || is_maze_wall(cells[b])) {
+            continue;
+        }
+        if(x == 0 || is_maze_wall(cells[a - 1]) || is_maze_wall(cells[b - 1])) {
+            union_maze_roots(parent, a, b);
+        }
+    }
+}
+
+// NOTE: every run of free tiles in a row is one set from the start, its tiles point at the run's
+// first tile, so only the runs get unioned. Whatever doesn't end up with the spawn's root
+// becomes a wall, returns how many were sealed.
+static u32
+seal_unreachable_cells(u8 *cells, u32 width, u32 height, bool looping, u32 spawn, u32 *parent) {
+    for(u32 y = 0; y < height; ++y) {
+        u32 row = y * width;
+        u32 run = U32_MAX;
+        for(u32 x = 0; x < width; ++x) {
+            if(is_maze_wall(cells[row + x])) {
+                run = U32_MAX;
+                continue;
+            }
+            if(run == U32_MAX) {
+                run = row + x;
+            }
+            parent[row + x] = run;
+        }
+        
+        if(looping && width > 1 && !is_maze_wall(cells[row]) && !is_maze_wall(cells[row + width - 1])) {
+            union_maze_roots(parent, row, row + width - 1);
+        }
+        if(y > 0) {
+            union_maze_rows(cells, width, parent, row - width, row);
+        }
+    }
+    if(looping && height > 1) {
+        union_maze_rows(cells, width, parent, (height - 1) * width, 0);
+    }
+    
+    u32 sealed = 0;
+    u32 spawn_root = find_maze_root(parent, spawn);
+    for(u32 y = 0; y < height; ++y) {
+        // NOTE: one find per run, the rest of the run follows its first tile
+        bool sealing = false;
+        for(u32 i = y * width; i < (y + 1) * width; ++i) {
+            if(is_maze_wall(cells[i])) {
+                continue;
+            }
+            if(i == y * width || is_maze_wall(cells[i - 1])) {
+                sealing = (find_maze_root(parent, i) != spawn_root);
+            }
+            
+            if(sealing && cells[i] == MAZE_free) {
+                cells[i] = MAZE_wall;
+                ++sealed;
+            }
+        }
+    }
+    return sealed;
+}
+
+// NOTE: runs on a made level, after the snake and before the apple, returns the walls added.
+// Every chunk is taken before the grid is pushed on the level's chunk arena, so set_tile
+// never pushes a chunk above the grid, the chunks that stay empty are released after.
+static u32
+generate_level_walls(Level *level) {
+    u32 pattern = level->params.wall_pattern;
+    if(pattern == WALLS_none || pattern >= WALLS_COUNT) {
+        return 0;
+    }
+    
+    MemoryArena *arena = level->chunk_arena;
+    u32 tiles = level->width * level->height;
+    u32 chunk_total = level->chunks_x * level->chunks_y;
+    u32 needed  = tiles + tiles * sizeof(u32) + 16;
+    u32 reserve = (chunk_total - level->chunk_count) * sizeof(LevelChunk);
+    if(tiles > MAZE_MAX_TILES || (arena->size - arena->used) < (u64)needed + reserve) {
+        game_log("walls: level is too big to generate %s walls...\n", wall_pattern_names[pattern]);
+        return 0;
+    }
+    
+    for(u32 chunk_index = 0; chunk_index < chunk_total; ++chunk_index) {
+        if(!level->chunks[chunk_index]) {
+            acquire_level_chunk(level, chunk_index);
+        }
+    }
+    
+    TemporaryMemory scratch = begin_temporary_memory(arena);
+    u8  *cells  = push_array(arena, u8, tiles);
+    u32 *parent = push_array_aligned(arena, u32, tiles, sizeof(u32));
+    zero_memory(cells, tiles);
+    
+    // NOTE: walls stay, anything else already on the level is kept free
+    for(u32 chunk_index = 0; chunk_index < chunk_total; ++chunk_index) {
+        LevelChunk *chunk = level->chunks[chunk_index];
+        if(!chunk) {
+            continue;
+        }
+        
+        u32 x0 = (chunk_index % level->chunks_x) << LEVEL_CHUNK_SHIFT;
+        u32 y0 = (chunk_index / level->chunks_x) << LEVEL_CHUNK_SHIFT;
+        u32 chunk_w = min_value(LEVEL_CHUNK_SIZE, level->width  - x0);
+        u32 chunk_h = min_value(LEVEL_CHUNK_SIZE, level->height - y0);
+        for(u32 y = 0; y < chunk_h; ++y) {
+            for(u32 x = 0; x < chunk_w; ++x) {
+                tile_type type = get_chunk_tile(chunk, (y << LEVEL_CHUNK_SHIFT) | x);
+                if(type != TILE_none) {
+                    cells[(y0 + y) * level->width + x0 + x] = (type == TILE_wall) ? MAZE_level_wall : MAZE_keep;
+                }
+            }
+        }
+    }
+    
+    u32 spawn = MAZE_NO_ROOT;
+    if(level->snake_count) {
+        vec2i pos = level->snake_head;
+        vec2i dir = dir_to_vec2i(get_snake_dir(level, 0));
+        spawn = pos.y * level->width + pos.x;
+        for(u32 i = 0; i < MAZE_CLEARANCE; ++i) {
+            pos += dir;
+            if(level->looping) {
+                pos.x = (pos.x + (i32)level->width)  % (i32)level->width;
+                pos.y = (pos.y + (i32)level->height) % (i32)level->height;
+            }
+            else if(!is_in_bounds(pos.x, 0, (i32)(level->width - 1)) || !is_in_bounds(pos.y, 0, (i32)(level->height - 1))) {
+                break;
+            }
+            
+            u8 *cell = cells + pos.y * level->width + pos.x;
+            if(*cell == MAZE_level_wall) {
+                break;
+            }
+            *cell = MAZE_keep;
+        }
+    }
+    
+    generate_wall_pattern(cells, level->width, level->height, pattern, level->params.wall_density, parent, &level->random);
+    
+    // NOTE: no snake, the first free tile decides which part of the level stays
+    for(u32 i = 0; i < tiles && spawn == MAZE_NO_ROOT; ++i) {
+        if(!is_maze_wall(cells[i])) {
+            spawn = i;
+        }
+    }
+    if(spawn != MAZE_NO_ROOT) {
+        seal_unreachable_cells(cells, level->width, level->height, level->looping, spawn, parent);
+    }
+    
+    u32 added = 0;
+    for(u32 i = 0; i < tiles; ++i) {
+        if(cells[i] == MAZE_wall) {
+            set_tile(level, i % level->width, i / level->width, TILE_wall);
+            ++added;
+        }
+    }
+    end_temporary_memory(scratch);
+    
+    for(u32 chunk_index = 0; chunk_index < chunk_total; ++chunk_index) {
+        LevelChunk *chunk = level->chunks[chunk_index];
+        if(chunk && chunk->free_count == chunk->tile_count) {
+            release_level_chunk(level, chunk_index);
+        }
+    }
+    return added;
+}
@@ -0,0 +1,40 @@
+#ifndef P_MAZE_H
+#define P_MAZE_H
+
+// NOTE: procedural walls for fresh boards. The pattern is laid down on a byte grid, then one
+// union-find pass over the free tiles finds everything connected to the snake's head and the
+// rest is sealed with walls, so every free tile of the level can be reached. Density is the
+// share of the level's tiles the pattern tries to turn into walls, sealing can add more.
+
+enum wall_pattern {
+    WALLS_none,
+    WALLS_scatter, // NOTE: single walls, each tile with 'density' chance
+    WALLS_blocks,  // NOTE: 2x2 blocks on even tiles, the free tiles keep their 2x2 grid for the cycle
+    WALLS_maze,    // NOTE: Kruskal maze on even tiles, braided until it's down to 'density', 0.25 at least
+    
+    WALLS_COUNT
+};
+
+enum maze_cell {
+    MAZE_free,
+    MAZE_wall,
+    MAZE_keep,       // NOTE: stays free whatever the pattern says, the snake and the tiles ahead of it
+    MAZE_level_wall, // NOTE: was a wall before the pattern, left alone
+};
+
+#define MAZE_MAX_TILES  LEVEL_MAX_BITBOARD_TILES
+#define MAZE_CLEARANCE  3 // NOTE: free tiles ahead of the head
+#define MAZE_NO_ROOT    U32_MAX
+
+static const char *wall_pattern_names[WALLS_COUNT] = { "none", "scatter", "blocks", "maze" };
+
+static u32   find_maze_root(u32 *parent, u32 index);
+inline bool  is_maze_wall(u8 cell);
+inline bool  maze_chance(random_seed *random, f32 chance);
+static void  generate_wall_pattern(u8 *cells, u32 width, u32 height, u32 pattern, f32 density, u32 *scratch, random_seed *random);
+inline void  union_maze_roots(u32 *parent, u32 a, u32 b);
+static void  union_maze_rows(u8 *cells, u32 width, u32 *parent, u32 row, u32 next_row);
+static u32   seal_unreachable_cells(u8 *cells, u32 width, u32 height, bool looping, u32 spawn, u32 *parent);
+static u32   generate_level_walls(Level *level);
+
+#endif /* P_MAZE_H */
@@ -0,0 +1,266 @@
+static MctsAgent
+make_mcts_agent(u32 width, u32 height, u32 max_nodes, MemoryArena *arena) {
+    MctsAgent agent = {};
+    SimParams params = {};
+    params.width  = width;
+    params.height = height;
+    agent.root = push_sim_batch(params, 1, arena);
+    for(u32 i = 0; i < MCTS_MAX_WORKERS; ++i) {
+        push_memory_aligned_(arena, 0, MCTS_CACHE_LINE);
+        agent.workers[i] = push_sim_batch(params, 1, arena);
+    }
+    agent.nodes = push_array_aligned(arena, MctsNode, max_nodes, MCTS_CACHE_LINE);
+    agent.max_nodes = max_nodes;
+    return agent;
+}
+
+static void
+load_mcts_root(MctsAgent *agent, Level *level) {
+    SimBatch *batch = &agent->root;
+    ASSERT(batch->params.width == level->width && batch->params.height == level->height, "mcts agent size mismatch");
+    batch->params.looping = level->looping;
+    for(u32 i = 0; i < MCTS_MAX_WORKERS; ++i) {
+        agent->workers[i].params.looping = level->looping;
+    }
+    
+    for(u32 i = 0; i < batch->cells; ++i) {
+        switch(get_tile(level, i % level->width, i / level->width).type) {
+            case TILE_wall:  { batch->board[i] = SIM_CELL_wall;  } break;
+            case TILE_apple: { batch->board[i] = SIM_CELL_apple; } break;
+            case TILE_snake: { batch->board[i] = SIM_CELL_snake; } break;
+            default:         { batch->board[i] = SIM_CELL_empty; } break;
+        }
+    }
+    
+    // NOTE: sim links go tail -> head, each one is the direction of the part it leads into
+    for(u32 i = 0; (i + 1) < level->snake_count; ++i) {
+        batch->body[i] = (u8)get_snake_dir(level, level->snake_count - 2 - i);
+    }
+    
+    batch->head[0]       = level->snake_head.y * level->width + level->snake_head.x;
+    batch->tail[0]       = level->snake_tail.y * level->width + level->snake_tail.x;
+    batch->body_first[0] = 0;
+    batch->length[0]     = level->snake_count;
+    batch->grow[0]       = level->add_snake_parts;
+    batch->score[0]      = level->score;
+    batch->apple[0]      = U32_MAX;
+    batch->games[0]      = 0;
+    batch->dir[0]        = (u8)get_snake_dir(level, 0);
+    batch->status[0]     = SIM_alive;
+    batch->random[0]     = 1;
+    if(level->apple_pos.x != -1 && level->apple_pos.y != -1) {
+        batch->apple[0] = level->apple_pos.y * level->width + level->apple_pos.x;
+    }
+}
+
+inline bool
+mcts_safe_dir(SimBatch *batch, u32 dir) {
+    u32 next_cell;
+    if(!sim_step_cell(&batch->params, batch->head[0], dir, &next_cell)) {
+        return false;
+    }
+    
+    u8 cell = batch->board[next_cell];
+    if(cell == SIM_CELL_snake) {
+        return (next_cell == batch->tail[0] && !batch->grow[0]);
+    }
+    return (cell != SIM_CELL_wall);
+}
+
+inline void
+mcts_tick(SimBatch *batch, u32 dir, f32 *reward, f32 *discount) {
+    u32 score = batch->score[0];
+    tick_sim_level(batch, 0, dir);
+    if(batch->score[0] != score) {
+        *reward += *discount;
+    }
+    
+    if(batch->status[0] == SIM_dead) {
+        *reward -= *discount * MCTS_DEATH_VALUE;
+    }
+    else if(batch->status[0] == SIM_won) {
+        *reward += *discount * MCTS_DEATH_VALUE;
+    }
+    *discount *= MCTS_DISCOUNT;
+}
+
+// NOTE: half of the rollout moves head for the apple, the rest are random, both avoid dying
+inline u32
+mcts_rollout_dir(SimBatch *batch, random_seed *random) {
+    u32 options[DIR_COUNT];
+    u32 option_count = 0;
+    u32 towards_apple = DIR_none;
+    u32 apple = batch->apple[0];
+    u32 head = batch->head[0];
+    for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+        if(dir == opposite_dir(batch->dir[0]) || !mcts_safe_dir(batch, dir)) {
+            continue;
+        }
+        options[option_count++] = dir;
+        
+        if(apple != U32_MAX) {
+            i32 dx = (i32)(apple % batch->params.width) - (i32)(head % batch->params.width);
+            i32 dy = (i32)(apple / batch->params.width) - (i32)(head / batch->params.width);
+            if((dir == DIR_right && dx > 0) || (dir == DIR_left && dx < 0) ||
+               (dir == DIR_up && dy > 0) || (dir == DIR_down && dy < 0)) {
+                towards_apple = dir;
+            }
+        }
+    }
+    
+    u32 bits = rand_u32(random);
+    if(towards_apple != DIR_none && (bits & 1)) {
+        return towards_apple;
+    }
+    if(!option_count) {
+        return batch->dir[0];
+    }
+    return options[(bits >> 1) % option_count];
+}
+
+static f32
+run_mcts_playout(MctsAgent *agent, u32 worker, random_seed *random) {
+    SimBatch *batch = agent->workers + worker;
+    copy_sim_level(batch, 0, &agent->root, 0);
+    batch->random[0] = rand_u64(random) | 1;
+    
+    u32 path[MCTS_MAX_DEPTH + 1];
+    u32 path_count = 0;
+    path[path_count++] = 0;
+    atomic_add_u32(&agent->nodes[0].virtual_loss, 1);
+    
+    f32 reward = 0.0f;
+    f32 discount = 1.0f;
+    
+    // NOTE: selection, stops right after a new node is added
+    bool expanded = false;
+    while(!expanded && path_count <= MCTS_MAX_DEPTH && batch->status[0] == SIM_alive) {
+        MctsNode *node = agent->nodes + path[path_count - 1];
+        f32 log_visits = logf((f32)(node->visits + node->virtual_loss) + 1.0f);
+        
+        u32 best_dir = DIR_none;
+        f32 best_uct = -1.0f;
+        for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+            if(dir == opposite_dir(batch->dir[0])) {
+                continue;
+            }
+            
+            f32 uct;
+            u32 child = node->children[dir];
+            if(!child) {
+                // NOTE: new moves go first, moves that die right away go last
+                uct = mcts_safe_dir(batch, dir) ? (2.0f + (f32)(rand_u32(random) & 0xff) / 256.0f) : 0.0f;
+            }
+            else {
+                MctsNode *child_node = agent->nodes + child;
+                f32 visits = (f32)max_value(child_node->visits + child_node->virtual_loss, 1);
+                f32 mean = ((f32)child_node->value / (f32)MCTS_VALUE_ONE) / visits;
+                uct = mean + MCTS_EXPLORATION * sqrtf(log_visits / visits);
+            }
+            
+            if(uct > best_uct) {
+                best_uct = uct;
+                best_dir = dir;
+            }
+        }
+        
+        u32 child = node->children[best_dir];
+        if(!child) {
+            child = atomic_add_u32(&agent->node_count, 1);
+            if(child >= agent->max_nodes) {
+                break;
+            }
+            zero_struct(agent->nodes + child);
+            
+            // NOTE: another work entry can add the same child first, this node is wasted then
+            u32 existing = atomic_compare_exchange_u32(&node->children[best_dir], 0, child);
+            if(existing) {
+                child = existing;
+            }
+            expanded = true;
+        }
+        
+        mcts_tick(batch, best_dir, &reward, &discount);
+        path[path_count++] = child;
+        atomic_add_u32(&agent->nodes[child].virtual_loss, 1);
+    }
+    
+    for(u32 tick = 0; tick < MCTS_ROLLOUT_TICKS && batch->status[0] == SIM_alive; ++tick) {
+        mcts_tick(batch, mcts_rollout_dir(batch, random), &reward, &discount);
+    }
+    
+    f32 value = clamp(0.5f + reward * 0.25f, 0.0f, 1.0f);
+    u64 fixed_value = (u64)(value * MCTS_VALUE_ONE);
+    for(u32 i = 0; i < path_count; ++i) {
+        MctsNode *node = agent->nodes + path[i];
+        atomic_add_u64(&node->value, fixed_value);
+        atomic_add_u32(&node->visits, 1);
+        atomic_add_u32(&node->virtual_loss, (u32)-1);
+    }
+    return value;
+}
+
+static PLATFORM_WORK_QUEUE_CALLBACK(mcts_work) {
+    MctsWork *work = (MctsWork *)data;
+    MctsAgent *agent = work->agent;
+    u32 playouts = 0;
+    while(atomic_add_u32(&agent->playouts_started, 1) < agent->playout_count) {
+        run_mcts_playout(agent, work->worker, &work->random);
+        ++playouts;
+    }
+    work->playouts = playouts;
+}
+
+static MctsResult
+run_mcts(MctsAgent *agent, Level *level, u32 playouts, random_seed seed, PlatformProcs *procs, PlatformWorkQueue *queue) {
+    MctsResult result = {};
+    load_mcts_root(agent, level);
+    zero_struct(agent->nodes);
+    agent->node_count = 1;
+    agent->playout_count = playouts;
+    agent->playouts_started = 0;
+    
+    u32 work_count = (queue && procs->add_work_entry) ? MCTS_MAX_WORKERS : 1;
+    MctsWork works[MCTS_MAX_WORKERS];
+    for(u32 i = 0; i < work_count; ++i) {
+        works[i].agent = agent;
+        works[i].worker = i;
+        works[i].playouts = 0;
+        works[i].random = seed + (u64)(i + 1) * 0x9E3779B97F4A7C15ull;
+        if(works[i].random == 0) { works[i].random = 1; }
+    }
+    
+    f64 start = procs->get_wall_clock();
+    if(work_count > 1) {
+        for(u32 i = 0; i < work_count; ++i) {
+            procs->add_work_entry(queue, mcts_work, works + i);
+        }
+        procs->complete_all_work(queue);
+    }
+    else {
+        mcts_work(queue, works);
+    }
+    result.seconds = procs->get_wall_clock() - start;
+    
+    for(u32 i = 0; i < work_count; ++i) {
+        result.playouts += works[i].playouts;
+    }
+    result.nodes = clamp_max(agent->node_count, agent->max_nodes);
+    if(result.seconds > 0.0) {
+        result.playouts_per_second = (f64)result.playouts / result.seconds;
+    }
+    
+    // NOTE: most visited move from the root
+    MctsNode *root = agent->nodes;
+    u32 best_visits = 0;
+    result.dir = agent->root.dir[0];
+    for(u32 dir = 0; dir < DIR_COUNT; ++dir) {
+        u32 child = root->children[dir];
+        if(child && agent->nodes[child].visits > best_visits) {
+            best_visits = agent->nodes[child].visits;
+            result.dir = dir;
+            result.value = ((f32)agent->nodes[child].value / (f32)MCTS_VALUE_ONE) / (f32)best_visits;
+        }
+    }
+    return result;
+}
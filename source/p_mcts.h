@@ -0,0 +1,61 @@
+#ifndef P_MCTS_H
+#define P_MCTS_H
+
+// NOTE: Monte Carlo tree search on the sim rules. Playouts run on a copy of the root
+// in the work entry's own SimBatch, the tree is shared between the work entries
+// and updated with atomics, virtual loss keeps them off each other's paths. Nothing in here touches game_data, the renderer or level_arena.
+// The tree is open loop, nodes are keyed by moves only, so apple spawns are part of the noise.
+
+#define MCTS_MAX_WORKERS  16
+#define MCTS_MAX_DEPTH    32
+#define MCTS_ROLLOUT_TICKS 64
+#define MCTS_VALUE_ONE    65536 // NOTE: fixed point for the summed values
+#define MCTS_EXPLORATION  0.7f
+#define MCTS_DISCOUNT     0.97f
+#define MCTS_DEATH_VALUE  2.0f
+#define MCTS_AUTOPILOT_PLAYOUTS 2048
+#define MCTS_AUTOPILOT_NODES    (1 << 15)
+#define MCTS_CACHE_LINE 64
+
+struct MctsNode {
+    u32 volatile visits;
+    u32 volatile virtual_loss; // NOTE: playouts that went through but haven't come back yet
+    u64 volatile value;
+    u32 volatile children[DIR_COUNT]; // NOTE: 0 is no child, the root is never a child
+};
+
+struct MctsAgent {
+    // NOTE: one batch per work entry so they don't share cache lines
+    SimBatch root;
+    SimBatch workers[MCTS_MAX_WORKERS];
+    
+    MctsNode *nodes;
+    u32 max_nodes;
+    u32 volatile node_count;
+    
+    u32 playout_count;
+    u32 volatile playouts_started;
+};
+
+struct MctsWork {
+    MctsAgent *agent;
+    u32 worker;
+    u32 playouts;
+    random_seed random;
+};
+
+struct MctsResult {
+    u32 dir;
+    u32 playouts;
+    u32 nodes;
+    f32 value;
+    f64 seconds;
+    f64 playouts_per_second;
+};
+
+static MctsAgent  make_mcts_agent(u32 width, u32 height, u32 max_nodes, MemoryArena *arena);
+static void       load_mcts_root(MctsAgent *agent, Level *level);
+static f32        run_mcts_playout(MctsAgent *agent, u32 worker, random_seed *random);
+static MctsResult run_mcts(MctsAgent *agent, Level *level, u32 playouts, random_seed seed, PlatformProcs *procs, PlatformWorkQueue *queue);
+
+#endif /* P_MCTS_H */
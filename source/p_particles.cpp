@@ -153,10 +153,10 @@ value = pair.value0;\
             
             if(params->texture_count) {
                 if(params->texture_count == 1) {
-                    p->tex = params->textures[0];
+                    p->tex = &params->textures[0];
                 }
                 else {
-                    p->tex = params->textures[rand_u32_in_range(&particles->random, 0, params->texture_count - 1)];
+                    p->tex = &params->textures[rand_u32_in_range(&particles->random, 0, params->texture_count - 1)];
                 }
             }
             else {
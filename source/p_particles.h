@@ -3,7 +3,7 @@
 
 struct Particle {
     bool is_alive;
-    Texture2D *tex;
+    TextureRegion *tex;
     vec2 position;
     vec2 size;
     vec2 desired_size;
@@ -57,10 +57,10 @@ struct PSystemParams {
     };
     
     u32 texture_count;
-    Texture2D *textures[4];
+    TextureRegion textures[4];
     
-    void add_texture(Texture2D *tex) {
-        textures[texture_count++] = tex;
+    void add_texture(TextureRegion region) {
+        textures[texture_count++] = region;
     }
     
     void no_textures(void) {
@@ -15,14 +15,14 @@ MessageBoxA(0, __buffer, "assertion failed", 0x00000000L);\
 }\
 }
 #else
-#define ASSERT(exp, str, ...) { if(!(exp)) { printf(str, __VA_ARGS__); } assert((exp)); }
+#define ASSERT(exp, str, ...) { if(!(exp)) { printf(str, ##__VA_ARGS__); } assert((exp)); }
 #endif
 
 #define P_MATH_IMPLEMENTATION
 #include "p_math.h"
 
 #define DATA_DIR_PATH "../data/"
-#define DATA_DIR(file_name) DATA_DIR_PATH##file_name
+#define DATA_DIR(file_name) DATA_DIR_PATH file_name
 
 #define zero_memory(m,s) (memset(m, 0, s))
 #define zero_array(a,t) memset(a, 0, size_array(a) * sizeof(t))
@@ -45,7 +45,7 @@ MessageBoxA(0, __buffer, "assertion failed", 0x00000000L);\
 #define print_bool(v) printf("%s = %s\n",#v,v?"true":"false")
 #define print_ptr(v)  printf("%s = %p\n",#v,v)
 #define print_cstr(v) printf("%s = %s\n",#v,v)
-#define print_cstr_len(v,n) printf("%s = %.*s"##" | len = %d\n",#v,n,v,n)
+#define print_cstr_len(v,n) printf("%s = %.*s" " | len = %d\n",#v,n,v,n)
 #define print_char(v) printf("%s = %c\n",#v,v)
 #define print_new_line() printf("\n")
 
@@ -271,9 +271,25 @@ typedef READ_FILE_PROC(read_file_proc);
 #define FREE_FILE_PROC(name) void name(FileContents *file)
 typedef FREE_FILE_PROC(free_file_proc);
 
+#define WRITE_FILE_PROC(name) b32 name(const char *path, void *data, u32 size)
+typedef WRITE_FILE_PROC(write_file_proc);
+
 #define LAST_WRITE_TIME_PROC(name) PTime name(const char *path)
 typedef LAST_WRITE_TIME_PROC(last_write_time_proc);
 
+// NOTE: copy on write view of the whole file, writes to it never reach the file
+struct MappedFile {
+    u32 size;
+    void *contents;
+    void *handle;
+};
+
+#define MAP_FILE_PROC(name) b32 name(MappedFile *file, const char *path)
+typedef MAP_FILE_PROC(map_file_proc);
+
+#define UNMAP_FILE_PROC(name) void name(MappedFile *file)
+typedef UNMAP_FILE_PROC(unmap_file_proc);
+
 typedef u32 sound_id;
 
 #define CREATE_SOUND_PROC(name) sound_id name(struct LoadedSound *sound)
@@ -285,18 +301,69 @@ typedef DELETE_SOUND_PROC(delete_sound_proc);
 #define PLAY_SOUND_PROC(name) void name(sound_id id /*, params */)
 typedef PLAY_SOUND_PROC(play_sound_proc);
 
+// NOTE: defined by the platform layer
+struct PlatformWorkQueue;
+
+#define PLATFORM_WORK_QUEUE_CALLBACK(name) void name(PlatformWorkQueue *queue, void *data)
+typedef PLATFORM_WORK_QUEUE_CALLBACK(platform_work_queue_callback);
+
+#define ADD_WORK_ENTRY_PROC(name) void name(PlatformWorkQueue *queue, platform_work_queue_callback *callback, void *data)
+typedef ADD_WORK_ENTRY_PROC(add_work_entry_proc);
+
+#define COMPLETE_ALL_WORK_PROC(name) void name(PlatformWorkQueue *queue)
+typedef COMPLETE_ALL_WORK_PROC(complete_all_work_proc);
+
+// NOTE: for data shared between work entries, all of them return the previous value
+#if defined(_MSC_VER)
+#include <intrin.h>
+inline u32 atomic_add_u32(u32 volatile *value, u32 addend) {
+    return (u32)_InterlockedExchangeAdd((long volatile *)value, (long)addend);
+}
+
+inline u64 atomic_add_u64(u64 volatile *value, u64 addend) {
+    return (u64)_InterlockedExchangeAdd64((__int64 volatile *)value, (__int64)addend);
+}
+
+inline u32 atomic_compare_exchange_u32(u32 volatile *value, u32 expected, u32 desired) {
+    return (u32)_InterlockedCompareExchange((long volatile *)value, (long)desired, (long)expected);
+}
+#else
+inline u32 atomic_add_u32(u32 volatile *value, u32 addend) {
+    return __sync_fetch_and_add(value, addend);
+}
+
+inline u64 atomic_add_u64(u64 volatile *value, u64 addend) {
+    return __sync_fetch_and_add(value, addend);
+}
+
+inline u32 atomic_compare_exchange_u32(u32 volatile *value, u32 expected, u32 desired) {
+    return __sync_val_compare_and_swap(value, expected, desired);
+}
+#endif
+
+// NOTE: in seconds
+#define GET_WALL_CLOCK_PROC(name) f64 name(void)
+typedef GET_WALL_CLOCK_PROC(get_wall_clock_proc);
+
 struct PlatformProcs {
     alloc_memory_proc   *alloc;
     realloc_memory_proc *realloc;
     free_memory_proc    *free;
     
-    read_file_proc *read_file;
-    free_file_proc *free_file;
+    read_file_proc  *read_file;
+    free_file_proc  *free_file;
+    write_file_proc *write_file;
     last_write_time_proc *last_write_time;
+    map_file_proc   *map_file;
+    unmap_file_proc *unmap_file;
     
     create_sound_proc *create_sound;
     delete_sound_proc *delete_sound;
     play_sound_proc   *play_sound;
+    
+    add_work_entry_proc    *add_work_entry;
+    complete_all_work_proc *complete_all_work;
+    get_wall_clock_proc    *get_wall_clock;
 };
 
 struct MemoryBlock {
@@ -348,9 +415,36 @@ inline void *push_memory_(MemoryArena *arena, u32 size) {
     if((arena->used + size) <= arena->size) {
         memory = arena->base + arena->used;
         arena->used += size;
-        //}
-        return memory;
     }
+    return memory;
+}
+
+// NOTE: 'alignment' has to be a power of 2, data touched with atomics mustn't straddle cache lines
+#define push_array_aligned(arena_ptr, s, n, a) (s *)push_memory_aligned_((arena_ptr), (n) * sizeof(s), (a))
+inline void *push_memory_aligned_(MemoryArena *arena, u32 size, u32 alignment) {
+    size_t address = (size_t)(arena->base + arena->used);
+    u32 padding = (u32)(((address + alignment - 1) & ~(size_t)(alignment - 1)) - address);
+    push_memory_(arena, padding);
+    return push_memory_(arena, size);
+}
+
+struct TemporaryMemory {
+    MemoryArena *arena;
+    u32 used;
+};
+
+inline TemporaryMemory
+begin_temporary_memory(MemoryArena *arena) {
+    TemporaryMemory temp;
+    temp.arena = arena;
+    temp.used  = arena->used;
+    return temp;
+}
+
+inline void
+end_temporary_memory(TemporaryMemory temp) {
+    ASSERT(temp.arena->used >= temp.used, "temporary memory ended out of order");
+    temp.arena->used = temp.used;
 }
 
 #include "p_utils.h"
@@ -372,6 +466,7 @@ struct Core {
     GameMemory *memory;
     WindowState *window;
     PlatformProcs *procs;
+    PlatformWorkQueue *work_queue;
 };
 
 struct StartupParams {
@@ -178,11 +178,48 @@ get_tex_coords(SpriteSheet *ss, u32 x, u32 y) {
         ((f32)((y + 1) * ss->y_pixels_per_sprite) - padding) / (f32)ss->ss_height,
     };
     
+    for(u32 i = 0; i < size_array(tex_coords.vecs); ++i) {
+        tex_coords.vecs[i] = ss->uv_min + tex_coords.vecs[i] * (ss->uv_max - ss->uv_min);
+    }
     return tex_coords;
 }
 
 // NOTE: Renderer
 
+// NOTE: vertex stage for QuadInstance, the corner comes from the index. Outputs match the
+// QuadVertex shaders so any of their fragment stages can go with it.
+static const char quad_instanced_vertex_source[] = R"GLSL( #version 330 core
+
+layout(location = 0) in vec3  position;
+layout(location = 1) in vec2  size;
+layout(location = 2) in float rotation;
+layout(location = 3) in vec4  uv_rect;
+layout(location = 4) in vec4  color;
+layout(location = 5) in float tex_slot;
+
+uniform mat4 u_proj;
+uniform mat4 u_view;
+
+out vec2  v_tex_coord;
+out vec4  v_color;
+out float v_tex_slot;
+out vec2  v_tiling_factor;
+
+void main()
+{
+    vec2 corner = vec2((gl_VertexID == 1 || gl_VertexID == 2) ? 1.0 : 0.0, (gl_VertexID >= 2) ? 1.0 : 0.0);
+    vec2 offset = (corner - 0.5) * size;
+    float s = sin(rotation);
+    float c = cos(rotation);
+    gl_Position = u_proj * u_view * vec4(position.xy + vec2(offset.x * c - offset.y * s, offset.x * s + offset.y * c), position.z, 1.0);
+    
+    v_tex_coord = mix(uv_rect.xy, uv_rect.zw, corner);
+    v_color = color;
+    v_tex_slot = tex_slot;
+    v_tiling_factor = vec2(1.0);
+}
+)GLSL";
+
 static void 
 init_renderer(Renderer *r, RendererAPI *api, PlatformProcs *platform_procs) {
     r->api = *api;
@@ -239,7 +276,18 @@ hotload_shaders(Renderer *r, f32 dt) {
                 if(!p_time_cmp(&ref->last_write_time, &last_write_time, false)) {
                     delete_shader_program(r, &ref->shader);
                     ref->shader = create_shader_program(r, ref->path);
-                    printf("shader <%s> hotloaded... id(%lu)\n", ref->path, ref->shader.id);
+                    if(ref->instanced.id) {
+                        delete_shader_program(r, &ref->instanced);
+                    }
+                    ref->instanced = create_instanced_shader_program(r, ref->path);
+                    ref->shader.ref = ref;
+                    
+                    // NOTE: the new instanced program starts with none of the uniforms
+                    for(u32 j = 0; j < ref->instanced_uniform_count; ++j) {
+                        ref->instanced_uniforms[j].dirty = true;
+                    }
+                    ref->instanced_dirty = true;
+                    printf("shader <%s> hotloaded... id(%u)\n", ref->path, ref->shader.id);
                     ref->last_write_time = last_write_time;
                     hotloaded = true;
                 }
@@ -257,11 +305,13 @@ static void
 begin_renderer_frame(Renderer *r) {
     r->stats.quad_count = 0;
     r->stats.draw_calls = 0;
+    r->stats.upload_bytes = 0;
+    r->stats.immediate_draw_calls = 0;
 }
 
 static void 
 push(Renderer *r) {
-    ASSERT((r->stack_id + 1) <= RENDERER_STACK_SIZE, "");
+    ASSERT((r->stack_id + 1) <= RENDERER_STACK_SIZE, "renderer stack overflow...\n");
     
     r->stack_vp[r->stack_id] = r->viewport;
     r->stack_fb[r->stack_id] = r->bound_framebuffer;
@@ -306,6 +356,19 @@ set_batch_params(Renderer *r, u32 new_max_quads, u32 new_max_texture_slots) {
         verts += 4;
     }
     
+    if(r->commands) { r->procs->free(r->commands); }
+    r->commands = (RenderCommand *)r->procs->alloc(r->max_quads * sizeof(RenderCommand));
+    if(r->sorted_commands) { r->procs->free(r->sorted_commands); }
+    r->sorted_commands = (RenderCommand *)r->procs->alloc(r->max_quads * sizeof(RenderCommand));
+    if(r->command_vertices) { r->procs->free(r->command_vertices); }
+    r->command_vertices = (QuadVertex *)r->procs->alloc(r->max_quad_verts * sizeof(QuadVertex));
+    if(r->instance_data) { r->procs->free(r->instance_data); }
+    r->instance_data = (QuadInstance *)r->procs->alloc(r->max_quads * sizeof(QuadInstance));
+    if(r->command_instances) { r->procs->free(r->command_instances); }
+    r->command_instances = (QuadInstance *)r->procs->alloc(r->max_quads * sizeof(QuadInstance));
+    if(r->immediate_slots) { r->procs->free(r->immediate_slots); }
+    r->immediate_slots = (u32 *)r->procs->alloc(r->max_texture_slots * sizeof(u32));
+    
     for(u32 i = 0; i < size_array(r->shaders); ++i) {
         ShaderProgram *shader = &r->shaders[i].shader;
         bind_shader(r, shader);
@@ -332,6 +395,24 @@ set_batch_params(Renderer *r, u32 new_max_quads, u32 new_max_texture_slots) {
     r->api.attach_vertex_buffer(&r->quad_va, &r->quad_vb);
     r->quad_ib = r->api.create_index_buffer(r->quad_indices, r->max_quad_indices);
     r->api.attach_index_buffer(&r->quad_va, &r->quad_ib);
+    
+    // NOTE: instanced quads only have the per instance buffer, the 6 indices pick the corners
+    if(r->instance_vb.id) { r->api.delete_vertex_buffer(&r->instance_vb); }
+    if(r->instance_ib.id) { r->api.delete_index_buffer(&r->instance_ib); }
+    if(r->instance_va.id) { r->api.delete_vertex_array(&r->instance_va); }
+    
+    r->instance_va = r->api.create_vertex_array();
+    r->instance_vb = r->api.create_vertex_buffer(nullptr, r->max_quads * sizeof(QuadInstance), VB_dynamic);
+    r->instance_vb.layout.per_instance = true;
+    r->instance_vb.layout.push(3, LAYOUT_float32, "position");
+    r->instance_vb.layout.push(2, LAYOUT_float32, "size");
+    r->instance_vb.layout.push(1, LAYOUT_float32, "rotation");
+    r->instance_vb.layout.push(4, LAYOUT_float32, "uv_rect");
+    r->instance_vb.layout.push(4, LAYOUT_uint8,   "color", true);
+    r->instance_vb.layout.push(1, LAYOUT_float32, "tex_slot");
+    r->api.attach_vertex_buffer(&r->instance_va, &r->instance_vb);
+    r->instance_ib = r->api.create_index_buffer(r->quad_indices, 6);
+    r->api.attach_index_buffer(&r->instance_va, &r->instance_ib);
 }
 
 static void 
@@ -382,43 +463,203 @@ clear(Renderer *r, vec4 color) {
 }
 
 static void 
-flush(Renderer *r) {
-    if(r->quad_count == 0) {
+draw_batch(Renderer *r) {
+    if(r->quad_count == 0 && r->instance_count == 0) {
         return;
     }
     
+    // NOTE: draw_commands fills one or the other, never both
     ShaderProgram *shader = r->bound_shader; //_basic->shader;
     // bind_shader(r, shader);
+    if(r->instance_count) {
+        shader = get_instanced_shader(r, r->bound_shader);
+        r->api.bind_shader(shader);
+        flush_instanced_uniforms(r, r->bound_shader->ref);
+    }
     for(u32 i = 0; i < r->texture_count; ++i) {
         bind_texture_2d(r, r->texture_slots[i], i);
     }
-    set_uniform_mat4x4(r, shader, "u_proj", r->scene_data.proj);
-    set_uniform_mat4x4(r, shader, "u_view", r->scene_data.view);
-    
-    u32 quad_verts_count = r->quad_count * 4;
-    u32 quad_index_count = r->quad_count * 6;
-    u32 size = quad_verts_count * sizeof(QuadVertex);
-    r->api.set_vertex_buffer_data(&r->quad_vb, r->quad_vb_data, size, 0);
-    r->api.draw_indexed(&r->quad_va, quad_index_count);
+    r->api.set_uniform_mat4x4(shader, "u_proj", r->scene_data.proj);
+    r->api.set_uniform_mat4x4(shader, "u_view", r->scene_data.view);
     
+    if(r->instance_count) {
+        u32 size = r->instance_count * sizeof(QuadInstance);
+        r->api.set_vertex_buffer_data(&r->instance_vb, r->instance_data, size, 0);
+        r->api.draw_instanced(&r->instance_va, 6, r->instance_count);
+        r->api.bind_shader(r->bound_shader);
+        
+        r->stats.upload_bytes += size;
+        r->stats.quad_count += r->instance_count;
+    }
+    else {
+        u32 quad_verts_count = r->quad_count * 4;
+        u32 quad_index_count = r->quad_count * 6;
+        u32 size = quad_verts_count * sizeof(QuadVertex);
+        r->api.set_vertex_buffer_data(&r->quad_vb, r->quad_vb_data, size, 0);
+        r->api.draw_indexed(&r->quad_va, quad_index_count);
+        
+        r->stats.upload_bytes += size;
+        r->stats.quad_count += r->quad_count;
+    }
     r->stats.draw_calls += 1;
-    r->stats.quad_count += r->quad_count;
     
     r->quad_count = 0;
+    r->instance_count = 0;
     r->texture_count = 0;
 }
 
-static u32
-bind_next_batch_texture_slot(Renderer *r, Texture2D *tex) {
-    // NOTE: if nullptr then return 1x1 white texture
-    if(tex == nullptr) {
-        return bind_next_batch_texture_slot(r, &r->white_texture);
+// NOTE: keys are unique, the sequence is in the low bits
+static void
+sort_render_commands(RenderCommand *commands, RenderCommand *temp, u32 count) {
+    RenderCommand *source = commands;
+    RenderCommand *dest = temp;
+    for(u32 width = 1; width < count; width *= 2) {
+        for(u32 begin = 0; begin < count; begin += width * 2) {
+            u32 middle = min_value(begin + width, count);
+            u32 end = min_value(begin + width * 2, count);
+            u32 a = begin;
+            u32 b = middle;
+            for(u32 i = begin; i < end; ++i) {
+                if(a < middle && (b >= end || source[a].key < source[b].key)) {
+                    dest[i] = source[a++];
+                }
+                else {
+                    dest[i] = source[b++];
+                }
+            }
+        }
+        RenderCommand *swap = source;
+        source = dest;
+        dest = swap;
+    }
+    if(source != commands) {
+        copy_memory(source, commands, count * sizeof(RenderCommand));
+    }
+}
+
+// NOTE: the immediate path flushed when it had no free texture slot left or when the quad buffer
+// was full, this keeps count of that for RenderStats::immediate_draw_calls
+static void
+count_immediate_quad(Renderer *r, u32 tex_id) {
+    if(r->immediate_quad_count >= r->max_quads || r->immediate_texture_count >= r->max_texture_slots) {
+        r->stats.immediate_draw_calls += 1;
+        r->immediate_quad_count = 0;
+        r->immediate_texture_count = 0;
     }
     
+    bool found = false;
+    for(u32 i = 0; i < r->immediate_texture_count; ++i) {
+        if(r->immediate_slots[i] == tex_id) {
+            found = true;
+            break;
+        }
+    }
+    if(!found) {
+        r->immediate_slots[r->immediate_texture_count++] = tex_id;
+    }
+    r->immediate_quad_count += 1;
+}
+
+// NOTE: the corners the instanced vertex stage makes, for batches that can't be drawn instanced
+static void
+get_instance_vertices(QuadInstance *instance, QuadVertex *vertices) {
+    f32 s = sinf(instance->rotation);
+    f32 c = cosf(instance->rotation);
+    vec4 color = make_vec4((f32)(instance->color & 0xff), (f32)((instance->color >> 8) & 0xff),
+                           (f32)((instance->color >> 16) & 0xff), (f32)(instance->color >> 24)) * (1.0f / 255.0f);
+    for(u32 i = 0; i < 4; ++i) {
+        f32 x = (i == 1 || i == 2) ? 1.0f : 0.0f;
+        f32 y = (i >= 2) ? 1.0f : 0.0f;
+        vec2 offset = make_vec2((x - 0.5f) * instance->size.x, (y - 0.5f) * instance->size.y);
+        
+        QuadVertex *vertex = &vertices[i];
+        vertex->position = make_vec3(instance->position.x + offset.x * c - offset.y * s,
+                                     instance->position.y + offset.x * s + offset.y * c, instance->position.z);
+        vertex->color = color;
+        vertex->tex_coord = make_vec2(instance->uv_rect.x + (instance->uv_rect.z - instance->uv_rect.x) * x,
+                                      instance->uv_rect.y + (instance->uv_rect.w - instance->uv_rect.y) * y);
+        vertex->tex_slot = instance->tex_slot;
+        vertex->tiling_factor = make_vec2(1.0f);
+    }
+}
+
+// NOTE: commands [begin, end) have their textures bound. They go down instanced only if all of them
+// can, one batch per kind would cost more draw calls than the vertices it saves.
+static void
+draw_commands(Renderer *r, u32 begin, u32 end) {
+    bool instanced = get_instanced_shader(r, r->bound_shader) != nullptr;
+    for(u32 i = begin; i < end && instanced; ++i) {
+        instanced = r->commands[i].instanced;
+    }
+    
+    for(u32 i = begin; i < end; ++i) {
+        RenderCommand *command = &r->commands[i];
+        f32 slot = (f32)bind_next_batch_texture_slot(r, command->tex_id);
+        if(instanced) {
+            QuadInstance *instance = &r->instance_data[r->instance_count++];
+            *instance = r->command_instances[command->index];
+            instance->tex_slot = slot;
+            continue;
+        }
+        
+        QuadVertex *vertex = &r->quad_vb_data[r->quad_count * 4];
+        if(command->instanced) {
+            r->command_instances[command->index].tex_slot = slot;
+            get_instance_vertices(&r->command_instances[command->index], vertex);
+        }
+        else {
+            QuadVertex *source = &r->command_vertices[command->index * 4];
+            for(u32 j = 0; j < 4; ++j) {
+                vertex[j] = source[j];
+                vertex[j].tex_slot = slot;
+            }
+        }
+        r->quad_count += 1;
+    }
+    draw_batch(r);
+}
+
+// NOTE: sorts the recorded quads and draws them in as few batches as the texture slots allow
+static void 
+flush(Renderer *r) {
+    if(r->immediate_quad_count) {
+        r->stats.immediate_draw_calls += 1;
+        r->immediate_quad_count = 0;
+        r->immediate_texture_count = 0;
+    }
+    if(r->command_count == 0) {
+        return;
+    }
+    
+    sort_render_commands(r->commands, r->sorted_commands, r->command_count);
+    u32 begin = 0;
+    for(u32 i = 0; i < r->command_count; ++i) {
+        u32 tex_id = r->commands[i].tex_id;
+        bool bound = false;
+        for(u32 j = 0; j < r->texture_count; ++j) {
+            if(r->texture_slots[j] == tex_id) {
+                bound = true;
+                break;
+            }
+        }
+        if(!bound && r->texture_count >= r->max_texture_slots) {
+            draw_commands(r, begin, i);
+            begin = i;
+        }
+        bind_next_batch_texture_slot(r, tex_id);
+    }
+    draw_commands(r, begin, r->command_count);
+    
+    r->command_count = 0;
+    zero_array(r->grid, RenderGridCell);
+}
+
+static u32
+bind_next_batch_texture_slot(Renderer *r, u32 tex_id) {
     u32 slot = 0;
     bool found = false;
     for(u32 i = 0; i < r->texture_count; ++i) {
-        if(r->texture_slots[i] == tex->id) {
+        if(r->texture_slots[i] == tex_id) {
             found = true;
             slot = i;
             break;
@@ -428,31 +669,145 @@ bind_next_batch_texture_slot(Renderer *r, Texture2D *tex) {
     if(!found) {
         assert((r->texture_count + 1) <= r->max_texture_slots);
         slot = r->texture_count;
-        r->texture_slots[slot] = tex->id;
+        r->texture_slots[slot] = tex_id;
         r->texture_count++;
     }
     return slot;
 }
 
+// NOTE: the lowest layer a quad can go on without moving in front of an overlapping quad with
+// another texture. Screen cells are conservative, a false overlap only costs sorting freedom.
+static u32
+get_quad_layer(Renderer *r, vec3 positions[4], u32 tex_id, i32 *cells) {
+    vec2 min_p = make_vec2(+1.0f);
+    vec2 max_p = make_vec2(-1.0f);
+    for(u32 i = 0; i < 4; ++i) {
+        vec4 p = r->scene_data.proj * (r->scene_data.view * make_vec4(positions[i], 1.0f));
+        if(!(p.w > 0.0f)) {
+            min_p = make_vec2(-1.0f);
+            max_p = make_vec2(+1.0f);
+            break;
+        }
+        vec2 ndc = make_vec2(p.x / p.w, p.y / p.w);
+        min_p = make_vec2(min_value(min_p.x, ndc.x), min_value(min_p.y, ndc.y));
+        max_p = make_vec2(max_value(max_p.x, ndc.x), max_value(max_p.y, ndc.y));
+    }
+    
+    f32 scale = RENDER_GRID_SIZE * 0.5f;
+    cells[0] = clamp((i32)((min_p.x + 1.0f) * scale), 0, RENDER_GRID_SIZE - 1);
+    cells[1] = clamp((i32)((min_p.y + 1.0f) * scale), 0, RENDER_GRID_SIZE - 1);
+    cells[2] = clamp((i32)((max_p.x + 1.0f) * scale), 0, RENDER_GRID_SIZE - 1);
+    cells[3] = clamp((i32)((max_p.y + 1.0f) * scale), 0, RENDER_GRID_SIZE - 1);
+    
+    u32 layer = 0;
+    for(i32 y = cells[1]; y <= cells[3]; ++y) {
+        for(i32 x = cells[0]; x <= cells[2]; ++x) {
+            RenderGridCell *cell = &r->grid[y * RENDER_GRID_SIZE + x];
+            if(!cell->tex_id) {
+                continue;
+            }
+            u32 needed = (cell->mixed || cell->tex_id != tex_id) ? cell->layer + 1 : cell->layer;
+            layer = max_value(layer, needed);
+        }
+    }
+    return layer;
+}
+
+// NOTE: returns where the quad's data goes
+static u32
+record_quad_command(Renderer *r, vec3 positions[4], u32 tex_id, bool instanced) {
+    if(r->command_count >= r->max_quads) {
+        flush(r);
+    }
+    count_immediate_quad(r, tex_id);
+    
+    i32 cells[4];
+    u32 layer = get_quad_layer(r, positions, tex_id, cells);
+    for(i32 y = cells[1]; y <= cells[3]; ++y) {
+        for(i32 x = cells[0]; x <= cells[2]; ++x) {
+            RenderGridCell *cell = &r->grid[y * RENDER_GRID_SIZE + x];
+            if(!cell->tex_id || layer > cell->layer) {
+                cell->layer = layer;
+                cell->tex_id = tex_id;
+                cell->mixed = false;
+            }
+            else if(layer == cell->layer && tex_id != cell->tex_id) {
+                cell->mixed = true;
+            }
+        }
+    }
+    
+    RenderCommand *command = &r->commands[r->command_count];
+    command->key = ((u64)layer << 48) | ((u64)(tex_id & 0xffff) << 32) | r->command_count;
+    command->index = r->command_count;
+    command->tex_id = tex_id;
+    command->instanced = instanced;
+    return r->command_count++;
+}
+
+// NOTE: a rectangle with a rectangle of uvs, a parallelogram with right angles and one z,
+// goes down as a QuadInstance. Sizes come out signed so mirrored quads keep their uvs.
+static bool
+get_quad_instance(vec3 positions[4], vec2 tex_coords[4], vec4 color, vec2 tiling_factor, QuadInstance *instance) {
+    vec3 axis_x = positions[1] - positions[0];
+    vec3 axis_y = positions[3] - positions[0];
+    vec3 error = positions[2] - (positions[1] + axis_y);
+    f32 length_x = sqrtf(axis_x.x * axis_x.x + axis_x.y * axis_x.y);
+    f32 length_y = sqrtf(axis_y.x * axis_y.x + axis_y.y * axis_y.y);
+    f32 tolerance = (length_x + length_y) * 0.0001f;
+    if(!(length_x >= 0.0f && length_y >= 0.0f) ||
+       fabsf(error.x) > tolerance || fabsf(error.y) > tolerance ||
+       fabsf(axis_x.z) > tolerance || fabsf(axis_y.z) > tolerance || fabsf(error.z) > tolerance ||
+       fabsf(axis_x.x * axis_y.x + axis_x.y * axis_y.y) > tolerance * (length_x + length_y)) {
+        return false;
+    }
+    if(tex_coords[1].y != tex_coords[0].y || tex_coords[3].x != tex_coords[0].x ||
+       tex_coords[2].x != tex_coords[1].x || tex_coords[2].y != tex_coords[3].y) {
+        return false;
+    }
+    
+    // NOTE: the packed color can't go past 1 like the vertex one can
+    for(u32 i = 0; i < 4; ++i) {
+        if(!(color.e[i] >= 0.0f && color.e[i] <= 1.0f)) {
+            return false;
+        }
+    }
+    
+    f32 cross = axis_x.x * axis_y.y - axis_x.y * axis_y.x;
+    instance->position = (positions[0] + positions[2]) * 0.5f;
+    instance->size = make_vec2(length_x, (cross > 0.0f) ? length_y : -length_y);
+    instance->rotation = (axis_x.y == 0.0f && axis_x.x > 0.0f) ? 0.0f : atan2f(axis_x.y, axis_x.x);
+    instance->uv_rect = make_vec4(tex_coords[0].x * tiling_factor.x, tex_coords[0].y * tiling_factor.y,
+                                  tex_coords[2].x * tiling_factor.x, tex_coords[2].y * tiling_factor.y);
+    instance->color = ((u32)(color.r * 255.0f + 0.5f) | ((u32)(color.g * 255.0f + 0.5f) << 8) |
+                       ((u32)(color.b * 255.0f + 0.5f) << 16) | ((u32)(color.a * 255.0f + 0.5f) << 24));
+    instance->tex_slot = 0.0f;
+    return true;
+}
+
 static void 
 draw_quad_base(Renderer *r, vec3 positions[4], vec2 tex_coords[4], 
                vec4 color, Texture2D *tex, vec2 tiling_factor) {
-    if(r->quad_count >= r->max_quads
-       || r->texture_count >= r->max_texture_slots) {
-        flush(r);
+    // NOTE: if nullptr then 1x1 white texture
+    u32 tex_id = tex ? tex->id : r->white_texture.id;
+    
+    QuadInstance instance;
+    if(get_quad_instance(positions, tex_coords, color, tiling_factor, &instance)) {
+        u32 index = record_quad_command(r, positions, tex_id, true);
+        r->command_instances[index] = instance;
+        return;
     }
-    f32 slot = (f32)bind_next_batch_texture_slot(r, tex);
     
-    QuadVertex *vertex = &r->quad_vb_data[r->quad_count * 4];
+    u32 index = record_quad_command(r, positions, tex_id, false);
+    QuadVertex *vertex = &r->command_vertices[index * 4];
     for(u32 i = 0; i < 4; ++i) {
         vertex->position = positions[i];
         vertex->color = color;
         vertex->tex_coord = tex_coords[i];
-        vertex->tex_slot = slot;
+        vertex->tex_slot = 0.0f;
         vertex->tiling_factor = tiling_factor;
         vertex++;
     }
-    r->quad_count += 1;
 }
 
 static void
@@ -634,6 +989,56 @@ draw_quad_rotated(Renderer *r, vec2 position, vec2 size, f32 rotation,
     draw_quad_rotated(r, {position.x, position.y, 0.0f}, size, rotation, ss_tile, color);
 }
 
+static void 
+draw_quad(Renderer *r, vec3 position, vec2 size, vec4 color, TextureRegion *region) {
+    if(!region) {
+        draw_quad(r, position, size, color, (Texture2D *)nullptr);
+        return;
+    }
+    vec3 positions[4] = {
+        position,
+        position + make_vec3(size.x, 0.0f, 0.0f),
+        position + make_vec3(size.x, size.y, 0.0f),
+        position + make_vec3(0.0f, size.y, 0.0f),
+    };
+    vec2 tex_coords[4] = {
+        { region->uv_min.x, region->uv_min.y },
+        { region->uv_max.x, region->uv_min.y },
+        { region->uv_max.x, region->uv_max.y },
+        { region->uv_min.x, region->uv_max.y },
+    };
+    draw_quad_base(r, positions, tex_coords, color, &region->tex, { 1.0f, 1.0f });
+}
+
+static void 
+draw_quad_rotated(Renderer *r, vec3 position, vec2 size, f32 rotation, vec4 color, TextureRegion *region) {
+    if(!region) {
+        draw_quad_rotated(r, position, size, rotation, color, (Texture2D *)nullptr);
+        return;
+    }
+    f32 half_size_x = size.x * 0.5f;
+    f32 half_size_y = size.y * 0.5f;
+    vec3 positions[4] = {
+        {-half_size_x, -half_size_y, 0.0f},
+        {+half_size_x, -half_size_y, 0.0f},
+        {+half_size_x, +half_size_y, 0.0f},
+        {-half_size_x, +half_size_y, 0.0f},
+    };
+    vec2 tex_coords[4] = {
+        { region->uv_min.x, region->uv_min.y },
+        { region->uv_max.x, region->uv_min.y },
+        { region->uv_max.x, region->uv_max.y },
+        { region->uv_min.x, region->uv_max.y },
+    };
+    
+    mat4x4 translate = mat4x4_translate(position.x + half_size_x, position.y + half_size_y, position.z);
+    mat4x4 rotate = mat4x4_zaxis_rotate(rotation);
+    mat4x4 transform = rotate * translate;
+    
+    for(u32 i = 0; i < 4; ++i) { positions[i] = transform * positions[i]; }
+    draw_quad_base(r, positions, tex_coords, color, &region->tex, { 1.0f, 1.0f });
+}
+
 static void 
 draw_quad_outline(Renderer *r, vec3 position, vec2 size, f32 width, vec4 color) {
     // NOTE: left
@@ -679,7 +1084,7 @@ draw_quad_outline(Renderer *r, vec2 position, vec2 size, f32 width, vec4 color)
 }
 
 static void 
-draw_text(Renderer *r, char *buffer, vec3 position, f32 line_height, 
+draw_text(Renderer *r, const char *buffer, vec3 position, f32 line_height, 
           Font *loaded_font, vec4 color, bool break_lines) {
     Font *font = loaded_font;
     if(!font) {
@@ -694,7 +1099,7 @@ draw_text(Renderer *r, char *buffer, vec3 position, f32 line_height,
     
     f32 x_cursor = position.x;
     f32 y_cursor = position.y;
-    char *text_cursor = buffer;
+    const char *text_cursor = buffer;
     while(true) {
         if(*text_cursor == '\0') {
             break;
@@ -713,8 +1118,8 @@ draw_text(Renderer *r, char *buffer, vec3 position, f32 line_height,
             continue;
         }
         
-        vec2 draw_size = make_vec2(glyph->tex.width * scale,
-                                   glyph->tex.height * scale);
+        vec2 draw_size = make_vec2(glyph->width * scale,
+                                   glyph->height * scale);
         
         vec3 draw_p = {x_cursor, y_cursor, position.z};
         // draw_p.y = position.y + draw_size.y * 0.5f;
@@ -723,11 +1128,11 @@ draw_text(Renderer *r, char *buffer, vec3 position, f32 line_height,
         draw_p.x += ((f32)glyph->left_side_bearing * font->scale_factor) * scale;
         // draw_p.x += draw_size.x * 0.5f;
         
-        draw_quad(r, draw_p, draw_size, color, &glyph->tex);
+        draw_quad(r, draw_p, draw_size, color, &glyph->region);
         // r->quad(draw_p, draw_size, color, 0.0f);
         
         x_cursor += (glyph->advance * font->scale_factor) * scale;
-        if(text_cursor + 1) {
+        if(*(text_cursor + 1)) {
             i32 kern = get_kerning_advance(font, *text_cursor, *(text_cursor + 1));
             x_cursor += ((f32)kern * font->scale_factor) * scale;
         }
@@ -736,7 +1141,7 @@ draw_text(Renderer *r, char *buffer, vec3 position, f32 line_height,
 }
 
 static void 
-draw_text(Renderer *r, char *buffer, vec2 position, f32 line_height, 
+draw_text(Renderer *r, const char *buffer, vec2 position, f32 line_height, 
           Font *loaded_font, vec4 color, bool break_lines) {
     draw_text(r, buffer, {position.x, position.y, 0.0f}, line_height, loaded_font, color, break_lines);
 }
@@ -778,6 +1183,11 @@ delete_texture_2d(Renderer *r, Texture2D *tex) {
     r->api.delete_texture_2d(tex);
 }
 
+static void 
+update_texture_2d(Renderer *r, Texture2D *tex, i32 x, i32 y, i32 width, i32 height, u8 *data) {
+    r->api.update_texture_2d(tex, x, y, width, height, data);
+}
+
 static void 
 bind_texture_2d(Renderer *r, u32 tex_id, u32 unit) {
     r->api.bind_texture_2d(tex_id, unit);
@@ -790,23 +1200,38 @@ unbind_texture_2d(Renderer *r, u32 unit) {
 
 static SpriteSheet
 create_sprite_sheet(Renderer *r, u8 *data, i32 width, i32 height, i32 channels, 
-                    u32 x_pixels_per_sprite, u32 y_pixels_per_sprite, Texture2DParams *params) {
+                    u32 x_pixels_per_sprite, u32 y_pixels_per_sprite, Texture2DParams *params, TextureAtlas *atlas) {
     SpriteSheet ss = {};
-    ss.tex = create_texture_2d(r, data, width, height, channels, params);
+    TextureRegion region;
+    if(atlas && atlas_add_image(r, atlas, data, width, height, channels, &region)) {
+        ss.tex = region.tex;
+        ss.in_atlas = true;
+        ss.uv_min = region.uv_min;
+    }
+    else {
+        ss.tex = create_texture_2d(r, data, width, height, channels, params);
+        ss.uv_min = { 0.0f, 0.0f };
+    }
     if(ss.tex.id) {
         ss.x_pixels_per_sprite = x_pixels_per_sprite;
         ss.y_pixels_per_sprite = y_pixels_per_sprite;
-        ss.x_sprites = ss.tex.width / x_pixels_per_sprite;
-        ss.y_sprites = ss.tex.height / y_pixels_per_sprite;
+        ss.x_sprites = width / x_pixels_per_sprite;
+        ss.y_sprites = height / y_pixels_per_sprite;
         ss.ss_width = ss.x_sprites * x_pixels_per_sprite;
         ss.ss_height = ss.y_sprites * y_pixels_per_sprite;
+        
+        // NOTE: get_tex_coords goes over ss_width * ss_height pixels of the sheet
+        ss.uv_max = { 1.0f, 1.0f };
+        if(ss.in_atlas) {
+            ss.uv_max = ss.uv_min + make_vec2((f32)ss.ss_width / (f32)ss.tex.width, (f32)ss.ss_height / (f32)ss.tex.height);
+        }
     }
     return ss;
 }
 
 static SpriteSheet
 create_sprite_sheet(Renderer *r, const char *path, u32 x_pixels_per_sprite, 
-                    u32 y_pixels_per_sprite, Texture2DParams *params) {
+                    u32 y_pixels_per_sprite, Texture2DParams *params, TextureAtlas *atlas) {
     stbi_set_flip_vertically_on_load(true);   
     
     i32 width;
@@ -814,19 +1239,151 @@ create_sprite_sheet(Renderer *r, const char *path, u32 x_pixels_per_sprite,
     i32 channels;
     stbi_uc *data = stbi_load(path, &width, &height, &channels, 0);
     assert(data);
-    SpriteSheet ss = create_sprite_sheet(r, data, width, height, channels,x_pixels_per_sprite, y_pixels_per_sprite, params);
+    SpriteSheet ss = create_sprite_sheet(r, data, width, height, channels,x_pixels_per_sprite, y_pixels_per_sprite, params, atlas);
     stbi_image_free(data);
     return ss;
 }
 
 static void 
 delete_sprite_sheet(Renderer *r, SpriteSheet *ss) {
-    delete_texture_2d(r, &ss->tex);
+    if(!ss->in_atlas) {
+        delete_texture_2d(r, &ss->tex);
+    }
     zero_struct(ss);
 }
 
+inline TextureRegion
+make_texture_region(Texture2D tex) {
+    TextureRegion region = {};
+    region.tex = tex;
+    region.uv_min = { 0.0f, 0.0f };
+    region.uv_max = { 1.0f, 1.0f };
+    return region;
+}
+
+static TextureRegion
+create_texture_region(Renderer *r, const char *path, Texture2DParams *params, TextureAtlas *atlas) {
+    stbi_set_flip_vertically_on_load(true);   
+    
+    i32 width;
+    i32 height;
+    i32 channels;
+    stbi_uc *data = stbi_load(path, &width, &height, &channels, 0);
+    assert(data);
+    TextureRegion region;
+    if(!atlas || !atlas_add_image(r, atlas, data, width, height, channels, &region)) {
+        region = make_texture_region(create_texture_2d(r, data, width, height, channels, params));
+    }
+    stbi_image_free(data);
+    return region;
+}
+
+static void
+delete_texture_region(Renderer *r, TextureRegion *region) {
+    if(!region->in_atlas && region->tex.id) {
+        delete_texture_2d(r, &region->tex);
+    }
+    zero_struct(region);
+}
+
+static TextureAtlas
+create_texture_atlas(Texture2DParams *params) {
+    TextureAtlas atlas = {};
+    atlas.params = *params;
+    return atlas;
+}
+
+// NOTE: false when the image doesn't fit in any page, the caller keeps it in its own texture
+static bool
+atlas_add_image(Renderer *r, TextureAtlas *atlas, u8 *data, i32 width, i32 height, i32 channels, TextureRegion *region) {
+    i32 padded_width  = width + ATLAS_PADDING;
+    i32 padded_height = height + ATLAS_PADDING;
+    if(padded_width > ATLAS_PAGE_SIZE || padded_height > ATLAS_PAGE_SIZE || channels < 1 || channels > 4) {
+        return false;
+    }
+    
+    // NOTE: the lowest shelf it fits on, a new shelf under the used part of the page otherwise
+    AtlasPage *page = nullptr;
+    AtlasShelf *shelf = nullptr;
+    for(u32 page_index = 0; page_index < atlas->page_count && !shelf; ++page_index) {
+        page = &atlas->pages[page_index];
+        for(u32 shelf_index = 0; shelf_index < page->shelf_count; ++shelf_index) {
+            AtlasShelf *it = &page->shelves[shelf_index];
+            if(it->height >= padded_height && (ATLAS_PAGE_SIZE - it->used_width) >= padded_width && 
+               (!shelf || it->height < shelf->height)) {
+                shelf = it;
+            }
+        }
+        if(!shelf && page->shelf_count < ATLAS_MAX_SHELVES && (ATLAS_PAGE_SIZE - page->used_height) >= padded_height) {
+            shelf = &page->shelves[page->shelf_count++];
+            shelf->y = page->used_height;
+            shelf->height = padded_height;
+            shelf->used_width = 0;
+            page->used_height += padded_height;
+        }
+    }
+    if(!shelf) {
+        if(atlas->page_count == ATLAS_MAX_PAGES) {
+            return false;
+        }
+        
+        // NOTE: the padding has to be empty, the page starts cleared
+        u32 page_bytes = ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4;
+        u8 *clear_texels = (u8 *)r->procs->alloc(page_bytes);
+        zero_memory(clear_texels, page_bytes);
+        page = &atlas->pages[atlas->page_count++];
+        zero_struct(page);
+        page->tex = create_texture_2d(r, clear_texels, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 4, &atlas->params);
+        r->procs->free(clear_texels);
+        
+        shelf = &page->shelves[page->shelf_count++];
+        shelf->y = 0;
+        shelf->height = padded_height;
+        shelf->used_width = 0;
+        page->used_height = padded_height;
+    }
+    
+    i32 x = shelf->used_width;
+    i32 y = shelf->y;
+    shelf->used_width += padded_width;
+    
+    if(width > 0 && height > 0) {
+        u8 *texels = data;
+        if(channels != 4) {
+            // NOTE: same expansion as a texture made from the data, missing color from red, opaque alpha
+            texels = (u8 *)r->procs->alloc(width * height * 4);
+            for(i32 i = 0; i < width * height; ++i) {
+                u8 *src = &data[i * channels];
+                u8 *dest = &texels[i * 4];
+                dest[0] = src[0];
+                dest[1] = channels > 1 ? src[1] : src[0];
+                dest[2] = channels > 2 ? src[2] : src[0];
+                dest[3] = channels == 2 ? src[1] : 255;
+            }
+        }
+        update_texture_2d(r, &page->tex, x, y, width, height, texels);
+        if(texels != data) {
+            r->procs->free(texels);
+        }
+    }
+    
+    region->tex = page->tex;
+    region->uv_min = make_vec2((f32)x / (f32)ATLAS_PAGE_SIZE, (f32)y / (f32)ATLAS_PAGE_SIZE);
+    region->uv_max = make_vec2((f32)(x + width) / (f32)ATLAS_PAGE_SIZE, (f32)(y + height) / (f32)ATLAS_PAGE_SIZE);
+    region->in_atlas = true;
+    return true;
+}
+
+static void
+delete_texture_atlas(Renderer *r, TextureAtlas *atlas) {
+    for(u32 i = 0; i < atlas->page_count; ++i) {
+        delete_texture_2d(r, &atlas->pages[i].tex);
+    }
+    zero_struct(atlas);
+}
+
 static Font
-create_font(Renderer *r, char *path, f32 height_in_pixels, Texture2DParams *glyph_params) {
+create_font(Renderer *r, char *path, f32 height_in_pixels, Texture2DParams *glyph_params, TextureAtlas *atlas) {
     Font font = {};
     
     Texture2DParams params = {
@@ -900,7 +1457,11 @@ create_font(Renderer *r, char *path, f32 height_in_pixels, Texture2DParams *glyp
                 }
             }
             
-            glyph->tex = create_texture_2d(r, tex_bitmap, width, height, bmp_bpp, &params);
+            if(!atlas || !atlas_add_image(r, atlas, tex_bitmap, width, height, bmp_bpp, &glyph->region)) {
+                glyph->region = make_texture_region(create_texture_2d(r, tex_bitmap, width, height, bmp_bpp, &params));
+            }
+            glyph->width = width;
+            glyph->height = height;
             glyph->y_offset = y_offset;
             
             i32 advance, left_side_bearing;
@@ -929,7 +1490,7 @@ delete_font(Renderer *r, Font *font) {
     r->procs->free(font->kerning_entries);
     for(i32 i = 0; i < FONT_GLYPH_COUNT; ++i) {
         Glyph *glyph = &font->glyphs[i];
-        delete_texture_2d(r, &glyph->tex);
+        delete_texture_region(r, &glyph->region);
     }
     r->procs->free(font->glyphs);
 }
@@ -965,11 +1526,11 @@ get_text_size(const char *string, Font *font, f32 line_height, bool break_lines)
         Glyph *glyph = &font->glyphs[*text_cursor];
         if(!glyph) continue;
         
-        vec2 draw_size = make_vec2(glyph->tex.width * scale,
-                                   glyph->tex.height * scale);
+        vec2 draw_size = make_vec2(glyph->width * scale,
+                                   glyph->height * scale);
         
         x_cursor += (glyph->advance * font->scale_factor) * scale;
-        if(text_cursor + 1) {
+        if(*(text_cursor + 1)) {
             i32 kern = get_kerning_advance(font, *text_cursor, *(text_cursor + 1));
             x_cursor += ((f32)kern * font->scale_factor) * scale;
         }
@@ -1082,6 +1643,22 @@ create_shader_program(Renderer *r, const char *path) {
     return shader_program;
 }
 
+// NOTE: quad_instanced_vertex_source with the file's fragment stage
+static ShaderProgram 
+create_instanced_shader_program(Renderer *r, const char *path) {
+    ShaderProgram shader_program = {};
+    FileContents shader_file;
+    if(r->procs->read_file(&shader_file, path, true)) {
+        ShaderSource shader_src;
+        if(get_shader_source_info(&shader_src, (char *)shader_file.contents, shader_file.size)) {
+            shader_program = r->api.create_shader(quad_instanced_vertex_source, size_array(quad_instanced_vertex_source) - 1, 
+                                                  shader_src.fragment, (i32)shader_src.fragment_len);
+        }
+        r->procs->free_file(&shader_file);
+    }
+    return shader_program;
+}
+
 static void
 delete_shader_program(Renderer *r, ShaderProgram *shader_program) {
     r->api.delete_shader(shader_program);
@@ -1103,6 +1680,8 @@ create_shader(Renderer *r, const char *path) {
     ref->array_id = r->shader_count;
     ref->last_write_time = r->procs->last_write_time(path);
     ref->shader = shader;
+    ref->instanced = create_instanced_shader_program(r, path);
+    ref->shader.ref = ref;
     ++r->shader_count;
     return ref;
 }
@@ -1120,6 +1699,9 @@ create_shader(Renderer *r, char *vertex, i32 vertex_len, char *fragment, i32 fra
     copy_memory((void *)name, (void *)ref->name, min_value(strlen(name), size_array(ref->name)));
     ref->array_id = r->shader_count;
     ref->shader = shader;
+    ref->instanced = r->api.create_shader(quad_instanced_vertex_source, size_array(quad_instanced_vertex_source) - 1, 
+                                          fragment, fragment_len);
+    ref->shader.ref = ref;
     ++r->shader_count;
     return ref;
 }
@@ -1143,10 +1725,106 @@ unbind_shader(Renderer *r) {
     r->api.unbind_shader();
 }
 
-static bool set_uniform_int(Renderer *r, ShaderProgram *shader,    const char *name, i32 v)    { return r->api.set_uniform_int(shader, name, v); }
-static bool set_uniform_float(Renderer *r, ShaderProgram *shader,  const char *name, f32 v)    { return r->api.set_uniform_float(shader, name, v); }
-static bool set_uniform_float2(Renderer *r, ShaderProgram *shader, const char *name, vec2 v)   { return r->api.set_uniform_float2(shader, name, v); }
-static bool set_uniform_float3(Renderer *r, ShaderProgram *shader, const char *name, vec3 v)   { return r->api.set_uniform_float3(shader, name, v); }
-static bool set_uniform_float4(Renderer *r, ShaderProgram *shader, const char *name, vec4 v)   { return r->api.set_uniform_float4(shader, name, v); }
-static bool set_uniform_mat4x4(Renderer *r, ShaderProgram *shader, const char *name, mat4x4 v) { return r->api.set_uniform_mat4x4(shader, name, v); }
-static bool set_uniform_int_array(Renderer *r, ShaderProgram *shader, const char *name, i32 *v, u32 count) { return r->api.set_uniform_int_array(shader, name, v, count); }
\ No newline at end of file
+// NOTE: nullptr when the shader has no instanced version, flush then draws its quads as vertices
+static ShaderProgram *
+get_instanced_shader(Renderer *r, ShaderProgram *shader) {
+    if(!shader || !shader->id || !shader->ref) {
+        return nullptr;
+    }
+    ShaderRef *ref = shader->ref;
+    return ref->instanced.id ? &ref->instanced : nullptr;
+}
+
+// NOTE: 'name' is separate, uniforms that don't fit the table are set with the caller's name
+static void
+apply_shader_uniform(Renderer *r, ShaderProgram *shader, const char *name, ShaderUniform *uniform) {
+    switch(uniform->type) {
+        case UNIFORM_int:    { r->api.set_uniform_int(shader, name, uniform->i);     } break;
+        case UNIFORM_float:  { r->api.set_uniform_float(shader, name, uniform->f);   } break;
+        case UNIFORM_float2: { r->api.set_uniform_float2(shader, name, uniform->v2); } break;
+        case UNIFORM_float3: { r->api.set_uniform_float3(shader, name, uniform->v3); } break;
+        case UNIFORM_float4: { r->api.set_uniform_float4(shader, name, uniform->v4); } break;
+        case UNIFORM_mat4x4: {
+            mat4x4 m;
+            copy_memory(uniform->m, m.e, sizeof(m.e));
+            r->api.set_uniform_mat4x4(shader, name, m);
+        } break;
+        default: { assert(0); }
+    }
+}
+
+// NOTE: keeps the value until draw_batch switches to the instanced version, opengl sets
+// uniforms on the bound program so setting them right away would take two binds each
+static void
+set_instanced_uniform(Renderer *r, ShaderProgram *shader, const char *name, u32 type, void *value, u32 size) {
+    ShaderProgram *instanced = get_instanced_shader(r, shader);
+    if(!instanced) {
+        return;
+    }
+    
+    ShaderRef *ref = shader->ref;
+    ShaderUniform *uniform = nullptr;
+    for(u32 i = 0; i < ref->instanced_uniform_count && !uniform; ++i) {
+        if(compare_strings(ref->instanced_uniforms[i].name, name)) {
+            uniform = &ref->instanced_uniforms[i];
+        }
+    }
+    
+    u32 name_len = (u32)strlen(name);
+    if(!uniform && ref->instanced_uniform_count < size_array(ref->instanced_uniforms) && 
+       name_len < size_array(ref->instanced_uniforms[0].name)) {
+        uniform = &ref->instanced_uniforms[ref->instanced_uniform_count++];
+        copy_memory((void *)name, uniform->name, name_len);
+    }
+    
+    // NOTE: no room in the table or the name doesn't fit, it goes to the instanced version right away
+    if(!uniform) {
+        ShaderUniform overflow = {};
+        overflow.type = type;
+        copy_memory(value, &overflow.i, size);
+        r->api.bind_shader(instanced);
+        apply_shader_uniform(r, instanced, name, &overflow);
+        if(r->bound_shader) { r->api.bind_shader(r->bound_shader); } else { r->api.unbind_shader(); }
+        return;
+    }
+    
+    uniform->type = type;
+    copy_memory(value, &uniform->i, size);
+    uniform->dirty = true;
+    ref->instanced_dirty = true;
+}
+
+// NOTE: the instanced version has to be bound
+static void
+flush_instanced_uniforms(Renderer *r, ShaderRef *ref) {
+    if(!ref || !ref->instanced_dirty) {
+        return;
+    }
+    for(u32 i = 0; i < ref->instanced_uniform_count; ++i) {
+        ShaderUniform *uniform = &ref->instanced_uniforms[i];
+        if(uniform->dirty) {
+            apply_shader_uniform(r, &ref->instanced, uniform->name, uniform);
+            uniform->dirty = false;
+        }
+    }
+    ref->instanced_dirty = false;
+}
+
+static bool set_uniform_int(Renderer *r, ShaderProgram *shader,    const char *name, i32 v)    { set_instanced_uniform(r, shader, name, UNIFORM_int,    &v, sizeof(v));   return r->api.set_uniform_int(shader, name, v); }
+static bool set_uniform_float(Renderer *r, ShaderProgram *shader,  const char *name, f32 v)    { set_instanced_uniform(r, shader, name, UNIFORM_float,  &v, sizeof(v));   return r->api.set_uniform_float(shader, name, v); }
+static bool set_uniform_float2(Renderer *r, ShaderProgram *shader, const char *name, vec2 v)   { set_instanced_uniform(r, shader, name, UNIFORM_float2, &v, sizeof(v));   return r->api.set_uniform_float2(shader, name, v); }
+static bool set_uniform_float3(Renderer *r, ShaderProgram *shader, const char *name, vec3 v)   { set_instanced_uniform(r, shader, name, UNIFORM_float3, &v, sizeof(v));   return r->api.set_uniform_float3(shader, name, v); }
+static bool set_uniform_float4(Renderer *r, ShaderProgram *shader, const char *name, vec4 v)   { set_instanced_uniform(r, shader, name, UNIFORM_float4, &v, sizeof(v));   return r->api.set_uniform_float4(shader, name, v); }
+static bool set_uniform_mat4x4(Renderer *r, ShaderProgram *shader, const char *name, mat4x4 v) { set_instanced_uniform(r, shader, name, UNIFORM_mat4x4, v.e, sizeof(v.e)); return r->api.set_uniform_mat4x4(shader, name, v); }
+
+// NOTE: arrays are set once after a shader is made, they go to the instanced version right away
+static bool 
+set_uniform_int_array(Renderer *r, ShaderProgram *shader, const char *name, i32 *v, u32 count) {
+    ShaderProgram *instanced = get_instanced_shader(r, shader);
+    if(instanced) {
+        r->api.bind_shader(instanced);
+        r->api.set_uniform_int_array(instanced, name, v, count);
+        if(r->bound_shader) { r->api.bind_shader(r->bound_shader); } else { r->api.unbind_shader(); }
+    }
+    return r->api.set_uniform_int_array(shader, name, v, count);
+}
\ No newline at end of file
@@ -93,6 +93,8 @@ enum tex_format {
     FORMAT_rgb8,
     FORMAT_rgba,
     FORMAT_rgba8,
+    FORMAT_red,
+    FORMAT_r8,
     FORMAT_depth_stencil,
     FORMAT_depth24_stencil8,
 };
@@ -126,8 +128,48 @@ typedef CREATE_TEXTURE_2D_PROC(create_texture_2d_proc);
 #define DELETE_TEXTURE_2D_PROC(name) void name(Texture2D *tex)
 typedef DELETE_TEXTURE_2D_PROC(delete_texture_2d_proc);
 
-struct Glyph {
+// NOTE: 'data' is width * height texels of tex->channels bytes, tightly packed
+#define UPDATE_TEXTURE_2D_PROC(name) void name(Texture2D *tex, i32 x, i32 y, i32 width, i32 height, u8 *data)
+typedef UPDATE_TEXTURE_2D_PROC(update_texture_2d_proc);
+
+// NOTE: a rect of a texture, 'tex' is a copy of the page's handle for images packed into a TextureAtlas
+struct TextureRegion {
     Texture2D tex;
+    vec2 uv_min;
+    vec2 uv_max;
+    bool in_atlas;
+};
+
+// NOTE: pages of images packed on shelves, one texture slot draws everything on a page.
+// Pages are made on demand, all of them with the atlas' params and 4 channels
+#define ATLAS_PAGE_SIZE   2048
+#define ATLAS_MAX_PAGES   4
+#define ATLAS_MAX_SHELVES 128
+#define ATLAS_PADDING     2 // NOTE: empty texels between images
+
+struct AtlasShelf {
+    i32 y;
+    i32 height;
+    i32 used_width;
+};
+
+struct AtlasPage {
+    Texture2D tex;
+    AtlasShelf shelves[ATLAS_MAX_SHELVES];
+    u32 shelf_count;
+    i32 used_height;
+};
+
+struct TextureAtlas {
+    Texture2DParams params;
+    u32 page_count;
+    AtlasPage pages[ATLAS_MAX_PAGES];
+};
+
+struct Glyph {
+    TextureRegion region;
+    i32 width;
+    i32 height;
     i32 y_offset;
     i32 left_side_bearing;
     i32 advance;
@@ -153,10 +195,39 @@ struct Font {
     KerningEntry *kerning_entries;
 };
 
+struct ShaderRef;
+
 struct ShaderProgram {
     u32 id;
+    ShaderRef *ref; // NOTE: set on ShaderRef::shader, gets to the instanced version without a search
+};
+
+enum shader_uniform_type {
+    UNIFORM_int,
+    UNIFORM_float,
+    UNIFORM_float2,
+    UNIFORM_float3,
+    UNIFORM_float4,
+    UNIFORM_mat4x4,
+};
+
+// NOTE: last value set on a shader for its instanced version
+struct ShaderUniform {
+    char name[32];
+    u32  type;
+    bool dirty;
+    union {
+        i32  i;
+        f32  f;
+        vec2 v2;
+        vec3 v3;
+        vec4 v4;
+        f32  m[16];
+    };
 };
 
+#define SHADER_MAX_INSTANCED_UNIFORMS 48
+
 struct ShaderRef {
     bool loaded_from_file;
     union {
@@ -170,6 +241,12 @@ struct ShaderRef {
     };
     u32 array_id;
     ShaderProgram shader;
+    ShaderProgram instanced; // NOTE: quad_instanced_vertex_source with this shader's fragment stage
+    
+    // NOTE: draw_batch sets the dirty ones when it switches to 'instanced'
+    ShaderUniform instanced_uniforms[SHADER_MAX_INSTANCED_UNIFORMS];
+    u32 instanced_uniform_count;
+    bool instanced_dirty;
 };
 
 struct ShaderSource {
@@ -217,12 +294,14 @@ typedef SET_UNIFORM_INT_ARRAY_PROC(set_uniform_int_array_proc);
 enum layout_data_type {
     LAYOUT_int32,
     LAYOUT_float32,
+    LAYOUT_uint8,
 };
 
 inline u32 size_of_layout_data_type(layout_data_type type) {
     switch(type) {
         case LAYOUT_int32:    return sizeof(i32);
         case LAYOUT_float32:  return sizeof(f32);
+        case LAYOUT_uint8:    return sizeof(u8);
         default: assert(0);   return 0;
     }
 }
@@ -240,6 +319,7 @@ struct LayoutElement {
 struct BufferLayout {
     u32 stride;
     u32 element_count;
+    bool per_instance; // NOTE: attributes advance once per instance instead of once per vertex
     LayoutElement elements[MAX_BUFFER_LAYOUT_ELEMENTS];
     
     void push(u32 count, layout_data_type type, const char *name, bool normalized = false) {
@@ -354,12 +434,20 @@ typedef DRAW_BUFFERS_INDEXED_PROC(draw_buffers_indexed_proc);
 #define DRAW_INDEXED_PROC(name) void name(VertexArray *va, u32 count)
 typedef DRAW_INDEXED_PROC(draw_indexed_proc);
 
+#define DRAW_INSTANCED_PROC(name) void name(VertexArray *va, u32 count, u32 instance_count)
+typedef DRAW_INSTANCED_PROC(draw_instanced_proc);
+
+// NOTE: RGBA8 rows bottom up like glReadPixels, 'fb' nullptr reads the backbuffer
+#define READ_PIXELS_PROC(name) bool name(Framebuffer *fb, i32 x, i32 y, i32 width, i32 height, u8 *dest)
+typedef READ_PIXELS_PROC(read_pixels_proc);
+
 #define INITIALIZE_PROC(name) bool name(void)
 typedef INITIALIZE_PROC(initialize_proc);
 
 enum rendering_backend {
     BACKEND_none,
     BACKEND_opengl,
+    BACKEND_software,
 };
 
 struct RendererAPI {
@@ -369,6 +457,7 @@ struct RendererAPI {
     unbind_texture_2d_proc            *unbind_texture_2d;
     create_texture_2d_proc            *create_texture_2d;
     delete_texture_2d_proc            *delete_texture_2d;
+    update_texture_2d_proc            *update_texture_2d;
     bind_shader_proc                  *bind_shader;
     unbind_shader_proc                *unbind_shader;
     create_shader_proc                *create_shader;
@@ -401,6 +490,8 @@ struct RendererAPI {
     draw_buffers_proc                 *draw_buffers;
     draw_buffers_indexed_proc         *draw_buffers_indexed;
     draw_indexed_proc                 *draw_indexed;
+    draw_instanced_proc               *draw_instanced;
+    read_pixels_proc                  *read_pixels;
     initialize_proc                   *initialize;
 };
 
@@ -423,6 +514,9 @@ is_renderer_api_valid(RendererAPI *api) {
 
 struct SpriteSheet {
     Texture2D tex;
+    vec2 uv_min; // NOTE: the sheet's rect in 'tex', not the whole texture when it's in an atlas
+    vec2 uv_max;
+    bool in_atlas;
     u32 ss_width;
     u32 ss_height;
     u32 x_pixels_per_sprite;
@@ -453,11 +547,48 @@ struct QuadVertex {
     vec2  tiling_factor;
 };
 
+// NOTE: one rectangle for the instanced path, corner c in [0, 1]^2 lands on
+// position + rotate(rotation, (c - 0.5) * size) and samples lerp(uv_rect.xy, uv_rect.zw, c).
+// A negative size.y is a mirrored quad.
+struct QuadInstance {
+    vec3 position;
+    vec2 size;
+    f32  rotation;
+    vec4 uv_rect;
+    u32  color; // NOTE: RGBA8, red in the low byte
+    f32  tex_slot;
+};
+
+// NOTE: tilemap.glsl draws a grid of u8 tile types from an r8 texture in one quad, the type
+// picks the sprite rect and color out of u_tile_rects and u_tile_colors
+#define TILE_MAP_MAX_TYPES 16
+
 struct RenderStats {
     u32 quad_count;
     u32 draw_calls;
+    u32 upload_bytes;
+    u32 immediate_draw_calls; // NOTE: what drawing the quads in submission order would have taken
+};
+
+// NOTE: a recorded quad, its vertices are at 'index' * 4 in command_vertices. Sorting by key
+// groups textures inside a layer and keeps submission order otherwise.
+struct RenderCommand {
+    u64 key;
+    u32 index;
+    u32 tex_id;
+    bool instanced; // NOTE: the quad is in command_instances, not command_vertices
+};
+
+// NOTE: the highest layer drawn into a cell of the screen so far and its texture, 'mixed' when
+// more than one texture is on that layer. A quad only waits on quads it might overlap.
+struct RenderGridCell {
+    u32 layer;
+    u32 tex_id;
+    b32 mixed;
 };
 
+#define RENDER_GRID_SIZE 32
+
 struct Renderer {
     RendererAPI api;
     PlatformProcs *procs;
@@ -477,6 +608,11 @@ struct Renderer {
     u32 max_quad_indices;
     u32 max_texture_slots;
     VertexArray  quad_va;
+    VertexArray  instance_va;
+    VertexBuffer instance_vb;
+    IndexBuffer  instance_ib;
+    QuadInstance *instance_data;
+    u32           instance_count;
     VertexBuffer quad_vb;
     IndexBuffer  quad_ib;
     QuadVertex  *quad_vb_data;
@@ -484,6 +620,17 @@ struct Renderer {
     u32         *texture_slots;
     u32          texture_count;
     u32          quad_count;
+    
+    u32            command_count;
+    RenderCommand *commands;
+    RenderCommand *sorted_commands;
+    QuadVertex    *command_vertices;
+    QuadInstance  *command_instances;
+    RenderGridCell grid[RENDER_GRID_SIZE * RENDER_GRID_SIZE];
+    
+    u32 *immediate_slots;
+    u32  immediate_texture_count;
+    u32  immediate_quad_count;
     ShaderProgram *bound_shader;
     Framebuffer   *bound_framebuffer;
     
@@ -516,7 +663,7 @@ static void disable_clip_rect(Renderer *r);
 static void clear(void);
 static void flush(Renderer *r);
 
-static u32  bind_next_batch_texture_slot(Renderer *r, Texture2D *tex);
+static u32  bind_next_batch_texture_slot(Renderer *r, u32 tex_id);
 static void draw_quad_base(Renderer *r, vec3 positions[4], vec2 tex_coords[4], vec4 color, Texture2D *tex, vec2 tiling_factor);
 
 struct QuadExParams {
@@ -561,22 +708,33 @@ static void draw_quad_rotated(Renderer *r, vec3 position, vec2 size, f32 rotatio
 static void draw_quad_rotated(Renderer *r, vec2 position, vec2 size, f32 rotation, vec4 color = WHITE(1.0f), Texture2D *tex = nullptr, vec2 tiling_factor = {1.0f, 1.0f});
 static void draw_quad_rotated(Renderer *r, vec3 position, vec2 size, f32 rotation, SpriteSheetTile ss_tile, vec4 color = WHITE(1.0f));
 static void draw_quad_rotated(Renderer *r, vec2 position, vec2 size, f32 rotation, SpriteSheetTile ss_tile, vec4 color = WHITE(1.0f));
+static void draw_quad(Renderer *r, vec3 position, vec2 size, vec4 color, TextureRegion *region);
+static void draw_quad_rotated(Renderer *r, vec3 position, vec2 size, f32 rotation, vec4 color, TextureRegion *region);
 static void draw_quad_outline(Renderer *r, vec3 position, vec2 size, f32 width, vec4 color = WHITE(1.0f));
 static void draw_quad_outline(Renderer *r, vec2 position, vec2 size, f32 width, vec4 color = WHITE(1.0f));
-static void draw_text(Renderer *r, char *buffer, vec3 position, f32 line_height, Font *loaded_font, vec4 color = WHITE(1.0f), bool break_lines = false);
-static void draw_text(Renderer *r, char *buffer, vec2 position, f32 line_height, Font *loaded_font, vec4 color = WHITE(1.0f), bool break_lines = false);
+static void draw_text(Renderer *r, const char *buffer, vec3 position, f32 line_height, Font *loaded_font, vec4 color = WHITE(1.0f), bool break_lines = false);
+static void draw_text(Renderer *r, const char *buffer, vec2 position, f32 line_height, Font *loaded_font, vec4 color = WHITE(1.0f), bool break_lines = false);
 
 static Texture2D   create_texture_2d(Renderer *r, u8 *data, i32 width, i32 height, i32 channels, Texture2DParams *params = nullptr);
 static Texture2D   create_texture_2d(Renderer *r, const char *path, Texture2DParams *params = nullptr);
 static void        delete_texture_2d(Renderer *r, Texture2D *tex);
+static void        update_texture_2d(Renderer *r, Texture2D *tex, i32 x, i32 y, i32 width, i32 height, u8 *data);
 static void        bind_texture_2d(Renderer *r, u32 tex_id, u32 unit = 0);
 static void        unbind_texture_2d(Renderer *r, u32 unit = 0);
 
-static SpriteSheet create_sprite_sheet(Renderer *r, u8 *data, i32 width, i32 height, i32 channels, u32 x_pixels_per_sprite, u32 y_pixels_per_sprite, Texture2DParams *params);
-static SpriteSheet create_sprite_sheet(Renderer *r, const char *path, u32 x_pixels_per_sprite, u32 y_pixels_per_sprite, Texture2DParams *params);
+inline TextureRegion make_texture_region(Texture2D tex);
+static TextureRegion create_texture_region(Renderer *r, const char *path, Texture2DParams *params, TextureAtlas *atlas = nullptr);
+static void          delete_texture_region(Renderer *r, TextureRegion *region);
+
+static TextureAtlas create_texture_atlas(Texture2DParams *params);
+static bool         atlas_add_image(Renderer *r, TextureAtlas *atlas, u8 *data, i32 width, i32 height, i32 channels, TextureRegion *region);
+static void         delete_texture_atlas(Renderer *r, TextureAtlas *atlas);
+
+static SpriteSheet create_sprite_sheet(Renderer *r, u8 *data, i32 width, i32 height, i32 channels, u32 x_pixels_per_sprite, u32 y_pixels_per_sprite, Texture2DParams *params, TextureAtlas *atlas = nullptr);
+static SpriteSheet create_sprite_sheet(Renderer *r, const char *path, u32 x_pixels_per_sprite, u32 y_pixels_per_sprite, Texture2DParams *params, TextureAtlas *atlas = nullptr);
 static void        delete_sprite_sheet(Renderer *r, SpriteSheet *ss);
 
-static Font create_font(Renderer *r, char *path, f32 height_in_pixels, Texture2DParams *glyph_params = nullptr);
+static Font create_font(Renderer *r, char *path, f32 height_in_pixels, Texture2DParams *glyph_params = nullptr, TextureAtlas *atlas = nullptr);
 static void delete_font(Renderer *r, Font *font);
 static vec2 get_text_size(const char *string, Font *font, f32 line_height, bool break_lines = false);
 static i32  get_kerning_advance(Font *font, char c0, char c1);
@@ -601,12 +759,17 @@ static void        unbind_framebuffer(Renderer *r);
 
 static ShaderProgram create_shader_program(Renderer *r, char *vertex, i32 vertex_len, char *fragment, i32 fragment_len);
 static ShaderProgram create_shader_program(Renderer *r, const char *path);
+static ShaderProgram create_instanced_shader_program(Renderer *r, const char *path);
 static void          delete_shader_program(Renderer *r, ShaderProgram *shader_program);
 
 static ShaderRef *create_shader(Renderer *r, char *vertex, i32 vertex_len, char *fragment, i32 fragment_len);
 static ShaderRef *create_shader(Renderer *r, const char *path);
 static void       bind_shader(Renderer *r, ShaderProgram *shader_program);
 static void       unbind_shader(Renderer *r);
+static ShaderProgram *get_instanced_shader(Renderer *r, ShaderProgram *shader);
+static void       apply_shader_uniform(Renderer *r, ShaderProgram *shader, const char *name, ShaderUniform *uniform);
+static void       set_instanced_uniform(Renderer *r, ShaderProgram *shader, const char *name, u32 type, void *value, u32 size);
+static void       flush_instanced_uniforms(Renderer *r, ShaderRef *ref);
 
 static bool set_uniform_int(Renderer *r, ShaderProgram *shader,    const char *name, i32 v);
 static bool set_uniform_float(Renderer *r, ShaderProgram *shader,  const char *name, f32 v);
@@ -0,0 +1,213 @@
+static u32 null_next_id = 1;
+
+SET_UNIFORM_INT_PROC(null_set_uniform_int) {
+    return true;
+}
+
+SET_UNIFORM_FLOAT_PROC(null_set_uniform_float) {
+    return true;
+}
+
+SET_UNIFORM_FLOAT2_PROC(null_set_uniform_float2) {
+    return true;
+}
+
+SET_UNIFORM_FLOAT3_PROC(null_set_uniform_float3) {
+    return true;
+}
+
+SET_UNIFORM_FLOAT4_PROC(null_set_uniform_float4) {
+    return true;
+}
+
+SET_UNIFORM_MAT4X4_PROC(null_set_uniform_mat4x4) {
+    return true;
+}
+
+SET_UNIFORM_INT_ARRAY_PROC(null_set_uniform_int_array) {
+    return true;
+}
+
+BIND_TEXTURE_2D_PROC(null_bind_texture_2d) {
+}
+
+UNBIND_TEXTURE_2D_PROC(null_unbind_texture_2d) {
+}
+
+CREATE_TEXTURE_2D_PROC(null_create_texture_2d) {
+    Texture2D tex = {};
+    tex.id = null_next_id++;
+    tex.width = width;
+    tex.height = height;
+    tex.channels = channels;
+    return tex;
+}
+
+DELETE_TEXTURE_2D_PROC(null_delete_texture_2d) {
+    zero_struct(tex);
+}
+
+UPDATE_TEXTURE_2D_PROC(null_update_texture_2d) {
+}
+
+BIND_SHADER_PROC(null_bind_shader) {
+}
+
+UNBIND_SHADER_PROC(null_unbind_shader) {
+}
+
+CREATE_SHADER_PROC(null_create_shader) {
+    ShaderProgram shader = {};
+    shader.id = null_next_id++;
+    return shader;
+}
+
+DELETE_SHADER_PROC(null_delete_shader) {
+    zero_struct(shader);
+}
+
+CREATE_VERTEX_BUFFER_PROC(null_create_vertex_buffer) {
+    VertexBuffer vb = {};
+    vb.id = null_next_id++;
+    vb.size = size;
+    return vb;
+}
+
+SET_VERTEX_BUFFER_DATA_PROC(null_set_vertex_buffer_data) {
+}
+
+DELETE_VERTEX_BUFFER_PROC(null_delete_vertex_buffer) {
+    zero_struct(vb);
+}
+
+CREATE_INDEX_BUFFER_PROC(null_create_index_buffer) {
+    IndexBuffer ib = {};
+    ib.id = null_next_id++;
+    ib.count = count;
+    return ib;
+}
+
+DELETE_INDEX_BUFFER_PROC(null_delete_index_buffer) {
+    zero_struct(ib);
+}
+
+CREATE_VERTEX_ARRAY_PROC(null_create_vertex_array) {
+    VertexArray va = {};
+    va.id = null_next_id++;
+    return va;
+}
+
+DELETE_VERTEX_ARRAY_PROC(null_delete_vertex_array) {
+    zero_struct(va);
+}
+
+ATTACH_VERTEX_BUFFER_PROC(null_attach_vertex_buffer) {
+    ASSERT(va->vb_count < VERTEX_ARRAY_VBS_MAX, "too many vertex buffers");
+    va->vbs[va->vb_count++] = *vb;
+}
+
+ATTACH_INDEX_BUFFER_PROC(null_attach_index_buffer) {
+    va->ib = *ib;
+}
+
+SET_VIEWPORT_PROC(null_set_viewport) {
+}
+
+CLEAR_PROC(null_clear) {
+}
+
+SET_CLIP_RECT(null_set_clip_rect) {
+}
+
+DISABLE_CLIP_RECT(null_disable_clip_rect) {
+}
+
+CREATE_FRAMEBUFFER_PROC(null_create_framebuffer) {
+    Framebuffer fb = {};
+    fb.id = null_next_id++;
+    fb.width = width;
+    fb.height = height;
+    fb.color = null_create_texture_2d(0, width, height, 4, {});
+    fb.depth = null_create_texture_2d(0, width, height, 1, {});
+    return fb;
+}
+
+RESIZE_FRAMEBUFFER_PROC(null_resize_framebuffer) {
+    null_delete_framebuffer(fb);
+    *fb = null_create_framebuffer(width, height);
+}
+
+DELETE_FRAMEBUFFER_PROC(null_delete_framebuffer) {
+    zero_struct(fb);
+}
+
+BIND_FRAMEBUFFER_PROC(null_bind_framebuffer) {
+}
+
+UNBIND_FRAMEBUFFER_PROC(null_unbind_framebuffer) {
+}
+
+DRAW_BUFFERS_PROC(null_draw_buffers) {
+}
+
+DRAW_BUFFERS_INDEXED_PROC(null_draw_buffers_indexed) {
+}
+
+DRAW_INDEXED_PROC(null_draw_indexed) {
+}
+
+DRAW_INSTANCED_PROC(null_draw_instanced) {
+}
+
+READ_PIXELS_PROC(null_read_pixels) {
+    return false;
+}
+
+INITIALIZE_PROC(null_initialize) {
+    return true;
+}
+
+static void
+get_null_renderer_api(RendererAPI *api) {
+    api->backend = BACKEND_none;
+    api->bind_texture_2d        = null_bind_texture_2d;
+    api->unbind_texture_2d      = null_unbind_texture_2d;
+    api->create_texture_2d      = null_create_texture_2d;
+    api->delete_texture_2d      = null_delete_texture_2d;
+    api->update_texture_2d      = null_update_texture_2d;
+    api->bind_shader            = null_bind_shader;
+    api->unbind_shader          = null_unbind_shader;
+    api->create_shader          = null_create_shader;
+    api->delete_shader          = null_delete_shader;
+    api->set_uniform_int        = null_set_uniform_int;
+    api->set_uniform_float      = null_set_uniform_float;
+    api->set_uniform_float2     = null_set_uniform_float2;
+    api->set_uniform_float3     = null_set_uniform_float3;
+    api->set_uniform_float4     = null_set_uniform_float4;
+    api->set_uniform_mat4x4     = null_set_uniform_mat4x4;
+    api->set_uniform_int_array  = null_set_uniform_int_array;
+    api->create_vertex_buffer   = null_create_vertex_buffer;
+    api->set_vertex_buffer_data = null_set_vertex_buffer_data;
+    api->delete_vertex_buffer   = null_delete_vertex_buffer;
+    api->create_index_buffer    = null_create_index_buffer;
+    api->delete_index_buffer    = null_delete_index_buffer;
+    api->create_vertex_array    = null_create_vertex_array;
+    api->delete_vertex_array    = null_delete_vertex_array;
+    api->attach_vertex_buffer   = null_attach_vertex_buffer;
+    api->attach_index_buffer    = null_attach_index_buffer;
+    api->create_framebuffer     = null_create_framebuffer;
+    api->resize_framebuffer     = null_resize_framebuffer;
+    api->delete_framebuffer     = null_delete_framebuffer;
+    api->bind_framebuffer       = null_bind_framebuffer;
+    api->unbind_framebuffer     = null_unbind_framebuffer;
+    api->set_viewport           = null_set_viewport;
+    api->clear                  = null_clear;
+    api->set_clip_rect          = null_set_clip_rect;
+    api->disable_clip_rect      = null_disable_clip_rect;
+    api->draw_buffers           = null_draw_buffers;
+    api->draw_buffers_indexed   = null_draw_buffers_indexed;
+    api->draw_indexed           = null_draw_indexed;
+    api->draw_instanced         = null_draw_instanced;
+    api->read_pixels            = null_read_pixels;
+    api->initialize             = null_initialize;
+}
@@ -0,0 +1,50 @@
+#ifndef P_RENDERER_NULL_H
+#define P_RENDERER_NULL_H
+
+// NOTE: backend for headless runs, everything is accepted and nothing is drawn. Created objects
+// get a non zero id and keep their sizes, so the game can't tell them from the real ones.
+
+SET_UNIFORM_INT_PROC(null_set_uniform_int);
+SET_UNIFORM_FLOAT_PROC(null_set_uniform_float);
+SET_UNIFORM_FLOAT2_PROC(null_set_uniform_float2);
+SET_UNIFORM_FLOAT3_PROC(null_set_uniform_float3);
+SET_UNIFORM_FLOAT4_PROC(null_set_uniform_float4);
+SET_UNIFORM_MAT4X4_PROC(null_set_uniform_mat4x4);
+SET_UNIFORM_INT_ARRAY_PROC(null_set_uniform_int_array);
+BIND_TEXTURE_2D_PROC(null_bind_texture_2d);
+UNBIND_TEXTURE_2D_PROC(null_unbind_texture_2d);
+CREATE_TEXTURE_2D_PROC(null_create_texture_2d);
+DELETE_TEXTURE_2D_PROC(null_delete_texture_2d);
+UPDATE_TEXTURE_2D_PROC(null_update_texture_2d);
+BIND_SHADER_PROC(null_bind_shader);
+UNBIND_SHADER_PROC(null_unbind_shader);
+CREATE_SHADER_PROC(null_create_shader);
+DELETE_SHADER_PROC(null_delete_shader);
+CREATE_VERTEX_BUFFER_PROC(null_create_vertex_buffer);
+SET_VERTEX_BUFFER_DATA_PROC(null_set_vertex_buffer_data);
+DELETE_VERTEX_BUFFER_PROC(null_delete_vertex_buffer);
+CREATE_INDEX_BUFFER_PROC(null_create_index_buffer);
+DELETE_INDEX_BUFFER_PROC(null_delete_index_buffer);
+CREATE_VERTEX_ARRAY_PROC(null_create_vertex_array);
+DELETE_VERTEX_ARRAY_PROC(null_delete_vertex_array);
+ATTACH_VERTEX_BUFFER_PROC(null_attach_vertex_buffer);
+ATTACH_INDEX_BUFFER_PROC(null_attach_index_buffer);
+SET_VIEWPORT_PROC(null_set_viewport);
+CLEAR_PROC(null_clear);
+SET_CLIP_RECT(null_set_clip_rect);
+DISABLE_CLIP_RECT(null_disable_clip_rect);
+CREATE_FRAMEBUFFER_PROC(null_create_framebuffer);
+RESIZE_FRAMEBUFFER_PROC(null_resize_framebuffer);
+DELETE_FRAMEBUFFER_PROC(null_delete_framebuffer);
+BIND_FRAMEBUFFER_PROC(null_bind_framebuffer);
+UNBIND_FRAMEBUFFER_PROC(null_unbind_framebuffer);
+DRAW_BUFFERS_PROC(null_draw_buffers);
+DRAW_BUFFERS_INDEXED_PROC(null_draw_buffers_indexed);
+DRAW_INDEXED_PROC(null_draw_indexed);
+DRAW_INSTANCED_PROC(null_draw_instanced);
+READ_PIXELS_PROC(null_read_pixels);
+INITIALIZE_PROC(null_initialize);
+
+static void get_null_renderer_api(RendererAPI *api);
+
+#endif /* P_RENDERER_NULL_H */
@@ -17,6 +17,7 @@ opengl_layout_data_type(layout_data_type type) {
     switch(type) {
         case LAYOUT_int32:   return GL_INT;
         case LAYOUT_float32: return GL_FLOAT;
+        case LAYOUT_uint8:   return GL_UNSIGNED_BYTE;
         default: ASSERT(false, "opengl: layout data type...");
     }
     return 0;
@@ -29,6 +30,8 @@ opengl_tex_format(tex_format format) {
         case FORMAT_rgb8:             return GL_RGB8;
         case FORMAT_rgba:             return GL_RGBA;
         case FORMAT_rgba8:            return GL_RGBA8;
+        case FORMAT_red:              return GL_RED;
+        case FORMAT_r8:               return GL_R8;
         case FORMAT_depth_stencil:    return GL_DEPTH_STENCIL;
         case FORMAT_depth24_stencil8: return GL_DEPTH24_STENCIL8;
         default: ASSERT(false, "opengl: invalid tex format...");
@@ -83,6 +86,7 @@ opengl_set_attrib_pointers(VertexBuffer *vbs, u32 vb_count) {
             
             glEnableVertexAttribArray(location);
             glVertexAttribPointer(location, e->count, type, normalized, layout->stride, (void *)((u64)e->offset));
+            glVertexAttribDivisor(location, layout->per_instance ? 1 : 0);
             ++location;
         }
     }
@@ -100,6 +104,7 @@ opengl_set_attrib_pointers(VertexBuffer vb, u32 starting_location) {
         u32 location = starting_location + element_id;
         glEnableVertexAttribArray(location);
         glVertexAttribPointer(location, e.count, type, normalized, layout.stride, (void *)((u64)e.offset));
+        glVertexAttribDivisor(location, layout.per_instance ? 1 : 0);
         ++location;
     }
 }
@@ -205,6 +210,12 @@ DELETE_TEXTURE_2D_PROC(opengl_delete_texture_2d) {
     zero_struct(tex);
 }
 
+UPDATE_TEXTURE_2D_PROC(opengl_update_texture_2d) {
+    GLenum formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+    GLenum data_format = formats[clamp(tex->channels, 1, 4) - 1];
+    glTextureSubImage2D(tex->id, 0, x, y, width, height, data_format, GL_UNSIGNED_BYTE, data);
+}
+
 BIND_SHADER_PROC(opengl_bind_shader) {
     glUseProgram(shader->id);
 }
@@ -426,6 +437,20 @@ DRAW_INDEXED_PROC(opengl_draw_indexed) {
     glDrawElements(GL_TRIANGLES, draw_count, GL_UNSIGNED_INT, nullptr);
 }
 
+DRAW_INSTANCED_PROC(opengl_draw_instanced) {
+    u32 draw_count = count ? count : va->ib.count;
+    
+    glBindVertexArray(va->id);
+    glDrawElementsInstanced(GL_TRIANGLES, draw_count, GL_UNSIGNED_INT, nullptr, instance_count);
+}
+
+READ_PIXELS_PROC(opengl_read_pixels) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fb ? fb->id : 0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, dest);
+    return glGetError() == GL_NO_ERROR;
+}
+
 INITIALIZE_PROC(opengl_initialize) {
 #if 0    
     glEnable(GL_CULL_FACE);
@@ -436,6 +461,8 @@ INITIALIZE_PROC(opengl_initialize) {
     glDepthFunc(GL_LEQUAL);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // NOTE: texture data is tightly packed, single channel rows aren't always 4 byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
     return true;
 }
@@ -447,6 +474,7 @@ get_renderer_api(RendererAPI *api) {
     api->unbind_texture_2d      = opengl_unbind_texture_2d;
     api->create_texture_2d      = opengl_create_texture_2d;
     api->delete_texture_2d      = opengl_delete_texture_2d;
+    api->update_texture_2d      = opengl_update_texture_2d;
     api->bind_shader            = opengl_bind_shader;
     api->unbind_shader          = opengl_unbind_shader;
     api->create_shader          = opengl_create_shader;
@@ -479,5 +507,7 @@ get_renderer_api(RendererAPI *api) {
     api->draw_buffers           = opengl_draw_buffers;
     api->draw_buffers_indexed   = opengl_draw_buffers_indexed;
     api->draw_indexed           = opengl_draw_indexed;
+    api->draw_instanced         = opengl_draw_instanced;
+    api->read_pixels            = opengl_read_pixels;
     api->initialize             = opengl_initialize;
 }
\ No newline at end of file
@@ -3,7 +3,7 @@
 
 #include <GL/glew.h>
 
-#define opengl_printf(str, ...) printf(str, __VA_ARGS__)
+#define opengl_printf(str, ...) printf(str, ##__VA_ARGS__)
 
 inline const char *opengl_get_error_msg(GLenum error_code);
 inline GLenum opengl_layout_data_type(layout_data_type type);
@@ -25,6 +25,7 @@ BIND_TEXTURE_2D_PROC(opengl_bind_texture_2d);
 UNBIND_TEXTURE_2D_PROC(opengl_unbind_texture_2d);
 CREATE_TEXTURE_2D_PROC(opengl_create_texture_2d);
 DELETE_TEXTURE_2D_PROC(opengl_delete_texture_2d);
+UPDATE_TEXTURE_2D_PROC(opengl_update_texture_2d);
 BIND_SHADER_PROC(opengl_bind_shader);
 UNBIND_SHADER_PROC(opengl_unbind_shader);
 CREATE_SHADER_PROC(opengl_create_shader);
@@ -50,6 +51,8 @@ UNBIND_FRAMEBUFFER_PROC(opengl_unbind_framebuffer);
 DRAW_BUFFERS_PROC(opengl_draw_buffers);
 DRAW_BUFFERS_INDEXED_PROC(opengl_draw_buffers_indexed);
 DRAW_INDEXED_PROC(opengl_draw_indexed);
+DRAW_INSTANCED_PROC(opengl_draw_instanced);
+READ_PIXELS_PROC(opengl_read_pixels);
 INITIALIZE_PROC(opengl_initialize);
 
 static void get_renderer(Renderer *r);
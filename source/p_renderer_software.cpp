@@ -0,0 +1,1492 @@
+static SoftwareRenderer software_renderer;
+
+// NOTE: new elements are zeroed
+static void
+software_grow(void **array, u32 *capacity, u32 needed, u32 element_size) {
+    if(needed <= *capacity) {
+        return;
+    }
+    u32 new_capacity = max_value(needed, max_value(*capacity * 2, 16));
+    bool grown = software_renderer.procs->realloc(array, (size_t)new_capacity * element_size);
+    ASSERT(grown, "software: out of memory...\n");
+    zero_memory((u8 *)*array + (size_t)*capacity * element_size, (size_t)(new_capacity - *capacity) * element_size);
+    *capacity = new_capacity;
+}
+
+inline recti32
+software_intersect(recti32 a, recti32 b) {
+    i32 x0 = max_value(a.x, b.x);
+    i32 y0 = max_value(a.y, b.y);
+    i32 x1 = min_value(a.x + a.width,  b.x + b.width);
+    i32 y1 = min_value(a.y + a.height, b.y + b.height);
+    recti32 result = { x0, y0, max_value(x1 - x0, 0), max_value(y1 - y0, 0) };
+    return result;
+}
+
+inline SoftwareTexture *
+software_get_texture(u32 id) {
+    SoftwareRenderer *sr = &software_renderer;
+    if(id == 0 || id > sr->texture_capacity || !sr->textures[id - 1].in_use) {
+        return nullptr;
+    }
+    return &sr->textures[id - 1];
+}
+
+inline SoftwareBuffer *
+software_get_buffer(u32 id) {
+    SoftwareRenderer *sr = &software_renderer;
+    if(id == 0 || id > sr->buffer_capacity || !sr->buffers[id - 1].in_use) {
+        return nullptr;
+    }
+    return &sr->buffers[id - 1];
+}
+
+inline SoftwareShader *
+software_get_shader(u32 id) {
+    SoftwareRenderer *sr = &software_renderer;
+    if(id == 0 || id > SOFTWARE_MAX_SHADERS || !sr->shaders[id - 1].in_use) {
+        return nullptr;
+    }
+    return &sr->shaders[id - 1];
+}
+
+static void
+software_allocate_texels(SoftwareTexture *tex, i32 width, i32 height, bool depth) {
+    tex->width  = max_value(width, 0);
+    tex->height = max_value(height, 0);
+    tex->pitch  = (tex->width + 3) & ~3;
+    tex->depth  = depth;
+    
+    size_t count = (size_t)tex->pitch * (size_t)tex->height;
+    tex->texels = software_renderer.procs->alloc(count * sizeof(u32));
+    if(!tex->texels) {
+        return;
+    }
+    
+    if(depth) {
+        f32 *texels = (f32 *)tex->texels;
+        for(size_t i = 0; i < count; ++i) {
+            texels[i] = 1.0f;
+        }
+    }
+    else {
+        zero_memory(tex->texels, count * sizeof(u32));
+    }
+}
+
+static void
+software_free_texels(SoftwareTexture *tex) {
+    if(tex->texels) {
+        software_renderer.procs->free(tex->texels);
+    }
+    tex->texels = nullptr;
+}
+
+inline u32
+software_pack_texel(u32 r, u32 g, u32 b, u32 a) {
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+inline vec4
+software_unpack_texel(u32 texel) {
+    vec4 result = {
+        (f32)(texel & 0xff),
+        (f32)((texel >> 8) & 0xff),
+        (f32)((texel >> 16) & 0xff),
+        (f32)(texel >> 24)
+    };
+    return result;
+}
+
+inline bool
+software_source_uses(const char *source, i32 source_len, const char *name) {
+    i32 name_len = (i32)strlen(name);
+    for(i32 i = 0; (i + name_len) <= source_len; ++i) {
+        if(compare_memory(source + i, name, name_len)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// NOTE: 'index' of "array[index]", -1 for other names
+static i32
+software_uniform_index(const char *uniform_name, const char *array) {
+    i32 array_len = (i32)strlen(array);
+    if(!compare_memory(uniform_name, array, array_len) || uniform_name[array_len] != '[') {
+        return -1;
+    }
+    i32 index = 0;
+    const char *c = uniform_name + array_len + 1;
+    for(; *c >= '0' && *c <= '9'; ++c) {
+        index = index * 10 + (*c - '0');
+    }
+    return (*c == ']') ? index : -1;
+}
+
+SET_UNIFORM_INT_PROC(software_set_uniform_int) {
+    SoftwareShader *software_shader = software_get_shader(shader->id);
+    if(!software_shader) { return false; }
+    if(compare_strings(uniform_name, "u_textures")) {
+        software_shader->textures[0] = v;
+        return true;
+    }
+    if(compare_strings(uniform_name, "u_tile_map")) {
+        software_shader->tile_map_unit = v;
+        return true;
+    }
+    return false;
+}
+
+SET_UNIFORM_FLOAT_PROC(software_set_uniform_float) {
+    SoftwareShader *software_shader = software_get_shader(shader->id);
+    if(!software_shader || software_shader->shading != SHADING_framebuffer ||
+       !compare_strings(uniform_name, "u_reverse_factor")) { return false; }
+    software_shader->reverse_factor = v;
+    return true;
+}
+
+SET_UNIFORM_FLOAT2_PROC(software_set_uniform_float2) {
+    return false;
+}
+
+SET_UNIFORM_FLOAT3_PROC(software_set_uniform_float3) {
+    return false;
+}
+
+SET_UNIFORM_FLOAT4_PROC(software_set_uniform_float4) {
+    SoftwareShader *software_shader = software_get_shader(shader->id);
+    if(!software_shader) { return false; }
+    i32 rect_index  = software_uniform_index(uniform_name, "u_tile_rects");
+    i32 color_index = software_uniform_index(uniform_name, "u_tile_colors");
+    if(rect_index >= 0 && rect_index < TILE_MAP_MAX_TYPES) {
+        software_shader->tile_rects[rect_index] = v;
+        return true;
+    }
+    if(color_index >= 0 && color_index < TILE_MAP_MAX_TYPES) {
+        software_shader->tile_colors[color_index] = v;
+        return true;
+    }
+    return false;
+}
+
+SET_UNIFORM_MAT4X4_PROC(software_set_uniform_mat4x4) {
+    SoftwareShader *software_shader = software_get_shader(shader->id);
+    if(!software_shader) { return false; }
+    if(compare_strings(uniform_name, "u_proj")) {
+        software_shader->proj = v;
+        return true;
+    }
+    if(compare_strings(uniform_name, "u_view")) {
+        software_shader->view = v;
+        return true;
+    }
+    return false;
+}
+
+SET_UNIFORM_INT_ARRAY_PROC(software_set_uniform_int_array) {
+    SoftwareShader *software_shader = software_get_shader(shader->id);
+    if(!software_shader || !compare_strings(uniform_name, "u_textures")) { return false; }
+    for(u32 i = 0; i < min_value(count, (u32)SOFTWARE_TEXTURE_UNITS); ++i) {
+        software_shader->textures[i] = v[i];
+    }
+    return true;
+}
+
+BIND_TEXTURE_2D_PROC(software_bind_texture_2d) {
+    if(tex_id && unit < SOFTWARE_TEXTURE_UNITS) {
+        software_renderer.bound_textures[unit] = tex_id;
+    }
+}
+
+UNBIND_TEXTURE_2D_PROC(software_unbind_texture_2d) {
+    if(unit < SOFTWARE_TEXTURE_UNITS) {
+        software_renderer.bound_textures[unit] = 0;
+    }
+}
+
+// NOTE: one channel is gray, two are gray and alpha. Like opengl an rgb internal format samples
+// with full alpha and a red one with only red.
+static void
+software_store_texels(SoftwareTexture *tex, i32 x, i32 y, i32 width, i32 height, u8 *data, i32 channels) {
+    bool opaque = (tex->format == FORMAT_rgb || tex->format == FORMAT_rgb8);
+    bool red    = (tex->format == FORMAT_red || tex->format == FORMAT_r8);
+    u32 *texels = (u32 *)tex->texels;
+    for(i32 row = 0; row < height; ++row) {
+        for(i32 column = 0; column < width; ++column) {
+            u8 *source = data + ((size_t)row * width + column) * channels;
+            u32 r = source[0];
+            u32 g = r;
+            u32 b = r;
+            u32 a = 255;
+            if(channels == 2) {
+                a = source[1];
+            }
+            else if(channels >= 3) {
+                g = source[1];
+                b = source[2];
+                a = (channels >= 4) ? source[3] : 255;
+            }
+            if(red) {
+                g = 0;
+                b = 0;
+                a = 255;
+            }
+            texels[(size_t)(y + row) * tex->pitch + x + column] = software_pack_texel(r, g, b, opaque ? 255 : a);
+        }
+    }
+}
+
+CREATE_TEXTURE_2D_PROC(software_create_texture_2d) {
+    SoftwareRenderer *sr = &software_renderer;
+    u32 index = 0;
+    while(index < sr->texture_capacity && sr->textures[index].in_use) {
+        ++index;
+    }
+    software_grow((void **)&sr->textures, &sr->texture_capacity, index + 1, sizeof(SoftwareTexture));
+    
+    SoftwareTexture *software_tex = &sr->textures[index];
+    zero_struct(software_tex);
+    software_tex->in_use = true;
+    software_tex->min_filter = params.min_filter;
+    software_tex->mag_filter = params.mag_filter;
+    software_tex->wrap_s = params.wrap_s;
+    software_tex->wrap_t = params.wrap_t;
+    
+    bool depth = (params.internal_format == FORMAT_depth_stencil || params.internal_format == FORMAT_depth24_stencil8);
+    software_allocate_texels(software_tex, width, height, depth);
+    
+    software_tex->format = params.internal_format;
+    if(data && !depth && software_tex->texels) {
+        software_store_texels(software_tex, 0, 0, width, height, data, channels);
+    }
+    
+    Texture2D tex = {};
+    tex.id = index + 1;
+    tex.width = width;
+    tex.height = height;
+    tex.channels = channels;
+    return tex;
+}
+
+DELETE_TEXTURE_2D_PROC(software_delete_texture_2d) {
+    SoftwareTexture *software_tex = software_get_texture(tex->id);
+    if(software_tex) {
+        software_free_texels(software_tex);
+        zero_struct(software_tex);
+    }
+    zero_struct(tex);
+}
+
+UPDATE_TEXTURE_2D_PROC(software_update_texture_2d) {
+    SoftwareTexture *software_tex = software_get_texture(tex->id);
+    if(!software_tex || !software_tex->texels || software_tex->depth || x < 0 || y < 0 ||
+       (x + width) > software_tex->width || (y + height) > software_tex->height) {
+        return;
+    }
+    software_store_texels(software_tex, x, y, width, height, data, tex->channels);
+}
+
+BIND_SHADER_PROC(software_bind_shader) {
+    software_renderer.bound_shader = shader ? shader->id : 0;
+}
+
+UNBIND_SHADER_PROC(software_unbind_shader) {
+    software_renderer.bound_shader = 0;
+}
+
+CREATE_SHADER_PROC(software_create_shader) {
+    ShaderProgram shader = {};
+    for(u32 i = 0; i < SOFTWARE_MAX_SHADERS; ++i) {
+        SoftwareShader *software_shader = &software_renderer.shaders[i];
+        if(software_shader->in_use) {
+            continue;
+        }
+        
+        zero_struct(software_shader);
+        software_shader->in_use = true;
+        software_shader->shading = SHADING_basic;
+        if(software_source_uses(fragment, fragment_len, "u_tile_map")) {
+            software_shader->shading = SHADING_tilemap;
+        }
+        else if(software_source_uses(fragment, fragment_len, "u_reverse_factor")) {
+            software_shader->shading = SHADING_framebuffer;
+        }
+        software_shader->proj = mat4x4_identity();
+        software_shader->view = mat4x4_identity();
+        shader.id = i + 1;
+        break;
+    }
+    
+    if(!shader.id) {
+        software_log("too many shaders...\n");
+    }
+    return shader;
+}
+
+DELETE_SHADER_PROC(software_delete_shader) {
+    SoftwareShader *software_shader = software_get_shader(shader->id);
+    if(software_shader) {
+        zero_struct(software_shader);
+    }
+}
+
+static u32
+software_create_buffer(void *data, u32 size) {
+    SoftwareRenderer *sr = &software_renderer;
+    u32 index = 0;
+    while(index < sr->buffer_capacity && sr->buffers[index].in_use) {
+        ++index;
+    }
+    software_grow((void **)&sr->buffers, &sr->buffer_capacity, index + 1, sizeof(SoftwareBuffer));
+    
+    SoftwareBuffer *buffer = &sr->buffers[index];
+    buffer->in_use = true;
+    buffer->size = size;
+    buffer->data = (u8 *)sr->procs->alloc(size);
+    if(buffer->data) {
+        if(data) {
+            copy_memory(data, buffer->data, size);
+        }
+        else {
+            zero_memory(buffer->data, size);
+        }
+    }
+    return index + 1;
+}
+
+static void
+software_delete_buffer(u32 id) {
+    SoftwareBuffer *buffer = software_get_buffer(id);
+    if(buffer) {
+        if(buffer->data) {
+            software_renderer.procs->free(buffer->data);
+        }
+        zero_struct(buffer);
+    }
+}
+
+CREATE_VERTEX_BUFFER_PROC(software_create_vertex_buffer) {
+    VertexBuffer vb = {};
+    vb.size = size;
+    vb.layout = {};
+    vb.id = software_create_buffer(data, size);
+    return vb;
+}
+
+SET_VERTEX_BUFFER_DATA_PROC(software_set_vertex_buffer_data) {
+    SoftwareBuffer *buffer = software_get_buffer(vb->id);
+    if(buffer && buffer->data && (offset + size) <= buffer->size) {
+        copy_memory(data, buffer->data + offset, size);
+    }
+}
+
+DELETE_VERTEX_BUFFER_PROC(software_delete_vertex_buffer) {
+    software_delete_buffer(vb->id);
+    zero_struct(vb);
+}
+
+CREATE_INDEX_BUFFER_PROC(software_create_index_buffer) {
+    IndexBuffer ib = {};
+    ib.count = count;
+    ib.id = software_create_buffer(data, count * sizeof(u32));
+    return ib;
+}
+
+DELETE_INDEX_BUFFER_PROC(software_delete_index_buffer) {
+    software_delete_buffer(ib->id);
+    zero_struct(ib);
+}
+
+CREATE_VERTEX_ARRAY_PROC(software_create_vertex_array) {
+    VertexArray va = {};
+    va.id = ++software_renderer.next_object_id;
+    return va;
+}
+
+DELETE_VERTEX_ARRAY_PROC(software_delete_vertex_array) {
+    zero_struct(va);
+}
+
+ATTACH_VERTEX_BUFFER_PROC(software_attach_vertex_buffer) {
+    ASSERT(va->vb_count < VERTEX_ARRAY_VBS_MAX, "too many vertex buffers");
+    va->vbs[va->vb_count++] = *vb;
+}
+
+ATTACH_INDEX_BUFFER_PROC(software_attach_index_buffer) {
+    va->ib = *ib;
+}
+
+SET_VIEWPORT_PROC(software_set_viewport) {
+    software_renderer.viewport = { x, y, width, height };
+}
+
+// NOTE: returns nullptr when there is nothing to draw into
+static SoftwareBatch *
+software_begin_batch(software_batch_type type) {
+    SoftwareRenderer *sr = &software_renderer;
+    SoftwareBatch *batch = &sr->batch;
+    
+    SoftwareTexture *color = &sr->backbuffer;
+    SoftwareTexture *depth = &sr->backbuffer_depth;
+    if(sr->target_color) {
+        color = software_get_texture(sr->target_color);
+        depth = software_get_texture(sr->target_depth);
+    }
+    if(!color || !color->texels || color->depth) {
+        return nullptr;
+    }
+    if(depth && (!depth->texels || !depth->depth || depth->width != color->width || depth->height != color->height)) {
+        depth = nullptr;
+    }
+    
+    batch->type = type;
+    batch->color = color;
+    batch->depth = depth;
+    batch->rect = { 0, 0, color->width, color->height };
+    if(sr->scissor) {
+        batch->rect = software_intersect(batch->rect, sr->scissor_rect);
+    }
+    batch->triangle_count = 0;
+    batch->busy_tile_count = 0;
+    batch->tiles_x = (u32)(color->width  + SOFTWARE_TILE_SIZE - 1) >> SOFTWARE_TILE_SHIFT;
+    batch->tiles_y = (u32)(color->height + SOFTWARE_TILE_SIZE - 1) >> SOFTWARE_TILE_SHIFT;
+    
+    u32 tile_count = batch->tiles_x * batch->tiles_y;
+    software_grow((void **)&batch->tile_offsets, &sr->tile_capacity, tile_count + 1, sizeof(u32));
+    software_grow((void **)&batch->busy_tiles, &sr->busy_tile_capacity, tile_count, sizeof(u32));
+    return batch;
+}
+
+inline __m128
+software_floor(__m128 v) {
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, v), _mm_set1_ps(1.0f)));
+}
+
+// NOTE: 0-255 floats
+inline void
+software_unpack(__m128i pixels, __m128 *r, __m128 *g, __m128 *b, __m128 *a) {
+    __m128i mask = _mm_set1_epi32(0xff);
+    *r = _mm_cvtepi32_ps(_mm_and_si128(pixels, mask));
+    *g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 8), mask));
+    *b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pixels, 16), mask));
+    *a = _mm_cvtepi32_ps(_mm_srli_epi32(pixels, 24));
+}
+
+inline __m128i
+software_pack(__m128 r, __m128 g, __m128 b, __m128 a) {
+    __m128 zero = _mm_setzero_ps();
+    __m128 full = _mm_set1_ps(255.0f);
+    __m128i ir = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(r, zero), full));
+    __m128i ig = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(g, zero), full));
+    __m128i ib = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(b, zero), full));
+    __m128i ia = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(a, zero), full));
+    return _mm_or_si128(_mm_or_si128(ir, _mm_slli_epi32(ig, 8)),
+                        _mm_or_si128(_mm_slli_epi32(ib, 16), _mm_slli_epi32(ia, 24)));
+}
+
+inline i32
+software_wrap(i32 i, i32 size, tex_wrap wrap) {
+    if(wrap == WRAP_repeat) {
+        if((size & (size - 1)) == 0) {
+            return i & (size - 1);
+        }
+        i %= size;
+        return (i < 0) ? (i + size) : i;
+    }
+    return clamp(i, 0, size - 1);
+}
+
+// NOTE: 4 lanes, gathers are scalar
+static void
+software_sample(SoftwareTexture *tex, bool linear, __m128 u, __m128 v, __m128 *r, __m128 *g, __m128 *b, __m128 *a) {
+    __m128 limit = _mm_set1_ps(16777216.0f);
+    __m128 fu = _mm_mul_ps(u, _mm_set1_ps((f32)tex->width));
+    __m128 fv = _mm_mul_ps(v, _mm_set1_ps((f32)tex->height));
+    if(linear) {
+        fu = _mm_sub_ps(fu, _mm_set1_ps(0.5f));
+        fv = _mm_sub_ps(fv, _mm_set1_ps(0.5f));
+    }
+    fu = _mm_min_ps(_mm_max_ps(fu, _mm_sub_ps(_mm_setzero_ps(), limit)), limit);
+    fv = _mm_min_ps(_mm_max_ps(fv, _mm_sub_ps(_mm_setzero_ps(), limit)), limit);
+    __m128 x0 = software_floor(fu);
+    __m128 y0 = software_floor(fv);
+    
+    i32 ix[4];
+    i32 iy[4];
+    _mm_storeu_si128((__m128i *)ix, _mm_cvttps_epi32(x0));
+    _mm_storeu_si128((__m128i *)iy, _mm_cvttps_epi32(y0));
+    
+    u32 *texels = (u32 *)tex->texels;
+    if(!linear) {
+        u32 p[4];
+        for(u32 i = 0; i < 4; ++i) {
+            i32 x = software_wrap(ix[i], tex->width,  tex->wrap_s);
+            i32 y = software_wrap(iy[i], tex->height, tex->wrap_t);
+            p[i] = texels[(size_t)y * tex->pitch + x];
+        }
+        software_unpack(_mm_loadu_si128((__m128i *)p), r, g, b, a);
+        return;
+    }
+    
+    u32 p00[4];
+    u32 p10[4];
+    u32 p01[4];
+    u32 p11[4];
+    for(u32 i = 0; i < 4; ++i) {
+        i32 xa = software_wrap(ix[i],     tex->width,  tex->wrap_s);
+        i32 xb = software_wrap(ix[i] + 1, tex->width,  tex->wrap_s);
+        u32 *row_a = texels + (size_t)software_wrap(iy[i],     tex->height, tex->wrap_t) * tex->pitch;
+        u32 *row_b = texels + (size_t)software_wrap(iy[i] + 1, tex->height, tex->wrap_t) * tex->pitch;
+        p00[i] = row_a[xa];
+        p10[i] = row_a[xb];
+        p01[i] = row_b[xa];
+        p11[i] = row_b[xb];
+    }
+    
+    __m128 tx = _mm_sub_ps(fu, x0);
+    __m128 ty = _mm_sub_ps(fv, y0);
+    __m128 c00[4];
+    __m128 c10[4];
+    __m128 c01[4];
+    __m128 c11[4];
+    software_unpack(_mm_loadu_si128((__m128i *)p00), &c00[0], &c00[1], &c00[2], &c00[3]);
+    software_unpack(_mm_loadu_si128((__m128i *)p10), &c10[0], &c10[1], &c10[2], &c10[3]);
+    software_unpack(_mm_loadu_si128((__m128i *)p01), &c01[0], &c01[1], &c01[2], &c01[3]);
+    software_unpack(_mm_loadu_si128((__m128i *)p11), &c11[0], &c11[1], &c11[2], &c11[3]);
+    
+    __m128 result[4];
+    for(u32 c = 0; c < 4; ++c) {
+        __m128 bottom = _mm_add_ps(c00[c], _mm_mul_ps(_mm_sub_ps(c10[c], c00[c]), tx));
+        __m128 top    = _mm_add_ps(c01[c], _mm_mul_ps(_mm_sub_ps(c11[c], c01[c]), tx));
+        result[c] = _mm_add_ps(bottom, _mm_mul_ps(_mm_sub_ps(top, bottom), ty));
+    }
+    *r = result[0];
+    *g = result[1];
+    *b = result[2];
+    *a = result[3];
+}
+
+// NOTE: 4 lanes of tilemap.glsl, the tile under u, v gives the sprite rect to sample the texture in
+// and the color to multiply by. 'r' - 'a' come in as the flat texel. Tiles with no alpha are discarded.
+static void
+software_sample_tile_map(SoftwareBatch *batch, SoftwareTriangle *tri, bool linear, __m128 u, __m128 v, 
+                         __m128 *r, __m128 *g, __m128 *b, __m128 *a, __m128 *mask) {
+    SoftwareTexture *tile_map = batch->tile_map;
+    f32 lane_u[4];
+    f32 lane_v[4];
+    _mm_storeu_ps(lane_u, u);
+    _mm_storeu_ps(lane_v, v);
+    
+    f32 sprite_u[4];
+    f32 sprite_v[4];
+    f32 tile_color[4][4];
+    u32 keep[4];
+    for(u32 i = 0; i < 4; ++i) {
+        // NOTE: lanes outside the triangle can be anything
+        f32 cell_x = lane_u[i] * (f32)tile_map->width;
+        f32 cell_y = lane_v[i] * (f32)tile_map->height;
+        cell_x = (cell_x >= 0.0f) ? min_value(cell_x, (f32)tile_map->width  - 0.5f) : 0.0f;
+        cell_y = (cell_y >= 0.0f) ? min_value(cell_y, (f32)tile_map->height - 0.5f) : 0.0f;
+        i32 x = (i32)cell_x;
+        i32 y = (i32)cell_y;
+        
+        u32 type = ((u32 *)tile_map->texels)[(size_t)y * tile_map->pitch + x] & 0xff;
+        vec4 rect  = (type < TILE_MAP_MAX_TYPES) ? batch->tile_rects[type]  : make_vec4(0.0f);
+        vec4 color = (type < TILE_MAP_MAX_TYPES) ? batch->tile_colors[type] : make_vec4(0.0f);
+        sprite_u[i] = rect.x + (rect.z - rect.x) * (cell_x - (f32)x);
+        sprite_v[i] = rect.y + (rect.w - rect.y) * (cell_y - (f32)y);
+        for(u32 c = 0; c < 4; ++c) {
+            tile_color[c][i] = color.e[c];
+        }
+        keep[i] = (color.a > 0.0f) ? 0xffffffff : 0;
+    }
+    
+    if(!(tri->flags & SOFTWARE_TRI_flat_texel)) {
+        software_sample(tri->texture, linear, _mm_loadu_ps(sprite_u), _mm_loadu_ps(sprite_v), r, g, b, a);
+    }
+    *r = _mm_mul_ps(*r, _mm_loadu_ps(tile_color[0]));
+    *g = _mm_mul_ps(*g, _mm_loadu_ps(tile_color[1]));
+    *b = _mm_mul_ps(*b, _mm_loadu_ps(tile_color[2]));
+    *a = _mm_mul_ps(*a, _mm_loadu_ps(tile_color[3]));
+    *mask = _mm_and_ps(*mask, _mm_castsi128_ps(_mm_loadu_si128((__m128i *)keep)));
+}
+
+// NOTE: plane 0 is the near plane, plane 1 keeps w positive for the divide
+inline f32
+software_clip_distance(SoftwareVertex *v, u32 plane) {
+    return plane ? (v->position.w - SOFTWARE_MIN_W) : (v->position.z + v->position.w);
+}
+
+static u32
+software_clip_polygon(SoftwareVertex *in, u32 count, SoftwareVertex *out, u32 plane) {
+    u32 out_count = 0;
+    for(u32 i = 0; i < count; ++i) {
+        SoftwareVertex *a = in + i;
+        SoftwareVertex *b = in + (i + 1) % count;
+        f32 da = software_clip_distance(a, plane);
+        f32 db = software_clip_distance(b, plane);
+        if(da >= 0.0f) {
+            out[out_count++] = *a;
+        }
+        if((da >= 0.0f) != (db >= 0.0f)) {
+            f32 t = da / (da - db);
+            SoftwareVertex *v = out + out_count++;
+            v->position  = vec_lerp(a->position,  b->position,  t);
+            v->color     = vec_lerp(a->color,     b->color,     t);
+            v->tex_coord = vec_lerp(a->tex_coord, b->tex_coord, t);
+            v->tex_slot  = a->tex_slot;
+        }
+    }
+    return out_count;
+}
+
+// NOTE: the triangle in screen space, nothing is added when it covers no pixel center
+static void
+software_setup_triangle(SoftwareBatch *batch, SoftwareTexture *texture, SoftwareVertex *v0, SoftwareVertex *v1, SoftwareVertex *v2) {
+    recti32 vp = software_renderer.viewport;
+    SoftwareVertex *v[3] = { v0, v1, v2 };
+    f64 x[3];
+    f64 y[3];
+    f32 z[3];
+    f32 inv_w[3];
+    for(u32 i = 0; i < 3; ++i) {
+        inv_w[i] = 1.0f / v[i]->position.w;
+        f64 ndc_x = (f64)v[i]->position.x * inv_w[i];
+        f64 ndc_y = (f64)v[i]->position.y * inv_w[i];
+        z[i] = v[i]->position.z * inv_w[i] * 0.5f + 0.5f;
+        
+        // NOTE: snapped to a subpixel grid like the gpu does, edge math stays exact
+        x[i] = vp.x + (ndc_x + 1.0) * 0.5 * vp.width;
+        y[i] = vp.y + (ndc_y + 1.0) * 0.5 * vp.height;
+        x[i] = floor(x[i] * SOFTWARE_SUBPIXELS + 0.5) / SOFTWARE_SUBPIXELS;
+        y[i] = floor(y[i] * SOFTWARE_SUBPIXELS + 0.5) / SOFTWARE_SUBPIXELS;
+    }
+    
+    f64 area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if(!(area > 0.0 || area < 0.0)) {
+        return;
+    }
+    
+    // NOTE: no culling, clockwise triangles get flipped
+    if(area < 0.0) {
+        SoftwareVertex *swap_v = v[1]; v[1] = v[2]; v[2] = swap_v;
+        f64 swap_x = x[1]; x[1] = x[2]; x[2] = swap_x;
+        f64 swap_y = y[1]; y[1] = y[2]; y[2] = swap_y;
+        f32 swap_z = z[1]; z[1] = z[2]; z[2] = swap_z;
+        f32 swap_w = inv_w[1]; inv_w[1] = inv_w[2]; inv_w[2] = swap_w;
+        area = -area;
+    }
+    
+    // NOTE: pixel i is covered when its center i + 0.5 is
+    recti32 rect = batch->rect;
+    f64 min_x = max_value(ceil(min_value(x[0], min_value(x[1], x[2])) - 0.5), (f64)rect.x);
+    f64 min_y = max_value(ceil(min_value(y[0], min_value(y[1], y[2])) - 0.5), (f64)rect.y);
+    f64 max_x = min_value(floor(max_value(x[0], max_value(x[1], x[2])) - 0.5) + 1.0, (f64)(rect.x + rect.width));
+    f64 max_y = min_value(floor(max_value(y[0], max_value(y[1], y[2])) - 0.5) + 1.0, (f64)(rect.y + rect.height));
+    if(min_x >= max_x || min_y >= max_y) {
+        return;
+    }
+    
+    SoftwareTriangle *tri = batch->triangles + batch->triangle_count++;
+    zero_struct(tri);
+    tri->min_x = (i32)min_x;
+    tri->min_y = (i32)min_y;
+    tri->max_x = (i32)max_x;
+    tri->max_y = (i32)max_y;
+    
+    for(u32 e = 0; e < 3; ++e) {
+        u32 a = e;
+        u32 b = (e + 1) % 3;
+        tri->edge_a[e] = (f32)(y[a] - y[b]);
+        tri->edge_b[e] = (f32)(x[b] - x[a]);
+        tri->edge_c[e] = x[a] * y[b] - y[a] * x[b];
+        if(tri->edge_a[e] > 0.0f || (tri->edge_a[e] == 0.0f && tri->edge_b[e] < 0.0f)) {
+            tri->top_left |= (1 << e);
+        }
+    }
+    
+    if(inv_w[0] != inv_w[1] || inv_w[1] != inv_w[2]) {
+        tri->flags |= SOFTWARE_TRI_perspective;
+    }
+    bool perspective = (tri->flags & SOFTWARE_TRI_perspective);
+    
+    f32 values[ATTRIB_COUNT][3];
+    for(u32 i = 0; i < 3; ++i) {
+        f32 q = perspective ? inv_w[i] : 1.0f;
+        values[ATTRIB_z][i]     = z[i];
+        values[ATTRIB_inv_w][i] = inv_w[i];
+        values[ATTRIB_u][i]     = v[i]->tex_coord.x * q;
+        values[ATTRIB_v][i]     = v[i]->tex_coord.y * q;
+        values[ATTRIB_r][i]     = v[i]->color.r * q;
+        values[ATTRIB_g][i]     = v[i]->color.g * q;
+        values[ATTRIB_b][i]     = v[i]->color.b * q;
+        values[ATTRIB_a][i]     = v[i]->color.a * q;
+    }
+    
+    f64 dx1 = x[1] - x[0];
+    f64 dy1 = y[1] - y[0];
+    f64 dx2 = x[2] - x[0];
+    f64 dy2 = y[2] - y[0];
+    for(u32 k = 0; k < ATTRIB_COUNT; ++k) {
+        f64 f0  = values[k][0];
+        f64 df1 = values[k][1] - f0;
+        f64 df2 = values[k][2] - f0;
+        tri->plane_dx[k] = (f32)((df1 * dy2 - df2 * dy1) / area);
+        tri->plane_dy[k] = (f32)((df2 * dx1 - df1 * dx2) / area);
+        tri->plane_c[k]  = f0 - (f64)tri->plane_dx[k] * x[0] - (f64)tri->plane_dy[k] * y[0];
+    }
+    
+    vec4 color = v[0]->color;
+    if(compare_memory(&color, &v[1]->color, sizeof(vec4)) && compare_memory(&color, &v[2]->color, sizeof(vec4))) {
+        tri->flags |= SOFTWARE_TRI_flat_color;
+    }
+    
+    // NOTE: opengl samples missing textures as opaque black
+    tri->texel = make_vec4(0.0f, 0.0f, 0.0f, 255.0f);
+    if(!texture) {
+        tri->flags |= SOFTWARE_TRI_flat_texel;
+    }
+    else if(texture->width == 1 && texture->height == 1) {
+        tri->flags |= SOFTWARE_TRI_flat_texel;
+        tri->texel = software_unpack_texel(((u32 *)texture->texels)[0]);
+    }
+    else {
+        // NOTE: texels per pixel from the plain uv gradients pick min or mag filter
+        f64 w = (f64)texture->width;
+        f64 h = (f64)texture->height;
+        f64 du1 = v[1]->tex_coord.x - v[0]->tex_coord.x;
+        f64 du2 = v[2]->tex_coord.x - v[0]->tex_coord.x;
+        f64 dv1 = v[1]->tex_coord.y - v[0]->tex_coord.y;
+        f64 dv2 = v[2]->tex_coord.y - v[0]->tex_coord.y;
+        f64 dudx = ((du1 * dy2 - du2 * dy1) / area) * w;
+        f64 dudy = ((du2 * dx1 - du1 * dx2) / area) * w;
+        f64 dvdx = ((dv1 * dy2 - dv2 * dy1) / area) * h;
+        f64 dvdy = ((dv2 * dx1 - dv1 * dx2) / area) * h;
+        f64 rho = max_value(max_value(fabs(dudx), fabs(dudy)), max_value(fabs(dvdx), fabs(dvdy)));
+        tex_filter filter = (rho > 1.0) ? texture->min_filter : texture->mag_filter;
+        
+        // NOTE: a 1:1 mapping onto texel centers, the framebuffer blits, samples the same with nearest
+        bool aligned = false;
+        if(!perspective) {
+            f64 center_x = min_x + 0.5;
+            f64 center_y = min_y + 0.5;
+            f64 u = (v[0]->tex_coord.x * w) + dudx * (center_x - x[0]) + dudy * (center_y - y[0]) - 0.5;
+            f64 t = (v[0]->tex_coord.y * h) + dvdx * (center_x - x[0]) + dvdy * (center_y - y[0]) - 0.5;
+            f64 extent = max_value(max_x - min_x, max_y - min_y);
+            f64 drift = (fabs(fabs(dudx) - 1.0) + fabs(dudy) + fabs(fabs(dvdy) - 1.0) + fabs(dvdx)) * extent;
+            aligned = (drift < 0.01 && fabs(u - floor(u + 0.5)) < 0.01 && fabs(t - floor(t + 0.5)) < 0.01);
+        }
+        if(filter == FILTER_linear && !aligned) {
+            tri->flags |= SOFTWARE_TRI_linear;
+        }
+    }
+    tri->texture = texture;
+    
+    tri->color = color;
+    if((tri->flags & SOFTWARE_TRI_flat_color) && (tri->flags & SOFTWARE_TRI_flat_texel) && batch->shading != SHADING_tilemap) {
+        tri->color = make_vec4(color.r * tri->texel.r, color.g * tri->texel.g, color.b * tri->texel.b, color.a * tri->texel.a);
+    }
+}
+
+static void
+software_push_triangle(SoftwareBatch *batch, SoftwareTexture *texture, SoftwareVertex *v0, SoftwareVertex *v1, SoftwareVertex *v2) {
+    bool inside = true;
+    for(u32 plane = 0; plane < 2; ++plane) {
+        inside = inside && software_clip_distance(v0, plane) >= 0.0f && software_clip_distance(v1, plane) >= 0.0f &&
+            software_clip_distance(v2, plane) >= 0.0f;
+    }
+    if(inside) {
+        software_setup_triangle(batch, texture, v0, v1, v2);
+        return;
+    }
+    
+    // NOTE: every plane adds at most one vertex
+    SoftwareVertex polygon[2][6] = { { *v0, *v1, *v2 } };
+    u32 count = 3;
+    for(u32 plane = 0; plane < 2 && count >= 3; ++plane) {
+        count = software_clip_polygon(polygon[plane & 1], count, polygon[(plane + 1) & 1], plane);
+    }
+    for(u32 i = 1; (i + 1) < count; ++i) {
+        software_setup_triangle(batch, texture, &polygon[0][0], &polygon[0][i], &polygon[0][i + 1]);
+    }
+}
+
+static void
+software_clear_tile(SoftwareBatch *batch, i32 tile_x, i32 tile_y) {
+    recti32 rect = software_intersect(batch->rect, { tile_x, tile_y, SOFTWARE_TILE_SIZE, SOFTWARE_TILE_SIZE });
+    for(i32 y = rect.y; y < (rect.y + rect.height); ++y) {
+        u32 *color_row = (u32 *)batch->color->texels + (size_t)y * batch->color->pitch + rect.x;
+        for(i32 x = 0; x < rect.width; ++x) {
+            color_row[x] = batch->clear_color;
+        }
+        if(batch->depth) {
+            f32 *depth_row = (f32 *)batch->depth->texels + (size_t)y * batch->depth->pitch + rect.x;
+            for(i32 x = 0; x < rect.width; ++x) {
+                depth_row[x] = batch->clear_depth;
+            }
+        }
+    }
+}
+
+static void
+software_raster_triangle(SoftwareBatch *batch, SoftwareTriangle *tri, i32 tile_x, i32 tile_y) {
+    i32 x0 = max_value(tri->min_x, tile_x);
+    i32 y0 = max_value(tri->min_y, tile_y);
+    i32 x1 = min_value(tri->max_x, tile_x + SOFTWARE_TILE_SIZE);
+    i32 y1 = min_value(tri->max_y, tile_y + SOFTWARE_TILE_SIZE);
+    if(x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    
+    // NOTE: edges are relative to the tile's first pixel center. Both triangles on a shared edge
+    // get exactly negated values, the top left rule gives every pixel to one of them.
+    f64 origin_x = (f64)tile_x + 0.5;
+    f64 origin_y = (f64)tile_y + 0.5;
+    f32 edge_c[3];
+    __m128 edge_a[3];
+    __m128 top_left[3];
+    for(u32 e = 0; e < 3; ++e) {
+        edge_c[e]   = (f32)((f64)tri->edge_a[e] * origin_x + (f64)tri->edge_b[e] * origin_y + tri->edge_c[e]);
+        edge_a[e]   = _mm_set1_ps(tri->edge_a[e]);
+        top_left[e] = _mm_castsi128_ps(_mm_set1_epi32((tri->top_left & (1 << e)) ? -1 : 0));
+    }
+    
+    f32 attrib_c[ATTRIB_COUNT];
+    __m128 attrib_dx[ATTRIB_COUNT];
+    for(u32 k = 0; k < ATTRIB_COUNT; ++k) {
+        attrib_c[k]  = (f32)(tri->plane_c[k] + (f64)tri->plane_dx[k] * origin_x + (f64)tri->plane_dy[k] * origin_y);
+        attrib_dx[k] = _mm_set1_ps(tri->plane_dx[k]);
+    }
+    
+    bool perspective = (tri->flags & SOFTWARE_TRI_perspective);
+    bool flat_color  = (tri->flags & SOFTWARE_TRI_flat_color);
+    bool flat_texel  = (tri->flags & SOFTWARE_TRI_flat_texel);
+    bool linear      = (tri->flags & SOFTWARE_TRI_linear);
+    bool reverse     = (batch->shading == SHADING_framebuffer);
+    bool tile_map    = (batch->shading == SHADING_tilemap);
+    
+    __m128 zero = _mm_setzero_ps();
+    __m128 one  = _mm_set1_ps(1.0f);
+    __m128 full = _mm_set1_ps(255.0f);
+    __m128 inv_full = _mm_set1_ps(1.0f / 255.0f);
+    __m128 reverse_factor = _mm_set1_ps(batch->reverse_factor);
+    __m128 discard_alpha  = _mm_set1_ps(0.1f * 255.0f);
+    __m128 color_r = _mm_set1_ps(tri->color.r);
+    __m128 color_g = _mm_set1_ps(tri->color.g);
+    __m128 color_b = _mm_set1_ps(tri->color.b);
+    __m128 color_a = _mm_set1_ps(tri->color.a);
+    __m128 texel_r = _mm_set1_ps(tri->texel.r);
+    __m128 texel_g = _mm_set1_ps(tri->texel.g);
+    __m128 texel_b = _mm_set1_ps(tri->texel.b);
+    __m128 texel_a = _mm_set1_ps(tri->texel.a);
+    
+    __m128  lane   = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+    __m128i lane_i = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i before_x = _mm_set1_epi32(x0 - 1);
+    __m128i end_x    = _mm_set1_epi32(x1);
+    
+    SoftwareTexture *target = batch->color;
+    SoftwareTexture *depth  = batch->depth;
+    for(i32 y = y0; y < y1; ++y) {
+        f32 py = (f32)(y - tile_y);
+        
+        // NOTE: a conservative span where all edges pass, the masks still decide each pixel
+        f32 row_edge[3];
+        f32 span_min = (f32)(x0 - tile_x);
+        f32 span_max = (f32)(x1 - tile_x);
+        for(u32 e = 0; e < 3; ++e) {
+            row_edge[e] = tri->edge_b[e] * py + edge_c[e];
+            f32 a = tri->edge_a[e];
+            if(a > 0.0f) {
+                span_min = max_value(span_min, -row_edge[e] / a - 1.0f);
+            }
+            else if(a < 0.0f) {
+                span_max = min_value(span_max, -row_edge[e] / a + 1.0f);
+            }
+            else if(row_edge[e] < 0.0f) {
+                span_max = span_min;
+            }
+        }
+        if(!(span_min < span_max)) {
+            continue;
+        }
+        i32 row_x0 = (tile_x + (i32)span_min) & ~3;
+        i32 row_x1 = min_value(x1, tile_x + (i32)span_max + 1);
+        
+        __m128 row_e[3];
+        for(u32 e = 0; e < 3; ++e) {
+            row_e[e] = _mm_set1_ps(row_edge[e]);
+        }
+        __m128 row_attrib[ATTRIB_COUNT];
+        for(u32 k = 0; k < ATTRIB_COUNT; ++k) {
+            row_attrib[k] = _mm_set1_ps(attrib_c[k] + tri->plane_dy[k] * py);
+        }
+        
+        u32 *color_row = (u32 *)target->texels + (size_t)y * target->pitch;
+        f32 *depth_row = depth ? ((f32 *)depth->texels + (size_t)y * depth->pitch) : nullptr;
+        for(i32 x = row_x0; x < row_x1; x += 4) {
+            __m128  px = _mm_add_ps(_mm_set1_ps((f32)(x - tile_x)), lane);
+            __m128i xi = _mm_add_epi32(_mm_set1_epi32(x), lane_i);
+            __m128 mask = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(xi, before_x), _mm_cmplt_epi32(xi, end_x)));
+            for(u32 e = 0; e < 3; ++e) {
+                __m128 value = _mm_add_ps(_mm_mul_ps(edge_a[e], px), row_e[e]);
+                __m128 inside = _mm_or_ps(_mm_cmpgt_ps(value, zero), _mm_and_ps(_mm_cmpeq_ps(value, zero), top_left[e]));
+                mask = _mm_and_ps(mask, inside);
+            }
+            if(!_mm_movemask_ps(mask)) {
+                continue;
+            }
+
+#define software_attrib(k) _mm_add_ps(row_attrib[k], _mm_mul_ps(attrib_dx[k], px))
+            
+            // NOTE: fragments past the near or far plane are dropped here instead of clipped
+            __m128 z = software_attrib(ATTRIB_z);
+            mask = _mm_and_ps(mask, _mm_and_ps(_mm_cmpge_ps(z, zero), _mm_cmple_ps(z, one)));
+            __m128 old_depth = zero;
+            if(depth_row) {
+                old_depth = _mm_loadu_ps(depth_row + x);
+                mask = _mm_and_ps(mask, _mm_cmple_ps(z, old_depth));
+            }
+            if(!_mm_movemask_ps(mask)) {
+                continue;
+            }
+            
+            __m128 r, g, b, a;
+            if(flat_color && flat_texel && !tile_map) {
+                r = color_r;
+                g = color_g;
+                b = color_b;
+                a = color_a;
+            }
+            else {
+                __m128 w = one;
+                if(perspective) {
+                    w = _mm_div_ps(one, software_attrib(ATTRIB_inv_w));
+                }
+                
+                __m128 cr = color_r;
+                __m128 cg = color_g;
+                __m128 cb = color_b;
+                __m128 ca = color_a;
+                if(!flat_color) {
+                    cr = _mm_mul_ps(software_attrib(ATTRIB_r), w);
+                    cg = _mm_mul_ps(software_attrib(ATTRIB_g), w);
+                    cb = _mm_mul_ps(software_attrib(ATTRIB_b), w);
+                    ca = _mm_mul_ps(software_attrib(ATTRIB_a), w);
+                }
+                
+                __m128 tr = texel_r;
+                __m128 tg = texel_g;
+                __m128 tb = texel_b;
+                __m128 ta = texel_a;
+                if(tile_map) {
+                    __m128 u = _mm_mul_ps(software_attrib(ATTRIB_u), w);
+                    __m128 v = _mm_mul_ps(software_attrib(ATTRIB_v), w);
+                    software_sample_tile_map(batch, tri, linear, u, v, &tr, &tg, &tb, &ta, &mask);
+                }
+                else if(!flat_texel) {
+                    __m128 u = _mm_mul_ps(software_attrib(ATTRIB_u), w);
+                    __m128 v = _mm_mul_ps(software_attrib(ATTRIB_v), w);
+                    software_sample(tri->texture, linear, u, v, &tr, &tg, &tb, &ta);
+                }
+                
+                r = _mm_mul_ps(tr, cr);
+                g = _mm_mul_ps(tg, cg);
+                b = _mm_mul_ps(tb, cb);
+                a = _mm_mul_ps(ta, ca);
+            }
+#undef software_attrib
+            
+            if(reverse) {
+                r = _mm_add_ps(r, _mm_mul_ps(_mm_sub_ps(full, _mm_add_ps(r, r)), reverse_factor));
+                g = _mm_add_ps(g, _mm_mul_ps(_mm_sub_ps(full, _mm_add_ps(g, g)), reverse_factor));
+                b = _mm_add_ps(b, _mm_mul_ps(_mm_sub_ps(full, _mm_add_ps(b, b)), reverse_factor));
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(a, discard_alpha));
+                if(!_mm_movemask_ps(mask)) {
+                    continue;
+                }
+            }
+            
+            // NOTE: the output is clamped before blending, then src alpha, one minus src alpha
+            r = _mm_min_ps(_mm_max_ps(r, zero), full);
+            g = _mm_min_ps(_mm_max_ps(g, zero), full);
+            b = _mm_min_ps(_mm_max_ps(b, zero), full);
+            a = _mm_min_ps(_mm_max_ps(a, zero), full);
+            __m128 alpha = _mm_mul_ps(a, inv_full);
+            __m128 inv_alpha = _mm_sub_ps(one, alpha);
+            
+            __m128i old_color = _mm_loadu_si128((__m128i *)(color_row + x));
+            __m128 dr, dg, db, da;
+            software_unpack(old_color, &dr, &dg, &db, &da);
+            r = _mm_add_ps(_mm_mul_ps(r, alpha), _mm_mul_ps(dr, inv_alpha));
+            g = _mm_add_ps(_mm_mul_ps(g, alpha), _mm_mul_ps(dg, inv_alpha));
+            b = _mm_add_ps(_mm_mul_ps(b, alpha), _mm_mul_ps(db, inv_alpha));
+            a = _mm_add_ps(_mm_mul_ps(a, alpha), _mm_mul_ps(da, inv_alpha));
+            
+            __m128i write = _mm_castps_si128(mask);
+            __m128i new_color = software_pack(r, g, b, a);
+            _mm_storeu_si128((__m128i *)(color_row + x), _mm_or_si128(_mm_and_si128(write, new_color), _mm_andnot_si128(write, old_color)));
+            if(depth_row) {
+                _mm_storeu_ps(depth_row + x, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, old_depth)));
+            }
+        }
+    }
+}
+
+// NOTE: every job takes tiles until there are none left, a tile is only ever touched by one job
+PLATFORM_WORK_QUEUE_CALLBACK(software_tile_work) {
+    SoftwareBatch *batch = (SoftwareBatch *)data;
+    for(;;) {
+        u32 busy_index = atomic_add_u32(&batch->next_busy_tile, 1);
+        if(busy_index >= batch->busy_tile_count) {
+            break;
+        }
+        
+        u32 tile = batch->busy_tiles[busy_index];
+        i32 tile_x = (i32)(tile % batch->tiles_x) << SOFTWARE_TILE_SHIFT;
+        i32 tile_y = (i32)(tile / batch->tiles_x) << SOFTWARE_TILE_SHIFT;
+        if(batch->type == BATCH_clear) {
+            software_clear_tile(batch, tile_x, tile_y);
+        }
+        else {
+            for(u32 i = batch->tile_offsets[tile]; i < batch->tile_offsets[tile + 1]; ++i) {
+                software_raster_triangle(batch, batch->triangles + batch->tile_triangles[i], tile_x, tile_y);
+            }
+        }
+    }
+}
+
+// NOTE: bins the batch and waits for it, draws and clears go out one at a time
+static void
+software_run_batch(SoftwareBatch *batch) {
+    SoftwareRenderer *sr = &software_renderer;
+    u32 tile_count = batch->tiles_x * batch->tiles_y;
+    batch->busy_tile_count = 0;
+    if(batch->rect.width <= 0 || batch->rect.height <= 0) {
+        return;
+    }
+    
+    if(batch->type == BATCH_clear) {
+        u32 tx0 = (u32)batch->rect.x >> SOFTWARE_TILE_SHIFT;
+        u32 ty0 = (u32)batch->rect.y >> SOFTWARE_TILE_SHIFT;
+        u32 tx1 = (u32)(batch->rect.x + batch->rect.width  - 1) >> SOFTWARE_TILE_SHIFT;
+        u32 ty1 = (u32)(batch->rect.y + batch->rect.height - 1) >> SOFTWARE_TILE_SHIFT;
+        for(u32 ty = ty0; ty <= ty1; ++ty) {
+            for(u32 tx = tx0; tx <= tx1; ++tx) {
+                batch->busy_tiles[batch->busy_tile_count++] = ty * batch->tiles_x + tx;
+            }
+        }
+    }
+    else {
+        if(!batch->triangle_count) {
+            return;
+        }
+        
+        // NOTE: counts, offsets, then the offsets are used as write cursors and end up
+        // pointing one tile ahead, shifting them back gives begin/end per tile
+        u32 *offsets = batch->tile_offsets;
+        zero_memory(offsets, (tile_count + 1) * sizeof(u32));
+        for(u32 i = 0; i < batch->triangle_count; ++i) {
+            SoftwareTriangle *tri = batch->triangles + i;
+            for(i32 ty = tri->min_y >> SOFTWARE_TILE_SHIFT; ty <= ((tri->max_y - 1) >> SOFTWARE_TILE_SHIFT); ++ty) {
+                for(i32 tx = tri->min_x >> SOFTWARE_TILE_SHIFT; tx <= ((tri->max_x - 1) >> SOFTWARE_TILE_SHIFT); ++tx) {
+                    ++offsets[ty * batch->tiles_x + tx];
+                }
+            }
+        }
+        
+        u32 total = 0;
+        for(u32 tile = 0; tile < tile_count; ++tile) {
+            u32 count = offsets[tile];
+            offsets[tile] = total;
+            total += count;
+            if(count) {
+                batch->busy_tiles[batch->busy_tile_count++] = tile;
+            }
+        }
+        software_grow((void **)&batch->tile_triangles, &sr->tile_triangle_capacity, total, sizeof(u32));
+        
+        for(u32 i = 0; i < batch->triangle_count; ++i) {
+            SoftwareTriangle *tri = batch->triangles + i;
+            for(i32 ty = tri->min_y >> SOFTWARE_TILE_SHIFT; ty <= ((tri->max_y - 1) >> SOFTWARE_TILE_SHIFT); ++ty) {
+                for(i32 tx = tri->min_x >> SOFTWARE_TILE_SHIFT; tx <= ((tri->max_x - 1) >> SOFTWARE_TILE_SHIFT); ++tx) {
+                    batch->tile_triangles[offsets[ty * batch->tiles_x + tx]++] = i;
+                }
+            }
+        }
+        memmove(offsets + 1, offsets, tile_count * sizeof(u32));
+        offsets[0] = 0;
+    }
+    
+    if(!batch->busy_tile_count) {
+        return;
+    }
+    
+    batch->next_busy_tile = 0;
+    u32 job_count = min_value(sr->job_count, batch->busy_tile_count);
+    if(sr->queue && job_count > 1) {
+        for(u32 i = 0; i < job_count; ++i) {
+            sr->procs->add_work_entry(sr->queue, software_tile_work, batch);
+        }
+        sr->procs->complete_all_work(sr->queue);
+    }
+    else {
+        software_tile_work(sr->queue, batch);
+    }
+}
+
+static SoftwareTexture *
+software_slot_texture(SoftwareShader *shader, f32 tex_slot) {
+    i32 slot = (i32)(tex_slot + 0.5f);
+    if(slot < 0 || slot >= SOFTWARE_TEXTURE_UNITS) {
+        return nullptr;
+    }
+    i32 unit = shader->textures[slot];
+    if(unit < 0 || unit >= SOFTWARE_TEXTURE_UNITS) {
+        return nullptr;
+    }
+    SoftwareTexture *tex = software_get_texture(software_renderer.bound_textures[unit]);
+    return (tex && tex->texels && !tex->depth) ? tex : nullptr;
+}
+
+static SoftwareBatch *
+software_begin_draw(SoftwareShader *shader) {
+    SoftwareBatch *batch = software_begin_batch(BATCH_triangles);
+    if(!batch) {
+        return nullptr;
+    }
+    batch->rect = software_intersect(batch->rect, software_renderer.viewport);
+    batch->shading = shader->shading;
+    batch->reverse_factor = clamp01(shader->reverse_factor);
+    
+    if(shader->shading == SHADING_tilemap) {
+        u32 unit = (u32)shader->tile_map_unit;
+        SoftwareTexture *tile_map = (unit < SOFTWARE_TEXTURE_UNITS) ? software_get_texture(software_renderer.bound_textures[unit]) : nullptr;
+        if(!tile_map || !tile_map->texels || tile_map->depth) {
+            return nullptr;
+        }
+        batch->tile_map = tile_map;
+        batch->tile_rects = shader->tile_rects;
+        batch->tile_colors = shader->tile_colors;
+    }
+    return batch;
+}
+
+// NOTE: the indices are used once per instance, each instance has 'instance_vertex_count' vertices
+static void
+software_end_draw(SoftwareBatch *batch, SoftwareShader *shader, u32 *indices, u32 index_count, 
+                  u32 instance_count, u32 instance_vertex_count) {
+    SoftwareRenderer *sr = &software_renderer;
+    
+    // NOTE: clipping makes up to 3 triangles out of one
+    software_grow((void **)&batch->triangles, &sr->triangle_capacity, (index_count / 3) * 3 * instance_count, sizeof(SoftwareTriangle));
+    for(u32 instance = 0; instance < instance_count; ++instance) {
+        SoftwareVertex *vertices = sr->vertices + instance * instance_vertex_count;
+        for(u32 i = 0; (i + 2) < index_count; i += 3) {
+            u32 i0 = indices ? indices[i + 0] : (i + 0);
+            u32 i1 = indices ? indices[i + 1] : (i + 1);
+            u32 i2 = indices ? indices[i + 2] : (i + 2);
+            if(i0 >= instance_vertex_count || i1 >= instance_vertex_count || i2 >= instance_vertex_count) {
+                continue;
+            }
+            
+            SoftwareVertex *v0 = vertices + i0;
+            SoftwareTexture *texture = software_slot_texture(shader, v0->tex_slot);
+            software_push_triangle(batch, texture, v0, vertices + i1, vertices + i2);
+        }
+    }
+    software_run_batch(batch);
+}
+
+// NOTE: null 'indices' draws every 3 vertices as a triangle
+static void
+software_draw(VertexBuffer *vb, u32 *indices, u32 index_count, u32 shader_id) {
+    SoftwareRenderer *sr = &software_renderer;
+    SoftwareBuffer *buffer = software_get_buffer(vb->id);
+    SoftwareShader *shader = software_get_shader(shader_id);
+    if(!buffer || !buffer->data || !shader) {
+        return;
+    }
+    if(vb->layout.stride != sizeof(QuadVertex)) {
+        software_log("can only draw QuadVertex buffers...\n");
+        return;
+    }
+    
+    u32 vertex_count = buffer->size / sizeof(QuadVertex);
+    u32 used_count = 0;
+    if(indices) {
+        for(u32 i = 0; i < index_count; ++i) {
+            used_count = max_value(used_count, indices[i] + 1);
+        }
+        used_count = min_value(used_count, vertex_count);
+    }
+    else {
+        index_count = vertex_count - (vertex_count % 3);
+        used_count = index_count;
+    }
+    
+    SoftwareBatch *batch = software_begin_draw(shader);
+    if(!batch || !used_count) {
+        return;
+    }
+    
+    // NOTE: vertex stage, once per vertex
+    software_grow((void **)&sr->vertices, &sr->vertex_capacity, used_count, sizeof(SoftwareVertex));
+    QuadVertex *source = (QuadVertex *)buffer->data;
+    for(u32 i = 0; i < used_count; ++i) {
+        QuadVertex *in = source + i;
+        SoftwareVertex *out = sr->vertices + i;
+        out->position = shader->proj * (shader->view * make_vec4(in->position, 1.0f));
+        out->color = in->color;
+        // NOTE: the tiling factor is the same on all of a quad's vertices, so it can go here
+        out->tex_coord = make_vec2(in->tex_coord.x * in->tiling_factor.x, in->tex_coord.y * in->tiling_factor.y);
+        out->tex_slot = in->tex_slot;
+    }
+    software_end_draw(batch, shader, indices, index_count, 1, used_count);
+}
+
+// NOTE: the instanced vertex stage in p_renderer.cpp, the index is the corner
+static void
+software_draw_quad_instances(VertexBuffer *vb, u32 *indices, u32 index_count, u32 instance_count, u32 shader_id) {
+    SoftwareRenderer *sr = &software_renderer;
+    SoftwareBuffer *buffer = software_get_buffer(vb->id);
+    SoftwareShader *shader = software_get_shader(shader_id);
+    if(!buffer || !buffer->data || !shader) {
+        return;
+    }
+    if(!vb->layout.per_instance || vb->layout.stride != sizeof(QuadInstance)) {
+        software_log("can only draw QuadInstance buffers instanced...\n");
+        return;
+    }
+    
+    instance_count = min_value(instance_count, buffer->size / (u32)sizeof(QuadInstance));
+    SoftwareBatch *batch = software_begin_draw(shader);
+    if(!batch || !instance_count) {
+        return;
+    }
+    
+    software_grow((void **)&sr->vertices, &sr->vertex_capacity, instance_count * 4, sizeof(SoftwareVertex));
+    QuadInstance *source = (QuadInstance *)buffer->data;
+    for(u32 i = 0; i < instance_count; ++i) {
+        QuadInstance *in = source + i;
+        vec4 color = make_vec4((f32)(in->color & 0xff), (f32)((in->color >> 8) & 0xff),
+                               (f32)((in->color >> 16) & 0xff), (f32)(in->color >> 24)) * (1.0f / 255.0f);
+        f32 s = sinf(in->rotation);
+        f32 c = cosf(in->rotation);
+        for(u32 corner = 0; corner < 4; ++corner) {
+            f32 x = (corner == 1 || corner == 2) ? 1.0f : 0.0f;
+            f32 y = (corner >= 2) ? 1.0f : 0.0f;
+            f32 offset_x = (x - 0.5f) * in->size.x;
+            f32 offset_y = (y - 0.5f) * in->size.y;
+            vec4 position = make_vec4(in->position.x + offset_x * c - offset_y * s,
+                                      in->position.y + offset_x * s + offset_y * c, in->position.z, 1.0f);
+            
+            SoftwareVertex *out = sr->vertices + i * 4 + corner;
+            out->position = shader->proj * (shader->view * position);
+            out->color = color;
+            out->tex_coord = make_vec2(in->uv_rect.x + (in->uv_rect.z - in->uv_rect.x) * x,
+                                       in->uv_rect.y + (in->uv_rect.w - in->uv_rect.y) * y);
+            out->tex_slot = in->tex_slot;
+        }
+    }
+    software_end_draw(batch, shader, indices, index_count, instance_count, 4);
+}
+
+CLEAR_PROC(software_clear) {
+    SoftwareBatch *batch = software_begin_batch(BATCH_clear);
+    if(!batch) {
+        return;
+    }
+    batch->clear_color = software_pack_texel((u32)(clamp01(r) * 255.0f + 0.5f), (u32)(clamp01(g) * 255.0f + 0.5f),
+                                             (u32)(clamp01(b) * 255.0f + 0.5f), (u32)(clamp01(a) * 255.0f + 0.5f));
+    batch->clear_depth = 1.0f;
+    software_run_batch(batch);
+}
+
+SET_CLIP_RECT(software_set_clip_rect) {
+    software_renderer.scissor = true;
+    software_renderer.scissor_rect = { x, y, width, height };
+}
+
+DISABLE_CLIP_RECT(software_disable_clip_rect) {
+    software_renderer.scissor = false;
+}
+
+CREATE_FRAMEBUFFER_PROC(software_create_framebuffer) {
+    Texture2DParams color_params = {
+        FORMAT_rgba8,
+        FORMAT_rgba,
+        PIXEL_TYPE_unsigned_byte,
+        FILTER_linear,
+        FILTER_linear,
+        WRAP_clamp_to_edge,
+        WRAP_clamp_to_edge,
+    };
+    
+    Texture2DParams depth_params = {
+        FORMAT_depth24_stencil8,
+        FORMAT_depth_stencil,
+        PIXEL_TYPE_unsigned_int_24_8,
+        FILTER_linear,
+        FILTER_linear,
+        WRAP_clamp_to_edge,
+        WRAP_clamp_to_edge,
+    };
+    
+    Framebuffer fb = {};
+    fb.id = ++software_renderer.next_object_id;
+    fb.width = width;
+    fb.height = height;
+    fb.color = software_create_texture_2d(nullptr, width, height, 4, color_params);
+    fb.depth = software_create_texture_2d(nullptr, width, height, 4, depth_params);
+    return fb;
+}
+
+RESIZE_FRAMEBUFFER_PROC(software_resize_framebuffer) {
+    software_delete_framebuffer(fb);
+    *fb = software_create_framebuffer(width, height);
+}
+
+DELETE_FRAMEBUFFER_PROC(software_delete_framebuffer) {
+    // NOTE: like opengl, deleting the bound framebuffer goes back to the backbuffer
+    if(fb->color.id && fb->color.id == software_renderer.target_color) {
+        software_renderer.target_color = 0;
+        software_renderer.target_depth = 0;
+    }
+    software_delete_texture_2d(&fb->color);
+    software_delete_texture_2d(&fb->depth);
+    zero_struct(fb);
+}
+
+BIND_FRAMEBUFFER_PROC(software_bind_framebuffer) {
+    software_renderer.target_color = fb ? fb->color.id : 0;
+    software_renderer.target_depth = fb ? fb->depth.id : 0;
+}
+
+UNBIND_FRAMEBUFFER_PROC(software_unbind_framebuffer) {
+    software_renderer.target_color = 0;
+    software_renderer.target_depth = 0;
+}
+
+DRAW_BUFFERS_PROC(software_draw_buffers) {
+    software_renderer.bound_shader = shader->id;
+    if(vb_count) {
+        software_draw(vbs, nullptr, 0, shader->id);
+    }
+}
+
+DRAW_BUFFERS_INDEXED_PROC(software_draw_buffers_indexed) {
+    software_renderer.bound_shader = shader->id;
+    SoftwareBuffer *index_buffer = software_get_buffer(ib->id);
+    if(vb_count && index_buffer && index_buffer->data) {
+        u32 index_count = min_value(ib->count, index_buffer->size / (u32)sizeof(u32));
+        software_draw(vbs, (u32 *)index_buffer->data, index_count, shader->id);
+    }
+}
+
+DRAW_INDEXED_PROC(software_draw_indexed) {
+    SoftwareBuffer *index_buffer = software_get_buffer(va->ib.id);
+    if(va->vb_count && index_buffer && index_buffer->data) {
+        u32 draw_count = count ? count : va->ib.count;
+        draw_count = min_value(draw_count, index_buffer->size / (u32)sizeof(u32));
+        software_draw(&va->vbs[0], (u32 *)index_buffer->data, draw_count, software_renderer.bound_shader);
+    }
+}
+
+DRAW_INSTANCED_PROC(software_draw_instanced) {
+    SoftwareBuffer *index_buffer = software_get_buffer(va->ib.id);
+    if(va->vb_count && index_buffer && index_buffer->data) {
+        u32 draw_count = count ? count : va->ib.count;
+        draw_count = min_value(draw_count, index_buffer->size / (u32)sizeof(u32));
+        software_draw_quad_instances(&va->vbs[0], (u32 *)index_buffer->data, draw_count, instance_count, software_renderer.bound_shader);
+    }
+}
+
+READ_PIXELS_PROC(software_read_pixels) {
+    SoftwareTexture *color = &software_renderer.backbuffer;
+    if(fb) {
+        color = software_get_texture(fb->color.id);
+    }
+    if(!color || !color->texels || x < 0 || y < 0 || width < 0 || height < 0 ||
+       (x + width) > color->width || (y + height) > color->height) {
+        return false;
+    }
+    
+    // NOTE: texels are already RGBA8 in memory order, only the pitch differs
+    for(i32 row = 0; row < height; ++row) {
+        u32 *source = (u32 *)color->texels + (size_t)(y + row) * color->pitch + x;
+        copy_memory(source, dest + (size_t)row * width * 4, (size_t)width * 4);
+    }
+    return true;
+}
+
+INITIALIZE_PROC(software_initialize) {
+    return true;
+}
+
+// NOTE: the default framebuffer, call it before init_renderer and when the window size changes
+static void
+software_resize_backbuffer(i32 width, i32 height) {
+    SoftwareRenderer *sr = &software_renderer;
+    software_free_texels(&sr->backbuffer);
+    software_free_texels(&sr->backbuffer_depth);
+    software_allocate_texels(&sr->backbuffer, width, height, false);
+    software_allocate_texels(&sr->backbuffer_depth, width, height, true);
+    sr->backbuffer.in_use = true;
+    sr->backbuffer_depth.in_use = true;
+    if(sr->viewport.width == 0 && sr->viewport.height == 0) {
+        sr->viewport = { 0, 0, width, height };
+    }
+}
+
+// NOTE: 'thread_count' is how many workers the queue has, the calling thread helps too
+static void
+get_software_renderer_api(RendererAPI *api, PlatformProcs *procs, PlatformWorkQueue *queue, u32 thread_count) {
+    software_renderer.procs = procs;
+    software_renderer.queue = queue;
+    software_renderer.job_count = thread_count + 1;
+    
+    api->backend = BACKEND_software;
+    api->bind_texture_2d        = software_bind_texture_2d;
+    api->unbind_texture_2d      = software_unbind_texture_2d;
+    api->create_texture_2d      = software_create_texture_2d;
+    api->delete_texture_2d      = software_delete_texture_2d;
+    api->update_texture_2d      = software_update_texture_2d;
+    api->bind_shader            = software_bind_shader;
+    api->unbind_shader          = software_unbind_shader;
+    api->create_shader          = software_create_shader;
+    api->delete_shader          = software_delete_shader;
+    api->set_uniform_int        = software_set_uniform_int;
+    api->set_uniform_float      = software_set_uniform_float;
+    api->set_uniform_float2     = software_set_uniform_float2;
+    api->set_uniform_float3     = software_set_uniform_float3;
+    api->set_uniform_float4     = software_set_uniform_float4;
+    api->set_uniform_mat4x4     = software_set_uniform_mat4x4;
+    api->set_uniform_int_array  = software_set_uniform_int_array;
+    api->create_vertex_buffer   = software_create_vertex_buffer;
+    api->set_vertex_buffer_data = software_set_vertex_buffer_data;
+    api->delete_vertex_buffer   = software_delete_vertex_buffer;
+    api->create_index_buffer    = software_create_index_buffer;
+    api->delete_index_buffer    = software_delete_index_buffer;
+    api->create_vertex_array    = software_create_vertex_array;
+    api->delete_vertex_array    = software_delete_vertex_array;
+    api->attach_vertex_buffer   = software_attach_vertex_buffer;
+    api->attach_index_buffer    = software_attach_index_buffer;
+    api->create_framebuffer     = software_create_framebuffer;
+    api->resize_framebuffer     = software_resize_framebuffer;
+    api->delete_framebuffer     = software_delete_framebuffer;
+    api->bind_framebuffer       = software_bind_framebuffer;
+    api->unbind_framebuffer     = software_unbind_framebuffer;
+    api->set_viewport           = software_set_viewport;
+    api->clear                  = software_clear;
+    api->set_clip_rect          = software_set_clip_rect;
+    api->disable_clip_rect      = software_disable_clip_rect;
+    api->draw_buffers           = software_draw_buffers;
+    api->draw_buffers_indexed   = software_draw_buffers_indexed;
+    api->draw_indexed           = software_draw_indexed;
+    api->draw_instanced         = software_draw_instanced;
+    api->read_pixels            = software_read_pixels;
+    api->initialize             = software_initialize;
+}
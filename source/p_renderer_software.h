@@ -0,0 +1,222 @@
+#ifndef P_RENDERER_SOFTWARE_H
+#define P_RENDERER_SOFTWARE_H
+
+#if !defined(_M_X64) && !defined(__SSE2__)
+#error "software renderer: needs SSE2..."
+#endif
+#include <emmintrin.h>
+
+// NOTE: RendererAPI on the cpu, for machines without a gpu. Targets are RGBA8 color (red in
+// the low byte, row 0 at the bottom like opengl) with an f32 depth buffer. Blending and the
+// depth test are the ones opengl_initialize sets up. Draw calls are binned into tiles and
+// the tiles are rasterized on the platform work queue, 4 pixels at a time.
+// GLSL can't run here, create_shader picks one of the built in shadings by what the fragment
+// source uses and draws only understand the QuadVertex layout, QuadInstance when instanced.
+
+#define software_log(str, ...) printf("software: " str, ##__VA_ARGS__)
+
+#define SOFTWARE_TILE_SHIFT    6
+#define SOFTWARE_TILE_SIZE     (1 << SOFTWARE_TILE_SHIFT)
+#define SOFTWARE_TEXTURE_UNITS 32
+#define SOFTWARE_MAX_SHADERS   16
+#define SOFTWARE_SUBPIXELS     256.0
+#define SOFTWARE_MIN_W         0.00001f
+
+enum software_shading {
+    SHADING_basic,       // NOTE: p_basic.glsl, texture * color
+    SHADING_framebuffer, // NOTE: framebuffer.glsl, u_reverse_factor and discard under 0.1 alpha
+    SHADING_tilemap,     // NOTE: tilemap.glsl, the texture is the sprite sheet u_tile_map's types index
+};
+
+struct SoftwareTexture {
+    bool in_use;
+    bool depth;
+    tex_format format;
+    i32 width;
+    i32 height;
+    i32 pitch; // NOTE: texels per row, rounded up to 4 so a row holds whole pixel blocks
+    tex_filter min_filter;
+    tex_filter mag_filter;
+    tex_wrap wrap_s;
+    tex_wrap wrap_t;
+    void *texels; // NOTE: u32 RGBA8, f32 for depth
+};
+
+// NOTE: vertex and index buffers share one table like opengl buffer objects
+struct SoftwareBuffer {
+    bool in_use;
+    u32 size;
+    u8 *data;
+};
+
+struct SoftwareShader {
+    bool in_use;
+    software_shading shading;
+    mat4x4 proj;
+    mat4x4 view;
+    f32 reverse_factor;
+    i32 textures[SOFTWARE_TEXTURE_UNITS];
+    i32 tile_map_unit;
+    vec4 tile_rects[TILE_MAP_MAX_TYPES];
+    vec4 tile_colors[TILE_MAP_MAX_TYPES];
+};
+
+// NOTE: after the vertex stage, position is in clip space
+struct SoftwareVertex {
+    vec4 position;
+    vec4 color;
+    vec2 tex_coord;
+    f32  tex_slot;
+};
+
+enum software_attrib {
+    ATTRIB_z,
+    ATTRIB_inv_w,
+    ATTRIB_u,
+    ATTRIB_v,
+    ATTRIB_r,
+    ATTRIB_g,
+    ATTRIB_b,
+    ATTRIB_a,
+    
+    ATTRIB_COUNT
+};
+
+#define SOFTWARE_TRI_perspective 0x1
+#define SOFTWARE_TRI_flat_color  0x2
+#define SOFTWARE_TRI_flat_texel  0x4 // NOTE: 1x1 or missing texture
+#define SOFTWARE_TRI_linear      0x8
+
+// NOTE: edge e is inside when a * x + b * y + c > 0 at the pixel center, or == 0 on a top left
+// edge. Attributes are planes, value = c + dx * x + dy * y, divided by w when perspective.
+struct SoftwareTriangle {
+    f32 edge_a[3];
+    f32 edge_b[3];
+    f64 edge_c[3];
+    u32 top_left;
+    u32 flags;
+    
+    i32 min_x; // NOTE: pixel bounds inside the batch rect, max is exclusive
+    i32 min_y;
+    i32 max_x;
+    i32 max_y;
+    
+    f64 plane_c[ATTRIB_COUNT];
+    f32 plane_dx[ATTRIB_COUNT];
+    f32 plane_dy[ATTRIB_COUNT];
+    
+    vec4 color; // NOTE: 0-1 flat vertex color, 0-255 with the texel when that is flat too
+    vec4 texel; // NOTE: 0-255
+    SoftwareTexture *texture;
+};
+
+enum software_batch_type {
+    BATCH_clear,
+    BATCH_triangles,
+};
+
+// NOTE: one clear or draw call, tile lists are a counting sort so every tile keeps the
+// submission order of its triangles
+struct SoftwareBatch {
+    software_batch_type type;
+    SoftwareTexture *color;
+    SoftwareTexture *depth;
+    recti32 rect;
+    
+    u32 clear_color;
+    f32 clear_depth;
+    
+    software_shading shading;
+    f32 reverse_factor;
+    SoftwareTexture *tile_map;
+    vec4 *tile_rects;
+    vec4 *tile_colors;
+    u32 triangle_count;
+    SoftwareTriangle *triangles;
+    
+    u32 tiles_x;
+    u32 tiles_y;
+    u32 *tile_offsets;
+    u32 *tile_triangles;
+    u32 busy_tile_count;
+    u32 *busy_tiles;
+    u32 volatile next_busy_tile;
+};
+
+struct SoftwareRenderer {
+    PlatformProcs *procs;
+    PlatformWorkQueue *queue;
+    u32 job_count;
+    
+    u32 texture_capacity;
+    SoftwareTexture *textures;
+    u32 buffer_capacity;
+    SoftwareBuffer *buffers;
+    SoftwareShader shaders[SOFTWARE_MAX_SHADERS];
+    u32 next_object_id; // NOTE: vertex arrays and framebuffers only need to be non zero
+    
+    SoftwareTexture backbuffer;
+    SoftwareTexture backbuffer_depth;
+    u32 target_color; // NOTE: 0 is the backbuffer
+    u32 target_depth;
+    
+    u32 bound_shader;
+    u32 bound_textures[SOFTWARE_TEXTURE_UNITS];
+    recti32 viewport;
+    bool scissor;
+    recti32 scissor_rect;
+    
+    SoftwareBatch batch;
+    u32 triangle_capacity;
+    u32 tile_capacity;
+    u32 busy_tile_capacity;
+    u32 tile_triangle_capacity;
+    u32 vertex_capacity;
+    SoftwareVertex *vertices;
+};
+
+SET_UNIFORM_INT_PROC(software_set_uniform_int);
+SET_UNIFORM_FLOAT_PROC(software_set_uniform_float);
+SET_UNIFORM_FLOAT2_PROC(software_set_uniform_float2);
+SET_UNIFORM_FLOAT3_PROC(software_set_uniform_float3);
+SET_UNIFORM_FLOAT4_PROC(software_set_uniform_float4);
+SET_UNIFORM_MAT4X4_PROC(software_set_uniform_mat4x4);
+SET_UNIFORM_INT_ARRAY_PROC(software_set_uniform_int_array);
+BIND_TEXTURE_2D_PROC(software_bind_texture_2d);
+UNBIND_TEXTURE_2D_PROC(software_unbind_texture_2d);
+CREATE_TEXTURE_2D_PROC(software_create_texture_2d);
+DELETE_TEXTURE_2D_PROC(software_delete_texture_2d);
+UPDATE_TEXTURE_2D_PROC(software_update_texture_2d);
+BIND_SHADER_PROC(software_bind_shader);
+UNBIND_SHADER_PROC(software_unbind_shader);
+CREATE_SHADER_PROC(software_create_shader);
+DELETE_SHADER_PROC(software_delete_shader);
+CREATE_VERTEX_BUFFER_PROC(software_create_vertex_buffer);
+SET_VERTEX_BUFFER_DATA_PROC(software_set_vertex_buffer_data);
+DELETE_VERTEX_BUFFER_PROC(software_delete_vertex_buffer);
+CREATE_INDEX_BUFFER_PROC(software_create_index_buffer);
+DELETE_INDEX_BUFFER_PROC(software_delete_index_buffer);
+CREATE_VERTEX_ARRAY_PROC(software_create_vertex_array);
+DELETE_VERTEX_ARRAY_PROC(software_delete_vertex_array);
+ATTACH_VERTEX_BUFFER_PROC(software_attach_vertex_buffer);
+ATTACH_INDEX_BUFFER_PROC(software_attach_index_buffer);
+SET_VIEWPORT_PROC(software_set_viewport);
+CLEAR_PROC(software_clear);
+SET_CLIP_RECT(software_set_clip_rect);
+DISABLE_CLIP_RECT(software_disable_clip_rect);
+CREATE_FRAMEBUFFER_PROC(software_create_framebuffer);
+RESIZE_FRAMEBUFFER_PROC(software_resize_framebuffer);
+DELETE_FRAMEBUFFER_PROC(software_delete_framebuffer);
+BIND_FRAMEBUFFER_PROC(software_bind_framebuffer);
+UNBIND_FRAMEBUFFER_PROC(software_unbind_framebuffer);
+DRAW_BUFFERS_PROC(software_draw_buffers);
+DRAW_BUFFERS_INDEXED_PROC(software_draw_buffers_indexed);
+DRAW_INDEXED_PROC(software_draw_indexed);
+DRAW_INSTANCED_PROC(software_draw_instanced);
+READ_PIXELS_PROC(software_read_pixels);
+INITIALIZE_PROC(software_initialize);
+
+static void get_software_renderer_api(RendererAPI *api, PlatformProcs *procs, PlatformWorkQueue *queue, u32 thread_count);
+static void software_resize_backbuffer(i32 width, i32 height);
+
+#endif /* P_RENDERER_SOFTWARE_H */
@@ -0,0 +1,234 @@
+static void
+make_replay(Replay *replay, MemoryArena *arena, u32 max_bytes) {
+    *replay = {};
+    replay->bits = push_array(arena, u8, max_bytes);
+    replay->max_bits = max_bytes * 8;
+}
+
+static void
+begin_replay(Replay *replay, Level *level) {
+    ReplayHeader *header = &replay->header;
+    *header = {};
+    header->magic   = REPLAY_MAGIC;
+    header->version = REPLAY_VERSION;
+    header->seed     = level->params.seed;
+    header->map_hash = level->map_hash;
+    header->params   = level->params;
+    
+    replay->truncated = false;
+    rewind_replay(replay);
+}
+
+inline void
+write_replay_bits(Replay *replay, u32 value, u32 count) {
+    for(u32 i = 0; i < count; ++i) {
+        u32 bit = replay->header.bit_count++;
+        if((bit & 7) == 0) {
+            replay->bits[bit >> 3] = 0;
+        }
+        replay->bits[bit >> 3] |= ((value >> i) & 1) << (bit & 7);
+    }
+}
+
+inline u32
+read_replay_bits(Replay *replay, u32 count) {
+    u32 value = 0;
+    for(u32 i = 0; i < count; ++i) {
+        u32 bit = replay->read_bit++;
+        value |= ((replay->bits[bit >> 3] >> (bit & 7)) & 1) << i;
+    }
+    return value;
+}
+
+static bool
+record_replay_tick(Replay *replay, Level *level, vec2i head_dir) {
+    if(replay->truncated || (replay->header.bit_count + 3) > replay->max_bits) {
+        replay->truncated = true;
+        return false;
+    }
+    
+    u32 dir = vec2i_to_dir(head_dir);
+    if(dir == replay->last_dir) {
+        write_replay_bits(replay, 0, 1);
+    }
+    else {
+        write_replay_bits(replay, 1, 1);
+        write_replay_bits(replay, dir, 2);
+        replay->last_dir = dir;
+    }
+    ++replay->header.tick_count;
+    replay->header.final_score = level->score;
+    return true;
+}
+
+static void
+rewind_replay(Replay *replay) {
+    replay->last_dir  = vec2i_to_dir(replay->header.params.snake_info.move_dir);
+    replay->read_bit  = 0;
+    replay->read_tick = 0;
+}
+
+static bool
+read_replay_tick(Replay *replay, vec2i *head_dir) {
+    if(replay->read_tick >= replay->header.tick_count || replay->read_bit >= replay->header.bit_count) {
+        return false;
+    }
+    
+    if(read_replay_bits(replay, 1)) {
+        if((replay->read_bit + 2) > replay->header.bit_count) {
+            return false;
+        }
+        replay->last_dir = read_replay_bits(replay, 2);
+    }
+    ++replay->read_tick;
+    *head_dir = dir_to_vec2i(replay->last_dir);
+    return true;
+}
+
+static void
+copy_replay(Replay *dest, Replay *source) {
+    u32 bytes = (source->header.bit_count + 7) / 8;
+    ASSERT(bytes <= (dest->max_bits / 8), "replay doesn't fit");
+    dest->header = source->header;
+    dest->truncated = source->truncated;
+    copy_memory(source->bits, dest->bits, bytes);
+    rewind_replay(dest);
+}
+
+static void
+write_replay_header(ReplayHeader *header, byte *data) {
+    byte *at = data;
+    put_u32(at, header->magic,       &at);
+    put_u32(at, header->version,     &at);
+    put_u64(at, header->seed,        &at);
+    put_u64(at, header->map_hash,    &at);
+    put_u32(at, header->tick_count,  &at);
+    put_u32(at, header->bit_count,   &at);
+    put_u32(at, header->final_score, &at);
+    
+    LevelParams *params = &header->params;
+    *at++ = params->looping    ? 1 : 0;
+    *at++ = params->init_apple ? 1 : 0;
+    put_u32(at, (u32)params->width,  &at);
+    put_u32(at, (u32)params->height, &at);
+    put_f32(at, params->camera_zpos,   &at);
+    put_f32(at, params->time_per_move, &at);
+    put_u32(at, (u32)params->snake_info.head_pos.x, &at);
+    put_u32(at, (u32)params->snake_info.head_pos.y, &at);
+    put_u32(at, (u32)params->snake_info.move_dir.x, &at);
+    put_u32(at, (u32)params->snake_info.move_dir.y, &at);
+    put_u32(at, params->snake_info.length, &at);
+    put_u32(at, params->wall_count, &at);
+    copy_memory(params->map_name, at, LEVEL_MAP_NAME_SIZE);
+    at += LEVEL_MAP_NAME_SIZE;
+    put_u32(at, params->wall_pattern, &at);
+    put_f32(at, params->wall_density, &at);
+    ASSERT(at - data == REPLAY_HEADER_BYTES, "replay header size mismatch");
+}
+
+static void
+read_replay_header(ReplayHeader *header, byte *data) {
+    byte *at = data;
+    *header = {};
+    header->magic       = get_u32(at, &at);
+    header->version     = get_u32(at, &at);
+    header->seed        = get_u64(at, &at);
+    header->map_hash    = get_u64(at, &at);
+    header->tick_count  = get_u32(at, &at);
+    header->bit_count   = get_u32(at, &at);
+    header->final_score = get_u32(at, &at);
+    
+    LevelParams *params = &header->params;
+    params->looping    = *at++ != 0;
+    params->init_apple = *at++ != 0;
+    params->width  = (i32)get_u32(at, &at);
+    params->height = (i32)get_u32(at, &at);
+    params->camera_zpos   = get_f32(at, &at);
+    params->time_per_move = get_f32(at, &at);
+    params->snake_info.head_pos.x = (i32)get_u32(at, &at);
+    params->snake_info.head_pos.y = (i32)get_u32(at, &at);
+    params->snake_info.move_dir.x = (i32)get_u32(at, &at);
+    params->snake_info.move_dir.y = (i32)get_u32(at, &at);
+    params->snake_info.length = get_u32(at, &at);
+    params->wall_count = get_u32(at, &at);
+    copy_memory(at, params->map_name, LEVEL_MAP_NAME_SIZE);
+    params->map_name[LEVEL_MAP_NAME_SIZE - 1] = 0;
+    at += LEVEL_MAP_NAME_SIZE;
+    params->wall_pattern = get_u32(at, &at);
+    params->wall_density = get_f32(at, &at);
+    params->seed = header->seed;
+}
+
+static b32
+save_replay(Replay *replay, const char *path, PlatformProcs *procs) {
+    u32 bytes = (replay->header.bit_count + 7) / 8;
+    u32 size = REPLAY_HEADER_BYTES + bytes;
+    byte *data = (byte *)procs->alloc(size);
+    if(!data) {
+        return false;
+    }
+    write_replay_header(&replay->header, data);
+    copy_memory(replay->bits, data + REPLAY_HEADER_BYTES, bytes);
+    b32 result = procs->write_file(path, data, size);
+    procs->free(data);
+    return result;
+}
+
+static b32
+load_replay(Replay *replay, const char *path, PlatformProcs *procs) {
+    FileContents file;
+    if(!procs->read_file(&file, path, false)) {
+        return false;
+    }
+    
+    b32 result = false;
+    if(file.size >= REPLAY_HEADER_BYTES) {
+        ReplayHeader header;
+        read_replay_header(&header, (byte *)file.contents);
+        u32 bytes = (header.bit_count + 7) / 8;
+        if(header.magic == REPLAY_MAGIC && header.version == REPLAY_VERSION && 
+           (file.size - REPLAY_HEADER_BYTES) >= bytes && header.bit_count <= replay->max_bits) {
+            replay->header = header;
+            replay->truncated = false;
+            copy_memory((byte *)file.contents + REPLAY_HEADER_BYTES, replay->bits, bytes);
+            rewind_replay(replay);
+            result = true;
+        }
+    }
+    procs->free_file(&file);
+    return result;
+}
+
+// NOTE: no rendering, no sounds, no game state, just the ticks as fast as they go
+static ReplayResult
+play_replay_headless(Replay *replay, MemoryArena *arena) {
+    ReplayResult result = {};
+    TemporaryMemory memory = begin_temporary_memory(arena);
+    
+    LevelParams params = replay->header.params;
+    params.seed = replay->header.seed;
+    Level level = make_level(params, arena);
+    if(!level.initialized || level.map_hash != replay->header.map_hash) {
+        release_level(&level);
+        end_temporary_memory(memory);
+        result.matches = false;
+        return result;
+    }
+    
+    rewind_replay(replay);
+    vec2i head_dir;
+    while(read_replay_tick(replay, &head_dir)) {
+        level.snake_next_dir[0] = head_dir;
+        result.last_event = tick_snake(&level, head_dir);
+        ++result.ticks;
+        if(result.last_event == SNAKE_died || result.last_event == SNAKE_won) {
+            break;
+        }
+    }
+    result.score = level.score;
+    result.matches = (result.ticks == replay->header.tick_count && result.score == replay->header.final_score);
+    
+    release_level(&level);
+    end_temporary_memory(memory);
+    return result;
+}
@@ -0,0 +1,61 @@
+#ifndef P_REPLAY_H
+#define P_REPLAY_H
+
+// NOTE: a replay is the level params (with the seed) + the head direction of every tick.
+// Bit stream per tick: 0 -> same direction as the last tick, 1 + 2 bits -> new snake_dir.
+
+// NOTE: the file is the header field by field, little endian with no padding, then the bits:
+//   u32 magic, u32 version, u64 seed, u64 map_hash, u32 tick_count, u32 bit_count, u32 final_score,
+//   u8 looping, u8 init_apple, i32 width, i32 height, f32 camera_zpos, f32 time_per_move,
+//   i32 head x, y, i32 move x, y, u32 length, u32 wall_count, char map_name[LEVEL_MAP_NAME_SIZE],
+//   u32 wall_pattern, f32 wall_density.
+// map_hash is the source_hash of the level file the walls came from, a replay doesn't play
+// on a level file that changed since.
+
+#define REPLAY_MAGIC   0x50524e53 // NOTE: "SNRP"
+#define REPLAY_VERSION 5
+#define REPLAY_MAX_BYTES MB(1)
+#define REPLAY_HEADER_BYTES (4 + 4 + 8 + 8 + 4 + 4 + 4 + 1 + 1 + 4 * 4 + 5 * 4 + 4 + LEVEL_MAP_NAME_SIZE + 4 + 4)
+
+struct ReplayHeader {
+    u32 magic;
+    u32 version;
+    random_seed seed;
+    u64 map_hash;
+    u32 tick_count;
+    u32 bit_count;
+    u32 final_score;
+    LevelParams params;
+};
+
+struct Replay {
+    ReplayHeader header;
+    u8 *bits;
+    u32 max_bits;
+    bool truncated;
+    
+    u32 last_dir;
+    u32 read_bit;
+    u32 read_tick;
+};
+
+struct ReplayResult {
+    u32 ticks;
+    u32 score;
+    snake_event last_event;
+    bool matches; // NOTE: same ticks and score as when it was recorded
+};
+
+static void make_replay(Replay *replay, MemoryArena *arena, u32 max_bytes);
+static void begin_replay(Replay *replay, Level *level);
+static bool record_replay_tick(Replay *replay, Level *level, vec2i head_dir);
+static void rewind_replay(Replay *replay);
+static bool read_replay_tick(Replay *replay, vec2i *head_dir);
+static void copy_replay(Replay *dest, Replay *source);
+static void write_replay_header(ReplayHeader *header, byte *data);
+static void read_replay_header(ReplayHeader *header, byte *data);
+static b32  save_replay(Replay *replay, const char *path, PlatformProcs *procs);
+static b32  load_replay(Replay *replay, const char *path, PlatformProcs *procs);
+static ReplayResult play_replay_headless(Replay *replay, MemoryArena *arena);
+
+#endif /* P_REPLAY_H */
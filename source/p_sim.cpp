@@ -0,0 +1,338 @@
+inline vec2i
+dir_to_vec2i(u32 dir) {
+    switch(dir) {
+        case DIR_right: return {  1,  0 };
+        case DIR_up:    return {  0,  1 };
+        case DIR_left:  return { -1,  0 };
+        case DIR_down:  return {  0, -1 };
+    }
+    return { 0, 0 };
+}
+
+inline u32
+vec2i_to_dir(vec2i v) {
+    if(v.x > 0) { return DIR_right; }
+    if(v.x < 0) { return DIR_left; }
+    if(v.y > 0) { return DIR_up; }
+    if(v.y < 0) { return DIR_down; }
+    return DIR_none;
+}
+
+inline u32
+opposite_dir(u32 dir) {
+    return dir ^ 2;
+}
+
+static SimBatch
+push_sim_batch(SimParams params, u32 count, MemoryArena *arena) {
+    SimBatch batch = {};
+    batch.params = params;
+    batch.count = count;
+    batch.cells = params.width * params.height;
+    
+    batch.head       = push_array(arena, u32, count);
+    batch.tail       = push_array(arena, u32, count);
+    batch.body_first = push_array(arena, u32, count);
+    batch.length     = push_array(arena, u32, count);
+    batch.grow       = push_array(arena, u32, count);
+    batch.score      = push_array(arena, u32, count);
+    batch.apple      = push_array(arena, u32, count);
+    batch.games      = push_array(arena, u32, count);
+    batch.dir        = push_array(arena, u8, count);
+    batch.status     = push_array(arena, u8, count);
+    batch.random     = push_array(arena, random_seed, count);
+    batch.board      = push_array(arena, u8, count * batch.cells);
+    batch.body       = push_array(arena, u8, count * batch.cells);
+    return batch;
+}
+
+static SimBatch
+make_sim_batch(SimParams params, u32 count, random_seed seed, MemoryArena *arena) {
+    ASSERT(params.width > 0 && params.height > 0, "invalid sim size");
+    ASSERT(params.length > 1 && params.length < params.width * params.height, "invalid snake length");
+    
+    SimBatch batch = push_sim_batch(params, count, arena);
+    batch.auto_reset = true;
+    
+    for(u32 i = 0; i < count; ++i) {
+        // NOTE: xorshift state can't be zero
+        batch.random[i] = seed + (u64)i * 0x9E3779B97F4A7C15ull;
+        if(batch.random[i] == 0) { batch.random[i] = 1; }
+        batch.games[i] = 0;
+        reset_sim_level(&batch, i);
+    }
+    return batch;
+}
+
+static void
+copy_sim_level(SimBatch *dest, u32 dest_level, SimBatch *source, u32 source_level) {
+    ASSERT(dest->cells == source->cells, "sim size mismatch");
+    dest->head[dest_level]       = source->head[source_level];
+    dest->tail[dest_level]       = source->tail[source_level];
+    dest->body_first[dest_level] = source->body_first[source_level];
+    dest->length[dest_level]     = source->length[source_level];
+    dest->grow[dest_level]       = source->grow[source_level];
+    dest->score[dest_level]      = source->score[source_level];
+    dest->apple[dest_level]      = source->apple[source_level];
+    dest->games[dest_level]      = source->games[source_level];
+    dest->dir[dest_level]        = source->dir[source_level];
+    dest->status[dest_level]     = source->status[source_level];
+    dest->random[dest_level]     = source->random[source_level];
+    copy_memory(source->board + source_level * source->cells, dest->board + dest_level * dest->cells, source->cells);
+    copy_memory(source->body  + source_level * source->cells, dest->body  + dest_level * dest->cells, source->cells);
+}
+
+static void
+reset_sim_level(SimBatch *batch, u32 level) {
+    SimParams *params = &batch->params;
+    u8 *board = batch->board + level * batch->cells;
+    u8 *body  = batch->body  + level * batch->cells;
+    zero_memory(board, batch->cells);
+    
+    // NOTE: lay the snake down from the head backwards, links point tail -> head
+    u32 back_dir = opposite_dir(params->move_dir);
+    u32 cell = params->head_pos.y * params->width + params->head_pos.x;
+    batch->head[level] = cell;
+    board[cell] = SIM_CELL_snake;
+    for(u32 i = 1; i < params->length; ++i) {
+        u32 next_cell;
+        bool ok = sim_step_cell(params, cell, back_dir, &next_cell);
+        ASSERT(ok && board[next_cell] == SIM_CELL_empty, "snake doesn't fit");
+        cell = next_cell;
+        board[cell] = SIM_CELL_snake;
+    }
+    batch->tail[level] = cell;
+    batch->body_first[level] = 0;
+    for(u32 i = 0; i < params->length - 1; ++i) {
+        body[i] = (u8)params->move_dir;
+    }
+    
+    for(u32 i = 0; i < params->wall_count; ++i) {
+        u32 wall = rand_u32_in_range(batch->random + level, 0, batch->cells - 1);
+        if(board[wall] == SIM_CELL_empty) {
+            board[wall] = SIM_CELL_wall;
+        }
+    }
+    
+    batch->length[level] = params->length;
+    batch->grow[level]   = 0;
+    batch->score[level]  = 0;
+    batch->dir[level]    = (u8)params->move_dir;
+    batch->status[level] = SIM_alive;
+    batch->apple[level]  = sim_place_apple(batch, level);
+    ++batch->games[level];
+}
+
+static u32
+sim_place_apple(SimBatch *batch, u32 level) {
+    u8 *board = batch->board + level * batch->cells;
+    random_seed *random = batch->random + level;
+    
+    // NOTE: random tries first, scan from a random cell when the board is crowded
+    for(u32 i = 0; i < 64; ++i) {
+        u32 cell = rand_u32_in_range(random, 0, batch->cells - 1);
+        if(board[cell] == SIM_CELL_empty) {
+            board[cell] = SIM_CELL_apple;
+            return cell;
+        }
+    }
+    
+    u32 start = rand_u32_in_range(random, 0, batch->cells - 1);
+    for(u32 i = 0; i < batch->cells; ++i) {
+        u32 cell = (start + i) % batch->cells;
+        if(board[cell] == SIM_CELL_empty) {
+            board[cell] = SIM_CELL_apple;
+            return cell;
+        }
+    }
+    return U32_MAX;
+}
+
+static bool
+sim_step_cell(SimParams *params, u32 cell, u32 dir, u32 *next_cell) {
+    u32 x = cell % params->width;
+    u32 y = cell / params->width;
+    switch(dir) {
+        case DIR_right: {
+            if(x + 1 < params->width) { x += 1; }
+            else if(params->looping)  { x = 0; }
+            else { return false; }
+        } break;
+        case DIR_up: {
+            if(y + 1 < params->height) { y += 1; }
+            else if(params->looping)   { y = 0; }
+            else { return false; }
+        } break;
+        case DIR_left: {
+            if(x > 0) { x -= 1; }
+            else if(params->looping) { x = params->width - 1; }
+            else { return false; }
+        } break;
+        case DIR_down: {
+            if(y > 0) { y -= 1; }
+            else if(params->looping) { y = params->height - 1; }
+            else { return false; }
+        } break;
+        
+        default: {
+            return false;
+        }
+    }
+    *next_cell = y * params->width + x;
+    return true;
+}
+
+// NOTE: same rules as update_snake: the tail leaves its cell before the head enters
+static void
+tick_sim_level(SimBatch *batch, u32 level, u32 input) {
+    if(batch->status[level] != SIM_alive) {
+        return;
+    }
+    
+    u32 dir = batch->dir[level];
+    if(input < DIR_COUNT && input != opposite_dir(dir)) {
+        dir = input;
+    }
+    batch->dir[level] = (u8)dir;
+    
+    u32 next_cell;
+    if(!sim_step_cell(&batch->params, batch->head[level], dir, &next_cell)) {
+        batch->status[level] = SIM_dead;
+        return;
+    }
+    
+    u8 *board = batch->board + level * batch->cells;
+    u8 *body  = batch->body  + level * batch->cells;
+    
+    if(batch->grow[level]) {
+        --batch->grow[level];
+        ++batch->length[level];
+    }
+    else {
+        u32 first = batch->body_first[level];
+        u32 tail = batch->tail[level];
+        board[tail] = SIM_CELL_empty;
+        sim_step_cell(&batch->params, tail, body[first], &batch->tail[level]);
+        batch->body_first[level] = (first + 1) % batch->cells;
+    }
+    
+    u8 hit = board[next_cell];
+    if(hit == SIM_CELL_wall || hit == SIM_CELL_snake) {
+        batch->status[level] = SIM_dead;
+        return;
+    }
+    
+    body[(batch->body_first[level] + batch->length[level] - 2) % batch->cells] = (u8)dir;
+    board[next_cell] = SIM_CELL_snake;
+    batch->head[level] = next_cell;
+    
+    if(hit == SIM_CELL_apple) {
+        ++batch->score[level];
+        ++batch->grow[level];
+        batch->apple[level] = sim_place_apple(batch, level);
+        if(batch->apple[level] == U32_MAX) {
+            batch->status[level] = SIM_won;
+        }
+    }
+}
+
+static void
+step_sim_range(SimWork *work) {
+    SimBatch *batch = work->batch;
+    u64 moves = 0;
+    for(u32 tick = 0; tick < work->ticks; ++tick) {
+        for(u32 level = work->first; level < work->one_past_last; ++level) {
+            if(batch->status[level] != SIM_alive) {
+                if(!batch->auto_reset) {
+                    continue;
+                }
+                reset_sim_level(batch, level);
+            }
+            
+            // NOTE: without inputs every level plays random turns
+            u32 input = DIR_none;
+            if(work->inputs) {
+                input = work->inputs[level];
+            }
+            else if((rand_u32(batch->random + level) & 7) == 0) {
+                input = rand_u32(batch->random + level) & 3;
+            }
+            
+            tick_sim_level(batch, level, input);
+            ++moves;
+        }
+    }
+    work->moves = moves;
+}
+
+static PLATFORM_WORK_QUEUE_CALLBACK(step_sim_work) {
+    step_sim_range((SimWork *)data);
+}
+
+static u64
+step_sim_batch(SimBatch *batch, u8 *inputs, u32 ticks, PlatformProcs *procs, PlatformWorkQueue *queue) {
+    u64 moves = 0;
+    
+    if(!queue || !procs || !procs->add_work_entry) {
+        SimWork work = { batch, inputs, 0, batch->count, ticks, 0 };
+        step_sim_range(&work);
+        return work.moves;
+    }
+    
+    u32 levels_per_work = SIM_LEVELS_PER_WORK;
+    u32 work_count = (batch->count + levels_per_work - 1) / levels_per_work;
+    if(work_count > SIM_MAX_WORK) {
+        work_count = SIM_MAX_WORK;
+        levels_per_work = (batch->count + work_count - 1) / work_count;
+    }
+    
+    SimWork works[SIM_MAX_WORK];
+    u32 work_index = 0;
+    for(u32 first = 0; first < batch->count; first += levels_per_work) {
+        SimWork *work = works + work_index++;
+        work->batch = batch;
+        work->inputs = inputs;
+        work->first = first;
+        work->one_past_last = clamp_max(first + levels_per_work, batch->count);
+        work->ticks = ticks;
+        work->moves = 0;
+        procs->add_work_entry(queue, step_sim_work, work);
+    }
+    procs->complete_all_work(queue);
+    
+    for(u32 i = 0; i < work_index; ++i) {
+        moves += works[i].moves;
+    }
+    return moves;
+}
+
+static SimBenchResult
+run_sim_benchmark(SimParams params, u32 level_count, u32 ticks, PlatformProcs *procs, PlatformWorkQueue *queue) {
+    SimBenchResult result = {};
+    result.level_count = level_count;
+    result.ticks = ticks;
+    
+    u32 cells = params.width * params.height;
+    u32 memory_size = level_count * (cells * 2 + 64) + KB(4);
+    void *memory = procs->alloc(memory_size);
+    if(!memory) {
+        return result;
+    }
+    MemoryArena arena = make_arena(memory, memory_size);
+    
+    SimBatch batch = make_sim_batch(params, level_count, 2137, &arena);
+    
+    f64 start = procs->get_wall_clock();
+    result.moves = step_sim_batch(&batch, 0, ticks, procs, queue);
+    result.seconds = procs->get_wall_clock() - start;
+    
+    for(u32 i = 0; i < level_count; ++i) {
+        result.games += batch.games[i];
+    }
+    if(result.seconds > 0.0) {
+        result.moves_per_second = (f64)result.moves / result.seconds;
+    }
+    
+    procs->free(memory);
+    return result;
+}
@@ -0,0 +1,102 @@
+#ifndef P_SIM_H
+#define P_SIM_H
+
+// NOTE: rendering-free snake rules, steps many independent levels per call.
+// Nothing in here touches game_data, the camera or the renderer.
+
+enum snake_dir {
+    DIR_right,
+    DIR_up,
+    DIR_left,
+    DIR_down,
+    
+    DIR_none,
+    DIR_COUNT = DIR_none
+};
+
+inline vec2i dir_to_vec2i(u32 dir);
+inline u32   vec2i_to_dir(vec2i v);
+inline u32   opposite_dir(u32 dir);
+
+enum sim_cell {
+    SIM_CELL_empty,
+    SIM_CELL_wall,
+    SIM_CELL_apple,
+    SIM_CELL_snake,
+};
+
+enum sim_status {
+    SIM_alive,
+    SIM_dead,
+    SIM_won,
+};
+
+struct SimParams {
+    u32   width;
+    u32   height;
+    bool  looping;
+    vec2i head_pos;
+    u32   move_dir; // NOTE: snake_dir
+    u32   length;   // NOTE: including head
+    u32   wall_count;
+};
+
+struct SimBatch {
+    SimParams params;
+    u32 count;
+    u32 cells;
+    bool auto_reset;
+    
+    // NOTE: per level scalars, structure of arrays
+    u32 *head;       // NOTE: cell index
+    u32 *tail;       // NOTE: cell index
+    u32 *body_first; // NOTE: ring index of the link leaving the tail
+    u32 *length;
+    u32 *grow;
+    u32 *score;
+    u32 *apple;
+    u32 *games;
+    u8  *dir;
+    u8  *status;
+    random_seed *random;
+    
+    // NOTE: per level blocks, 'cells' bytes per level
+    u8 *board; // NOTE: sim_cell
+    u8 *body;  // NOTE: ring buffer of snake_dir, tail -> head
+};
+
+struct SimWork {
+    SimBatch *batch;
+    u8  *inputs;
+    u32  first;
+    u32  one_past_last;
+    u32  ticks;
+    u64  moves;
+};
+
+#define SIM_LEVELS_PER_WORK 64
+// NOTE: the platform work queues are rings of 256 entries that hold 255,
+// keep well under that so other work queued at the same time still fits
+#define SIM_MAX_WORK 128
+
+struct SimBenchResult {
+    u32 level_count;
+    u32 ticks;
+    u64 moves;
+    u64 games;
+    f64 seconds;
+    f64 moves_per_second;
+};
+
+static SimBatch push_sim_batch(SimParams params, u32 count, MemoryArena *arena);
+static SimBatch make_sim_batch(SimParams params, u32 count, random_seed seed, MemoryArena *arena);
+static void     copy_sim_level(SimBatch *dest, u32 dest_level, SimBatch *source, u32 source_level);
+static void     reset_sim_level(SimBatch *batch, u32 level);
+static u32      sim_place_apple(SimBatch *batch, u32 level);
+static bool     sim_step_cell(SimParams *params, u32 cell, u32 dir, u32 *next_cell);
+static void     tick_sim_level(SimBatch *batch, u32 level, u32 input);
+static void     step_sim_range(SimWork *work);
+static u64      step_sim_batch(SimBatch *batch, u8 *inputs, u32 ticks, PlatformProcs *procs, PlatformWorkQueue *queue);
+static SimBenchResult run_sim_benchmark(SimParams params, u32 level_count, u32 ticks, PlatformProcs *procs, PlatformWorkQueue *queue);
+
+#endif /* P_SIM_H */
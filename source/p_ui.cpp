@@ -23,7 +23,7 @@ next_button_position(ButtonLayout *layout) {
             layout->position.x += mult * (layout->button_size.x + layout->space);
         } break;
         
-        default: ASSERT(false, "");
+        default: ASSERT(false, "unknown button layout type...\n");
     }
     return position;
 }
@@ -40,7 +40,7 @@ offset_for_button_layout(ButtonLayout *layout, u32 num) {
             layout->position.x += mult * (num - 1) * (layout->button_size.x + layout->space);
         } break;
         
-        default: ASSERT(false, "");
+        default: ASSERT(false, "unknown button layout type...\n");
     }
 }
 
@@ -118,7 +118,7 @@ ui_end(UI *ui) {
 }
 
 static bool 
-do_button(UI *ui, Input *input, char *text, vec2 pos, vec2 size, 
+do_button(UI *ui, Input *input, const char *text, vec2 pos, vec2 size, 
           ButtonTheme *theme, uiid id, bool inactive) {
     bool down    = false;
     bool clicked = false;
@@ -165,7 +165,7 @@ do_button(UI *ui, Input *input, char *text, vec2 pos, vec2 size,
 }
 
 static void
-do_button_toggle(UI *ui, Input *input, char *text, bool *boolean, 
+do_button_toggle(UI *ui, Input *input, const char *text, bool *boolean, 
                  vec2 pos, vec2 size, ButtonTheme *theme, uiid id) {
     bool down    = false;
     bool clicked = false;
@@ -215,7 +215,7 @@ do_button_toggle(UI *ui, Input *input, char *text, bool *boolean,
 }
 
 static void 
-do_label(UI *ui, char *text, vec2 pos, vec2 size, LabelTheme *theme) {
+do_label(UI *ui, const char *text, vec2 pos, vec2 size, LabelTheme *theme) {
     vec4 color = theme->color;
     
     draw_label(ui->renderer, text, pos, size, theme);
@@ -313,7 +313,8 @@ DRAW_BUTTON_PROC(draw_button_simple) {
         pos.y + size.y * 0.5f - text_height * 0.5f + (size.y * theme->text_scale * ((1.0f - scale) * 0.5f))
     };
     
-    if(text_width >= size.x) {
+    bool clipped = (text_width >= size.x);
+    if(clipped) {
         recti32 clip_rect = {
             (i32)(pos.x + theme->border_width), (i32)(pos.y + theme->border_width), 
             (i32)(size.x - theme->border_width * 2.0f), (i32)(size.y - theme->border_width * 2.0f)
@@ -326,8 +327,11 @@ DRAW_BUTTON_PROC(draw_button_simple) {
     draw_text(renderer, text, text_pos + make_vec2(offset, -offset), text_height, theme->font, make_vec4(color.rgb, 0.1f));
     draw_text(renderer, text, text_pos, text_height, theme->font, color);
     
-    flush(renderer);
-    disable_clip_rect(renderer);
+    // NOTE: the clip rect is api state, the quads under it have to go out before it changes
+    if(clipped) {
+        flush(renderer);
+        disable_clip_rect(renderer);
+    }
 }
 
 DRAW_BUTTON_PROC(draw_button_old_style) {
@@ -407,7 +411,8 @@ DRAW_BUTTON_PROC(draw_button_old_style) {
     };
     vec4 text_color = color;
     
-    if(text_width >= center_quad_size.x) {
+    bool clipped = (text_width >= center_quad_size.x);
+    if(clipped) {
         recti32 clip_rect = {
             (i32)center_quad_pos.x, (i32)center_quad_pos.y, 
             (i32)center_quad_size.x, (i32)center_quad_size.y
@@ -418,8 +423,10 @@ DRAW_BUTTON_PROC(draw_button_old_style) {
     
     draw_text(renderer, text, text_pos, text_height, theme->font, text_color);
     
-    flush(renderer);
-    disable_clip_rect(renderer);
+    if(clipped) {
+        flush(renderer);
+        disable_clip_rect(renderer);
+    }
 }
 
 DRAW_BUTTON_PROC(draw_button_with_shadow) {
@@ -447,7 +454,8 @@ DRAW_BUTTON_PROC(draw_button_with_shadow) {
         pos.y + size.y * 0.5f - text_height * 0.5f + (size.y * theme->text_scale * ((1.0f - scale) * 0.5f))
     };
     
-    if(text_width >= size.x) {
+    bool clipped = (text_width >= size.x);
+    if(clipped) {
         recti32 clip_rect = {
             (i32)pos.x, (i32)pos.y, 
             (i32)size.x, (i32)size.y
@@ -459,8 +467,10 @@ DRAW_BUTTON_PROC(draw_button_with_shadow) {
     draw_text(renderer, text, text_pos + offset, text_height, theme->font, make_vec4(color.rgb, 0.1f));
     draw_text(renderer, text, text_pos, text_height, theme->font, color);
     
-    flush(renderer);
-    disable_clip_rect(renderer);
+    if(clipped) {
+        flush(renderer);
+        disable_clip_rect(renderer);
+    }
 }
 
 DRAW_LABEL_PROC(draw_label_simple) {
@@ -8,10 +8,10 @@ enum button_state {
     BUTTON_inactive
 };
 
-#define DRAW_BUTTON_PROC(name) void name(Renderer *renderer, char *text, button_state state, vec2 pos, vec2 size, struct ButtonTheme *theme)
+#define DRAW_BUTTON_PROC(name) void name(Renderer *renderer, const char *text, button_state state, vec2 pos, vec2 size, struct ButtonTheme *theme)
 typedef DRAW_BUTTON_PROC(draw_button_proc);
 
-#define DRAW_LABEL_PROC(name) void name(Renderer *renderer, char *text, vec2 pos, vec2 size, struct LabelTheme *theme)
+#define DRAW_LABEL_PROC(name) void name(Renderer *renderer, const char *text, vec2 pos, vec2 size, struct LabelTheme *theme)
 typedef DRAW_LABEL_PROC(draw_label_proc);
 
 enum button_style {
@@ -25,10 +25,10 @@ struct ButtonTheme {
     button_style style;
     union { // NOTE: button_style order
         struct {
-            u32 _unused;
+            u32 _unused0;
         };
         struct {
-            u32 _unused;
+            u32 _unused1;
         };
         struct {
             f32  shadow_offset;
@@ -70,7 +70,7 @@ struct LabelTheme {
     label_style style;
     union { // NOTE: label_style order
         struct {
-            u32 _unused;
+            u32 _unused0;
         };
         struct {
             f32 shadow_offset;
@@ -134,9 +134,9 @@ static void set_ui_dims(UI *ui, i32 width, i32 height);
 static void begin_ui_frame(UI *ui);
 static void ui_begin(UI *ui);
 static void ui_end(UI *ui);
-static bool do_button(UI *ui, Input *input, char *text, vec2 pos, vec2 size, ButtonTheme *theme, uiid id, bool inactive = false);
-static void do_button_toggle(UI *ui, Input *input, char *text, bool *boolean, vec2 pos, vec2 size, ButtonTheme *theme, uiid id);
-static void do_label(UI *ui, char *text, vec2 pos, vec2 size, LabelTheme *theme);
+static bool do_button(UI *ui, Input *input, const char *text, vec2 pos, vec2 size, ButtonTheme *theme, uiid id, bool inactive = false);
+static void do_button_toggle(UI *ui, Input *input, const char *text, bool *boolean, vec2 pos, vec2 size, ButtonTheme *theme, uiid id);
+static void do_label(UI *ui, const char *text, vec2 pos, vec2 size, LabelTheme *theme);
 static DRAW_BUTTON_PROC(draw_button); 
 static DRAW_LABEL_PROC(draw_label);
 
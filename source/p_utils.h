@@ -41,6 +41,50 @@ inline u16 get_u16(byte *ptr, byte **to_advance = nullptr) {
     return result;
 }
 
+inline u64 get_u64(byte *ptr, byte **to_advance = nullptr) {
+    u64 result = (u64)get_u32(ptr) | ((u64)get_u32(ptr + 4) << 32);
+    if(to_advance) { *to_advance += 8; }
+    return result;
+}
+
+// NOTE: little endian whatever the machine, like the get_ ones
+inline void put_u32(byte *ptr, u32 value, byte **to_advance = nullptr) {
+    ptr[0] = (byte)(value >> 0);
+    ptr[1] = (byte)(value >> 8);
+    ptr[2] = (byte)(value >> 16);
+    ptr[3] = (byte)(value >> 24);
+    if(to_advance) { *to_advance += 4; }
+}
+
+inline void put_u64(byte *ptr, u64 value, byte **to_advance = nullptr) {
+    put_u32(ptr, (u32)value);
+    put_u32(ptr + 4, (u32)(value >> 32));
+    if(to_advance) { *to_advance += 8; }
+}
+
+inline f32 get_f32(byte *ptr, byte **to_advance = nullptr) {
+    u32 bits = get_u32(ptr, to_advance);
+    f32 result;
+    copy_memory(&bits, &result, sizeof(f32));
+    return result;
+}
+
+inline void put_f32(byte *ptr, f32 value, byte **to_advance = nullptr) {
+    u32 bits;
+    copy_memory(&value, &bits, sizeof(f32));
+    put_u32(ptr, bits, to_advance);
+}
+
+// NOTE: FNV-1a
+inline u64
+hash_bytes(void *data, u64 size) {
+    u64 hash = 0xcbf29ce484222325ull;
+    for(u64 i = 0; i < size; ++i) {
+        hash = (hash ^ ((byte *)data)[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
 #define WAV_RIFF_ID_VALUE ('R' << 0 | 'I' << 8 | 'F' << 16 | 'F' << 24)
 #define WAV_WAVE_ID_VALUE ('W' << 0 | 'A' << 8 | 'V' << 16 | 'E' << 24)
 #define WAV_FMT_ID_VALUE  ('f' << 0 | 'm' << 8 | 't' << 16 | ' ' << 24)
@@ -161,7 +205,7 @@ load_sound_wav(const char *path, PlatformProcs *procs, /* out */ Wav_fmt *format
                     print_ptr(fact);
                     print_ptr(data);
                     
-                    ASSERT(false, "");
+                    ASSERT(false, "unknown wav chunk...\n");
                     return {};
                 };
             };
@@ -164,8 +164,8 @@ get_line_var_value(TextLine line) {
 static bool 
 get_vec_from_value(char *value, f32 *v, i32 v_num) {
     i32 len = (i32)strlen(value);
-    if(len < 2 || (value[0] != '{' || value[len - 1] != '}') && 
-       (value[0] != '(' || value[len - 1] != ')')) {
+    if(len < 2 || ((value[0] != '{' || value[len - 1] != '}') && 
+                   (value[0] != '(' || value[len - 1] != ')'))) {
         return false;
     }
     
@@ -263,7 +263,7 @@ get_var_from_file(void *var, char *var_name, var_type type, TextLines lines) {
                     }
                 } break;
                 
-                default: ASSERT(false, "");
+                default: ASSERT(false, "unknown var type...\n");
             };
             success = true;
         }
@@ -152,6 +152,16 @@ FREE_FILE_PROC(free_file) {
     file->contents = nullptr;
 }
 
+WRITE_FILE_PROC(write_file) {
+    FILE *_file;
+    if(fopen_s(&_file, path, "wb") == 0) {
+        size_t written = fwrite(data, 1, size, _file);
+        fclose(_file);
+        return written == size;
+    }
+    return false;
+}
+
 inline PTime
 win32_filetime_to_p_time(FILETIME filetime) {
     PTime time = {};
@@ -179,6 +189,44 @@ LAST_WRITE_TIME_PROC(last_write_time) {
     return last_write_time;
 }
 
+MAP_FILE_PROC(map_file) {
+    *file = {};
+    HANDLE file_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if(file_handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    
+    LARGE_INTEGER size;
+    HANDLE mapping = 0;
+    if(GetFileSizeEx(file_handle, &size) && size.QuadPart > 0 && size.QuadPart <= U32_MAX) {
+        mapping = CreateFileMappingA(file_handle, 0, PAGE_WRITECOPY, 0, 0, 0);
+    }
+    
+    // NOTE: the mapping keeps the file open
+    CloseHandle(file_handle);
+    if(!mapping) {
+        return false;
+    }
+    
+    void *view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+    if(!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    file->size = (u32)size.QuadPart;
+    file->contents = view;
+    file->handle = mapping;
+    return true;
+}
+
+UNMAP_FILE_PROC(unmap_file) {
+    if(file->contents) {
+        UnmapViewOfFile(file->contents);
+        CloseHandle((HANDLE)file->handle);
+    }
+    *file = {};
+}
+
 CREATE_SOUND_PROC(create_sound) {
     if(!sound->data || !sound->data_size) {
         return 0;
@@ -244,6 +292,92 @@ PLAY_SOUND_PROC(play_sound) {
     // alDeleteSources(1, &source);
 }
 
+ADD_WORK_ENTRY_PROC(add_work_entry) {
+    u32 new_next_entry_to_write = (queue->next_entry_to_write + 1) % size_array(queue->entries);
+    ASSERT(new_next_entry_to_write != queue->next_entry_to_read, "work queue overflow");
+    PlatformWorkQueueEntry *entry = queue->entries + queue->next_entry_to_write;
+    entry->callback = callback;
+    entry->data = data;
+    ++queue->completion_goal;
+    
+    // NOTE: entry has to be visible before the write index moves
+    _WriteBarrier();
+    queue->next_entry_to_write = new_next_entry_to_write;
+    ReleaseSemaphore(queue->semaphore, 1, 0);
+}
+
+static bool
+do_next_work_entry(PlatformWorkQueue *queue) {
+    bool should_sleep = false;
+    
+    u32 original_next_entry_to_read = queue->next_entry_to_read;
+    u32 new_next_entry_to_read = (original_next_entry_to_read + 1) % size_array(queue->entries);
+    if(original_next_entry_to_read != queue->next_entry_to_write) {
+        u32 index = InterlockedCompareExchange((LONG volatile *)&queue->next_entry_to_read, 
+                                               new_next_entry_to_read, original_next_entry_to_read);
+        if(index == original_next_entry_to_read) {
+            PlatformWorkQueueEntry entry = queue->entries[index];
+            entry.callback(queue, entry.data);
+            InterlockedIncrement((LONG volatile *)&queue->completion_count);
+        }
+    }
+    else {
+        should_sleep = true;
+    }
+    return should_sleep;
+}
+
+COMPLETE_ALL_WORK_PROC(complete_all_work) {
+    // NOTE: calling thread helps with the work instead of waiting
+    while(queue->completion_goal != queue->completion_count) {
+        do_next_work_entry(queue);
+    }
+    queue->completion_goal = 0;
+    queue->completion_count = 0;
+}
+
+DWORD WINAPI
+worker_thread_proc(LPVOID param) {
+    PlatformWorkQueue *queue = (PlatformWorkQueue *)param;
+    for(;;) {
+        if(do_next_work_entry(queue)) {
+            WaitForSingleObjectEx(queue->semaphore, INFINITE, FALSE);
+        }
+    }
+}
+
+static void
+init_work_queue(PlatformWorkQueue *queue, u32 thread_count) {
+    queue->completion_goal = 0;
+    queue->completion_count = 0;
+    queue->next_entry_to_write = 0;
+    queue->next_entry_to_read = 0;
+    queue->thread_count = thread_count;
+    queue->semaphore = CreateSemaphoreExA(0, 0, max_value(thread_count, 1), 0, 0, SEMAPHORE_ALL_ACCESS);
+    for(u32 i = 0; i < thread_count; ++i) {
+        DWORD thread_id;
+        HANDLE thread = CreateThread(0, 0, worker_thread_proc, queue, 0, &thread_id);
+        CloseHandle(thread);
+    }
+}
+
+static u32
+get_worker_thread_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    u32 count = (info.dwNumberOfProcessors > 1) ? (info.dwNumberOfProcessors - 1) : 0;
+    return count;
+}
+
+static LARGE_INTEGER performance_frequency;
+
+GET_WALL_CLOCK_PROC(get_wall_clock) {
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    f64 seconds = (f64)counter.QuadPart / (f64)performance_frequency.QuadPart;
+    return seconds;
+}
+
 static void
 unload_game_dll(GameDLL *dll) {
     if(!dll->loaded) {
@@ -475,12 +609,23 @@ int main(int, char**) {
         (free_memory_proc *)free_memory,
         (read_file_proc *)read_file,
         (free_file_proc *)free_file,
+        (write_file_proc *)write_file,
         (last_write_time_proc *)last_write_time,
+        (map_file_proc *)map_file,
+        (unmap_file_proc *)unmap_file,
         (create_sound_proc *)create_sound,
         (delete_sound_proc *)delete_sound,
         (play_sound_proc *)play_sound,
+        (add_work_entry_proc *)add_work_entry,
+        (complete_all_work_proc *)complete_all_work,
+        (get_wall_clock_proc *)get_wall_clock,
     };
     
+    QueryPerformanceFrequency(&performance_frequency);
+    
+    static PlatformWorkQueue work_queue = {};
+    init_work_queue(&work_queue, get_worker_thread_count());
+    
     GameDLL game_dll = load_game_dll();
     if(!game_dll.loaded) {
         message_box("win32", "couldn't load the game dll...\n");
@@ -521,7 +666,8 @@ int main(int, char**) {
         &renderer,
         &memory,
         &window.state,
-        &procs
+        &procs,
+        &work_queue
     };
     
     Input input = {};
@@ -577,15 +723,16 @@ int main(int, char**) {
         begin_renderer_frame(&renderer);
         hotload_shaders(&renderer, input.delta_time);
         
-        if(input.delta_time < (1.0f / 10.0f)) {
-            if(game_dll.game_frame) {
-                bool do_not_quit = game_dll.game_frame(&core, &input);
-                if(!do_not_quit) {
-                    close_window(&window);
-                }
+        // NOTE: long frames (moving the window, breakpoints) get clamped instead of skipped, 
+        // the game catches up on missed moves by itself
+        clamp_max_v(input.delta_time, 1.0f / 10.0f);
+        if(game_dll.game_frame) {
+            bool do_not_quit = game_dll.game_frame(&core, &input);
+            if(!do_not_quit) {
+                close_window(&window);
             }
-            glfwSwapBuffers(window.handle);
         }
+        glfwSwapBuffers(window.handle);
         
         if(window.state.fullscreen != last_state.fullscreen) {
             if(window.state.fullscreen) {
@@ -146,4 +146,21 @@ struct GameDLL {
     game_get_startup_params_proc *get_startup_params;
 };
 
+struct PlatformWorkQueueEntry {
+    platform_work_queue_callback *callback;
+    void *data;
+};
+
+// NOTE: single producer (game thread), many consumers (worker threads)
+struct PlatformWorkQueue {
+    u32 volatile completion_goal;
+    u32 volatile completion_count;
+    u32 volatile next_entry_to_write;
+    u32 volatile next_entry_to_read;
+    HANDLE semaphore;
+    
+    u32 thread_count;
+    PlatformWorkQueueEntry entries[256];
+};
+
 #endif /* P_WIN32_MAIN_H */